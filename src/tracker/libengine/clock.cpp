@@ -0,0 +1,113 @@
+#include "clock.hpp"
+#include "math.hpp"
+
+namespace {
+
+    /**
+     * Seconds since 1970-01-01 of the broken down time, without any timezone conversions
+     * @param time Broken down time
+     * @return seconds
+     */
+    s64 FieldSeconds(const std::tm& time) noexcept {
+        const DateTime date{ time.tm_year + 1900, time.tm_mon + 1, time.tm_mday, time.tm_hour, time.tm_min,
+                             time.tm_sec };
+        return Instant::FromDateTime(date).Unix();
+    }
+
+    /**
+     * Computes the offset from local time to utc at the given time
+     * @param time Time
+     * @return offset in seconds
+     */
+    s64 OffsetAt(std::time_t time) noexcept {
+        const auto local = *std::localtime(&time);
+        const auto utc = *std::gmtime(&time);
+        return FieldSeconds(utc) - FieldSeconds(local);
+    }
+}// namespace
+
+DateTime Clock::Now() noexcept {
+    if (snapshot) {
+        return *snapshot;
+    }
+    return DateTime::Now();
+}
+
+void Clock::Inject(const DateTime& now) noexcept {
+    snapshot = now;
+}
+
+void Clock::Release() noexcept {
+    snapshot.reset();
+}
+
+s64 Clock::UtcOffset() noexcept {
+    const auto time = std::time(nullptr);
+    std::unique_lock lock(mutex);
+    if (time < validFrom || time >= validUntil) {
+        update(time);
+    }
+    return offset;
+}
+
+DateTime Clock::ToUtc(DateTime localTime) noexcept {
+    localTime.AddSeconds(UtcOffset());
+    return localTime;
+}
+
+Instant Clock::ToUtc(Instant localTime) noexcept {
+    return localTime.AddSeconds(UtcOffset());
+}
+
+Instant Clock::ToLocal(Instant utcTime) noexcept {
+    return utcTime.AddSeconds(-UtcOffset());
+}
+
+void Clock::Invalidate() noexcept {
+    std::unique_lock lock(mutex);
+    validFrom = 0;
+    validUntil = 0;
+}
+
+f64 Clock::GreenwichMeanSiderealTime(f64 julianDay, f64 julianDayFraction) noexcept {
+    constexpr auto secondsInDay = 86400.0;
+    const auto meanJulianDayNumber = (julianDay - 2400000.5) + julianDayFraction;
+    const auto meanJulianDayNumberFloor = std::floor(meanJulianDayNumber);
+    const auto UT = secondsInDay * (meanJulianDayNumber - meanJulianDayNumberFloor);
+    const auto T = (meanJulianDayNumber - 51544.5) / 36525.0;
+    const auto T_0 = (meanJulianDayNumberFloor - 51544.5) / 36525.0;
+
+    const auto greenwichMeanSiderealTime =
+            24110.54841 + 8640184.812866 * T_0 + 1.0027379093 * UT + (0.093104 - 6.2e-6 * T) * T * T;
+    const auto greenwichMeanSiderealTimeDegrees =
+            math::Degrees((math::PI2 / secondsInDay) * math::Mod(greenwichMeanSiderealTime, secondsInDay));
+    return math::Mod(greenwichMeanSiderealTimeDegrees, 360.0);
+}
+
+void Clock::update(std::time_t time) noexcept {
+    constexpr std::time_t day = 86400;
+    constexpr std::time_t horizon = 400 * day;
+
+    offset = OffsetAt(time);
+    validFrom = time;
+    validUntil = time + horizon;
+
+    // Daylight saving time transitions happen at most a few times a year, so we probe day by day
+    // and narrow the transition down to the second once the offset has changed
+    for (auto probe = time + day; probe < time + horizon; probe += day) {
+        if (OffsetAt(probe) != offset) {
+            auto low = probe - day;
+            auto high = probe;
+            while (high - low > 1) {
+                const auto middle = low + (high - low) / 2;
+                if (OffsetAt(middle) == offset) {
+                    low = middle;
+                } else {
+                    high = middle;
+                }
+            }
+            validUntil = high;
+            break;
+        }
+    }
+}
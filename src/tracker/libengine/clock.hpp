@@ -0,0 +1,91 @@
+#ifndef LIBENGINE_CLOCK_H
+#define LIBENGINE_CLOCK_H
+
+#include <ctime>
+#include <mutex>
+#include <optional>
+
+#include "date-time.hpp"
+#include "instant.hpp"
+#include "utility/types.hpp"
+
+/**
+ * @brief Time-scale service, that caches the offset between local time and utc
+ * The offset is only recomputed when a daylight saving time transition was passed, so that converting to utc does not
+ * require any localtime or mktime calls in between
+ */
+class Clock {
+public:
+    /**
+     * @brief Returns the injected snapshot of the calling thread, or the local date-time if there is none
+     * @return Local date-time
+     */
+    static DateTime Now() noexcept;
+
+    /**
+     * @brief Injects a fixed "now" for the calling thread, so that a whole frame or job shares the same instant
+     * @param now Local date-time that is returned by Now
+     */
+    static void Inject(const DateTime& now) noexcept;
+
+    /**
+     * @brief Releases the injected snapshot of the calling thread
+     */
+    static void Release() noexcept;
+
+    /**
+     * @brief Returns the number of seconds that have to be added to the local time to obtain utc
+     * @return Offset in seconds
+     */
+    static s64 UtcOffset() noexcept;
+
+    /**
+     * @brief Converts the local time to utc with the cached offset
+     * @param localTime The local time to be converted
+     * @return Utc-time
+     */
+    static DateTime ToUtc(DateTime localTime) noexcept;
+
+    /**
+     * @brief Converts the local time to utc with the cached offset
+     * @param localTime The local time to be converted
+     * @return Utc-time
+     */
+    static Instant ToUtc(Instant localTime) noexcept;
+
+    /**
+     * @brief Converts utc to the local time with the cached offset
+     * @param utcTime The utc time to be converted
+     * @return Local time
+     */
+    static Instant ToLocal(Instant utcTime) noexcept;
+
+    /**
+     * @brief Drops the cached offset, e.g. when the timezone of the system was changed
+     */
+    static void Invalidate() noexcept;
+
+    /**
+     * @brief Calculates the greenwich mean sidereal time for a two-part julian day, whose sum is the actual date.
+     * Splitting the date keeps the precision of the fraction, when stepping through time
+     * @param julianDay Julian day in utc
+     * @param julianDayFraction Fraction that is added to the julian day
+     * @return Sidereal time in degrees
+     */
+    static f64 GreenwichMeanSiderealTime(f64 julianDay, f64 julianDayFraction = 0.0) noexcept;
+
+private:
+    /**
+     * @brief Recomputes the offset and the point in time, where it is going to change next
+     * @param time Current time
+     */
+    static void update(std::time_t time) noexcept;
+
+    static inline std::mutex mutex;
+    static inline s64 offset{ 0 };
+    static inline std::time_t validFrom{ 0 };
+    static inline std::time_t validUntil{ 0 };
+    static inline thread_local std::optional<DateTime> snapshot;
+};
+
+#endif// LIBENGINE_CLOCK_H
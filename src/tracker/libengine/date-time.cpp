@@ -3,6 +3,7 @@
 #include <ctime>
 #include <string>
 
+#include "clock.hpp"
 #include "date-time.hpp"
 #include "math.hpp"
 
@@ -271,9 +272,7 @@ DateTime DateTime::Utc() noexcept {
 }
 
 DateTime DateTime::Utc(DateTime localTime) noexcept {
-    const auto difference = Difference(Now(), Utc());
-    localTime.AddSeconds(difference);
-    return localTime;
+    return Clock::ToUtc(localTime);
 }
 
 s64 DateTime::Difference(const DateTime& a, const DateTime& b) noexcept {
@@ -315,18 +314,7 @@ f64 DateTime::BesselEpoch(const DateTime& date) noexcept {
 }
 
 f64 DateTime::GreenwichMeanSiderealTime(const DateTime& utc) noexcept {
-    constexpr auto secondsInDay = 86400.0;
-    const auto meanJulianDayNumber = MeanJulianDayNumber(utc);
-    const auto meanJulianDayNumberFloor = floor(meanJulianDayNumber);
-    const auto UT = secondsInDay * (meanJulianDayNumber - meanJulianDayNumberFloor);
-    const auto T = (meanJulianDayNumber - 51544.5) / 36525.0;
-    const auto T_0 = (meanJulianDayNumberFloor - 51544.5) / 36525.0;
-
-    const auto greenwichMeanSiderealTime =
-            24110.54841 + 8640184.812866 * T_0 + 1.0027379093 * UT + (0.093104 - 6.2e-6 * T) * T * T;
-    const auto greenwichMeanSiderealTimeDegrees =
-            math::Degrees((math::PI2 / secondsInDay) * math::Mod(greenwichMeanSiderealTime, secondsInDay));
-    return math::Mod(greenwichMeanSiderealTimeDegrees, 360.0);
+    return Clock::GreenwichMeanSiderealTime(2400000.5, MeanJulianDayNumber(utc));
 }
 
 std::time_t DateTime::Unix() const noexcept {
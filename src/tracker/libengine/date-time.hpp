@@ -89,7 +89,7 @@ public:
     static DateTime Utc() noexcept;
 
     /**
-     * @brief Returns the relative utc-time
+     * @brief Returns the relative utc-time, the offset is cached by the Clock
      * @param localTime The local time to be converted
      * @return Utc-time
      */
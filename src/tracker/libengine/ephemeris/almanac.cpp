@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#include "almanac.hpp"
+#include "rise-set.hpp"
+#include "utility/async.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Identifies an almanac, the magic number also rejects almanacs of the other byte order
+         */
+        constexpr u32 AlmanacMagic = 0x434d4c41;
+
+        /**
+         * Version of the almanac layout, which has to be incremented on any change of the records or the generator
+         */
+        constexpr u32 AlmanacVersion = 2;
+
+        struct AlmanacHeader {
+            u32 Magic;
+            u32 Version;
+            u64 CatalogChecksum;
+            u64 HorizonChecksum;
+            f64 Latitude;
+            f64 Longitude;
+            f64 AltitudeThreshold;
+            f64 SunAltitude;
+            s64 Year;
+            s64 Noon;
+            u32 NightCount;
+            u32 BodyCount;
+            u32 WindowCount;
+            u32 Reserved;
+        };
+
+        static_assert(std::is_trivially_copyable_v<AlmanacHeader> && std::is_trivially_copyable_v<Almanac::Window>);
+        static_assert(sizeof(AlmanacHeader) % alignof(Almanac::Window) == 0 && sizeof(Almanac::Window) == 8);
+
+        constexpr s64 NanosecondsPerMinute = 60 * Instant::NanosecondsPerSecond;
+
+        /**
+         * Half of a sidereal day in minutes
+         */
+        constexpr f64 HalfSiderealDay = 718.0;
+
+        /**
+         * Step of the sampled search against a horizon in seconds, short enough for features of a few degrees
+         */
+        constexpr f64 HorizonSearchStep = 600.0;
+
+        /**
+         * Interval in fractional minutes since the beginning of the year
+         */
+        struct Interval {
+            f64 Begin;
+            f64 End;
+        };
+
+        /**
+         * Divides and rounds towards negative infinity
+         * @param dividend Dividend
+         * @param divisor Positive divisor
+         * @return quotient
+         */
+        s64 FloorDivide(s64 dividend, s64 divisor) noexcept {
+            const auto quotient = dividend / divisor;
+            return quotient * divisor > dividend ? quotient - 1 : quotient;
+        }
+
+        f64 MinutesSince(const Instant& epoch, const Instant& instant) noexcept {
+            return static_cast<f64>(instant - epoch) / static_cast<f64>(NanosecondsPerMinute);
+        }
+
+        /**
+         * Rounds an interval inwards to whole minutes
+         * @param interval Interval
+         * @param best Fractional minute of the highest altitude in the interval
+         * @return window, or nothing if the interval does not contain a whole minute
+         */
+        std::optional<Almanac::Window> ToWindow(const Interval& interval, f64 best) noexcept {
+            const auto begin = static_cast<s64>(std::ceil(interval.Begin));
+            const auto end = static_cast<s64>(std::floor(interval.End));
+            if (end - begin < 1) {
+                return {};
+            }
+            const auto minutes = std::min(end - begin, Almanac::MinutesPerDay);
+            const auto offset = std::clamp(static_cast<s64>(std::llround(best)) - begin, s64{ 0 }, minutes - 1);
+            return Almanac::Window{ static_cast<s32>(begin), static_cast<u16>(minutes), static_cast<u16>(offset) };
+        }
+
+        /**
+         * Appends the bytes of a trivially copyable value to the almanac
+         * @tparam Type Type of the value
+         * @param almanac Almanac
+         * @param value Value
+         */
+        template<typename Type>
+        void AppendAlmanac(std::string& almanac, const Type& value) noexcept {
+            almanac.append(reinterpret_cast<const char*>(&value), sizeof(Type));
+        }
+
+        /**
+         * Reads a trivially copyable value from the almanac, the almanac does not need to be aligned
+         * @tparam Type Type of the value
+         * @param almanac Almanac
+         * @param offset Offset of the value
+         * @return value
+         */
+        template<typename Type>
+        Type ReadAlmanac(std::string_view almanac, usize offset) noexcept {
+            Type value{};
+            std::memcpy(&value, almanac.data() + offset, sizeof(Type));
+            return value;
+        }
+    }// namespace
+
+    AlmanacInfo::AlmanacInfo() noexcept
+        : Observer({ 0.0, 0.0 }),
+          Year(2000),
+          AltitudeThreshold(0.0),
+          SunAltitude(-12.0),
+          Threads(1),
+          Horizon(nullptr) { }
+
+    u64 AlmanacInfo::HorizonChecksum() const noexcept {
+        return Horizon != nullptr ? Horizon->Checksum() : 0;
+    }
+
+    std::string Almanac::Generate(const Catalog& catalog, const AlmanacInfo& info, u64 catalogChecksum) noexcept {
+        const auto& bodies = catalog.GetBodies();
+        const auto epoch = Instant::FromDateTime({ info.Year, 1, 1, 0, 0, 0 });
+        const auto days = static_cast<usize>((Instant::FromDateTime({ info.Year + 1, 1, 1, 0, 0, 0 }) - epoch) /
+                                             Instant::NanosecondsPerDay);
+
+        // Local mean noon in minutes of utc, night n lasts from the noon of day n - 1 to the noon of day n
+        const auto noon = static_cast<s64>(std::llround(720.0 - 4.0 * info.Observer.Longitude));
+        const auto nightCount = days + 1;
+        const auto noonOf = [noon](s64 day) { return static_cast<f64>(noon + day * MinutesPerDay); };
+
+        RiseSetInfo span{};
+        span.Begin = epoch;
+        span.Begin.AddNanoseconds(static_cast<s64>(noonOf(-1)) * NanosecondsPerMinute);
+        span.End = epoch;
+        span.End.AddNanoseconds(static_cast<s64>(noonOf(static_cast<s64>(days))) * NanosecondsPerMinute);
+        span.Observer = info.Observer;
+
+        // The sun is the negated position of the earth, i.e. a planet without an orbit of its own
+        const Planet sun{ "Sun", {}, {} };
+        span.AltitudeThreshold = info.SunAltitude;
+        span.SearchStepSeconds = 1800.0;
+        const auto daylight = ComputeRiseSet(sun, span);
+
+        // The dark part of each night is the longest gap between the daylight windows
+        std::vector<Interval> nights(nightCount, Interval{ 0.0, 0.0 });
+        for (usize night = 0; night < nightCount; ++night) {
+            const auto nightBegin = noonOf(static_cast<s64>(night) - 1);
+            const auto nightEnd = noonOf(static_cast<s64>(night));
+            auto dark = nightBegin;
+            const auto gap = [&nights, night](f64 begin, f64 end) {
+                if (end - begin > nights[night].End - nights[night].Begin) {
+                    nights[night] = { begin, end };
+                }
+            };
+            for (const auto& window : daylight.Windows) {
+                const auto begin = std::max(MinutesSince(epoch, window.Begin), nightBegin);
+                const auto end = std::min(MinutesSince(epoch, window.End), nightEnd);
+                if (begin < end) {
+                    gap(dark, begin);
+                    dark = std::max(dark, end);
+                }
+            }
+            gap(dark, nightEnd);
+        }
+
+        // Each body is searched over the whole year at once and its windows are intersected with the nights. The
+        // horizon does not apply to the sun, the twilight depends on its altitude alone
+        RiseSetInfo bodySpan = span;
+        bodySpan.AltitudeThreshold = info.AltitudeThreshold;
+
+        // A horizon above the threshold is handled with two closed-form searches, below its lowest altitude a body is
+        // always obstructed and above its highest one never. Only the parts of the nights in between are sampled
+        const auto obstructs = info.Horizon != nullptr && info.Horizon->Highest() > info.AltitudeThreshold;
+        RiseSetInfo unobstructedSpan = span;
+        if (obstructs) {
+            bodySpan.AltitudeThreshold = std::max(info.AltitudeThreshold, info.Horizon->Lowest());
+            unobstructedSpan.AltitudeThreshold = info.Horizon->Highest();
+        }
+        const auto instantOf = [&epoch](f64 minutes) {
+            auto instant = epoch;
+            instant.AddNanoseconds(static_cast<s64>(std::llround(minutes * static_cast<f64>(NanosecondsPerMinute))));
+            return instant;
+        };
+
+        std::vector<std::vector<Window>> windows(bodies.size());
+        utility::ParallelFor(bodies.size(), 64, info.Threads, [&](usize begin, usize end) {
+            for (auto index = begin; index < end; ++index) {
+                const auto& body = bodies[index];
+                const auto result = ComputeRiseSet(body, bodySpan);
+                std::vector<f64> culminations{};
+                culminations.reserve(result.Culminations.size());
+                for (const auto& culmination : result.Culminations) {
+                    culminations.emplace_back(MinutesSince(epoch, culmination));
+                }
+                std::vector<Interval> unobstructed{};
+                if (obstructs) {
+                    for (const auto& window : ComputeRiseSet(body, unobstructedSpan).Windows) {
+                        unobstructed.push_back({ MinutesSince(epoch, window.Begin), MinutesSince(epoch, window.End) });
+                    }
+                }
+
+                const auto emit = [&](const Interval& observable) {
+                    // Between two upper culminations the altitude falls for half a sidereal day and then rises
+                    const auto next = std::lower_bound(culminations.begin(), culminations.end(), observable.Begin);
+                    const auto rising = next != culminations.end()
+                                                ? *next - observable.End < HalfSiderealDay
+                                                : next != culminations.begin() &&
+                                                          observable.Begin - *(next - 1) > HalfSiderealDay;
+                    auto best = rising ? observable.End : observable.Begin;
+                    if (next != culminations.end() && *next <= observable.End) {
+                        best = *next;
+                    }
+                    if (const auto rounded = ToWindow(observable, best)) {
+                        windows[index].emplace_back(*rounded);
+                    }
+                };
+
+                // Appends the windows above the horizon, a window that continues the previous one is joined with it
+                std::vector<Interval> clear{};
+                const auto append = [&clear](const Interval& interval) {
+                    if (!clear.empty() && interval.Begin - clear.back().End < 1e-6) {
+                        clear.back().End = std::max(clear.back().End, interval.End);
+                    } else {
+                        clear.emplace_back(interval);
+                    }
+                };
+                const auto sample = [&](const Interval& part) {
+                    RiseSetInfo obstructed = bodySpan;
+                    obstructed.Begin = instantOf(part.Begin);
+                    obstructed.End = instantOf(part.End);
+                    obstructed.AltitudeThreshold = info.AltitudeThreshold;
+                    obstructed.SearchStepSeconds = HorizonSearchStep;
+                    obstructed.Horizon = info.Horizon;
+                    for (const auto& window : ComputeRiseSet(body, obstructed).Windows) {
+                        append({ std::max(MinutesSince(epoch, window.Begin), part.Begin),
+                                 std::min(MinutesSince(epoch, window.End), part.End) });
+                    }
+                };
+
+                usize night = 0;
+                for (const auto& window : result.Windows) {
+                    const Interval up{ MinutesSince(epoch, window.Begin), MinutesSince(epoch, window.End) };
+                    while (night < nightCount && nights[night].End <= up.Begin) {
+                        ++night;
+                    }
+                    for (auto overlap = night; overlap < nightCount && nights[overlap].Begin < up.End; ++overlap) {
+                        const Interval observable{ std::max(up.Begin, nights[overlap].Begin),
+                                                   std::min(up.End, nights[overlap].End) };
+                        if (observable.Begin >= observable.End) {
+                            continue;
+                        }
+                        if (!obstructs) {
+                            emit(observable);
+                            continue;
+                        }
+
+                        // The unobstructed windows lie within the windows at the lowest altitude, so at most one of
+                        // them overlaps, and only the parts before and after it are sampled
+                        const auto above = std::partition_point(
+                                unobstructed.begin(), unobstructed.end(),
+                                [&observable](const Interval& interval) { return interval.End <= observable.Begin; });
+                        auto middle = Interval{ observable.End, observable.End };
+                        if (above != unobstructed.end() && above->Begin < observable.End) {
+                            middle = { std::max(above->Begin, observable.Begin), std::min(above->End, observable.End) };
+                        }
+                        clear.clear();
+                        sample({ observable.Begin, middle.Begin });
+                        if (middle.Begin < middle.End) {
+                            append(middle);
+                        }
+                        sample({ middle.End, observable.End });
+                        for (const auto& interval : clear) {
+                            emit(interval);
+                        }
+                    }
+                }
+            }
+        });
+
+        usize windowCount = 0;
+        for (const auto& bodyWindows : windows) {
+            windowCount += bodyWindows.size();
+        }
+
+        const AlmanacHeader header{ AlmanacMagic,
+                                    AlmanacVersion,
+                                    catalogChecksum,
+                                    info.HorizonChecksum(),
+                                    info.Observer.Latitude,
+                                    info.Observer.Longitude,
+                                    info.AltitudeThreshold,
+                                    info.SunAltitude,
+                                    info.Year,
+                                    noon,
+                                    static_cast<u32>(nightCount),
+                                    static_cast<u32>(bodies.size()),
+                                    static_cast<u32>(windowCount),
+                                    0 };
+
+        std::string almanac{};
+        almanac.reserve(sizeof(header) + (nightCount + windowCount) * sizeof(Window) +
+                        (bodies.size() + 1) * sizeof(u32));
+        AppendAlmanac(almanac, header);
+        for (const auto& night : nights) {
+            const auto window = ToWindow(night, 0.5 * (night.Begin + night.End));
+            AppendAlmanac(almanac, window.value_or(Window{ static_cast<s32>(night.Begin), 0, 0 }));
+        }
+        for (const auto& bodyWindows : windows) {
+            for (const auto& window : bodyWindows) {
+                AppendAlmanac(almanac, window);
+            }
+        }
+        u32 offset = 0;
+        for (const auto& bodyWindows : windows) {
+            AppendAlmanac(almanac, offset);
+            offset += static_cast<u32>(bodyWindows.size());
+        }
+        AppendAlmanac(almanac, offset);
+        return almanac;
+    }
+
+    std::optional<Almanac> Almanac::Open(std::string_view data, const AlmanacInfo& info, u64 catalogChecksum) noexcept {
+        if (data.size() < sizeof(AlmanacHeader)) {
+            return {};
+        }
+        const auto header = ReadAlmanac<AlmanacHeader>(data, 0);
+        if (header.Magic != AlmanacMagic || header.Version != AlmanacVersion ||
+            header.CatalogChecksum != catalogChecksum || header.HorizonChecksum != info.HorizonChecksum() ||
+            header.Latitude != info.Observer.Latitude || header.Longitude != info.Observer.Longitude ||
+            header.AltitudeThreshold != info.AltitudeThreshold || header.SunAltitude != info.SunAltitude ||
+            header.Year != info.Year) {
+            return {};
+        }
+
+        const auto windows = static_cast<usize>(header.NightCount) + header.WindowCount;
+        const auto expected = sizeof(AlmanacHeader) + windows * sizeof(Window) +
+                              (static_cast<usize>(header.BodyCount) + 1) * sizeof(u32);
+        if (data.size() != expected) {
+            return {};
+        }
+
+        Almanac almanac{};
+        almanac.data = data;
+        almanac.epoch = Instant::FromDateTime({ info.Year, 1, 1, 0, 0, 0 });
+        almanac.noon = header.Noon;
+        almanac.nightCount = header.NightCount;
+        almanac.bodyCount = header.BodyCount;
+        almanac.windowCount = header.WindowCount;
+
+        // The offsets have to be ascending, so that every range stays inside of the windows
+        u32 previous = 0;
+        for (usize body = 0; body <= almanac.bodyCount; ++body) {
+            const auto offset = ReadAlmanac<u32>(data, sizeof(AlmanacHeader) + windows * sizeof(Window) +
+                                                               body * sizeof(u32));
+            if (offset < previous || offset > almanac.windowCount || (body == 0 && offset != 0)) {
+                return {};
+            }
+            previous = offset;
+        }
+        if (previous != almanac.windowCount) {
+            return {};
+        }
+        return almanac;
+    }
+
+    Almanac::Window Almanac::WindowAt(usize index) const noexcept {
+        return ReadAlmanac<Window>(data, sizeof(AlmanacHeader) + index * sizeof(Window));
+    }
+
+    std::pair<usize, usize> Almanac::RangeOf(FixedHandle handle) const noexcept {
+        if (handle.Index >= bodyCount) {
+            return { 0, 0 };
+        }
+        const auto offsets = sizeof(AlmanacHeader) + (nightCount + windowCount) * sizeof(Window);
+        const auto first = ReadAlmanac<u32>(data, offsets + handle.Index * sizeof(u32));
+        const auto last = ReadAlmanac<u32>(data, offsets + (handle.Index + 1) * sizeof(u32));
+        return { nightCount + first, nightCount + last };
+    }
+
+    std::optional<usize> Almanac::NightOf(s64 minute) const noexcept {
+        const auto night = FloorDivide(minute - noon, MinutesPerDay) + 1;
+        if (night < 0 || night >= static_cast<s64>(nightCount)) {
+            return {};
+        }
+        return static_cast<usize>(night);
+    }
+
+    s64 Almanac::MinuteOf(const Instant& utc) const noexcept {
+        return FloorDivide(utc - epoch, NanosecondsPerMinute);
+    }
+
+    Instant Almanac::InstantOf(s64 minute) const noexcept {
+        auto instant = epoch;
+        return instant.AddNanoseconds(minute * NanosecondsPerMinute);
+    }
+
+    std::optional<Almanac::Window> Almanac::Night(const Instant& utc) const noexcept {
+        const auto night = NightOf(MinuteOf(utc));
+        if (!night) {
+            return {};
+        }
+        const auto window = WindowAt(*night);
+        if (window.Minutes == 0) {
+            return {};
+        }
+        return window;
+    }
+
+    std::optional<Almanac::Window> Almanac::Tonight(FixedHandle handle, const Instant& utc) const noexcept {
+        const auto night = NightOf(MinuteOf(utc));
+        if (!night) {
+            return {};
+        }
+        const auto nightBegin = noon + (static_cast<s64>(*night) - 1) * MinutesPerDay;
+        const auto nightEnd = nightBegin + MinutesPerDay;
+
+        // The windows of a body are ascending, so the first one of the night is found by bisection
+        auto [first, last] = RangeOf(handle);
+        while (first < last) {
+            const auto middle = first + (last - first) / 2;
+            if (WindowAt(middle).Begin < nightBegin) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+
+        std::optional<Window> longest{};
+        for (auto index = first; index < RangeOf(handle).second; ++index) {
+            const auto window = WindowAt(index);
+            if (window.Begin >= nightEnd) {
+                break;
+            }
+            if (!longest || window.Minutes > longest->Minutes) {
+                longest = window;
+            }
+        }
+        return longest;
+    }
+
+    bool Almanac::IsObservable(FixedHandle handle, const Instant& utc) const noexcept {
+        const auto minute = MinuteOf(utc);
+        auto [first, last] = RangeOf(handle);
+        const auto begin = first;
+        while (first < last) {
+            const auto middle = first + (last - first) / 2;
+            if (WindowAt(middle).Begin <= minute) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        if (first == begin) {
+            return false;
+        }
+        const auto window = WindowAt(first - 1);
+        return minute < window.Begin + window.Minutes;
+    }
+
+    std::vector<FixedHandle> Almanac::FilterTonight(const std::vector<FixedHandle>& handles,
+                                                    const Instant& utc) const noexcept {
+        std::vector<FixedHandle> result{};
+        for (const auto handle : handles) {
+            if (Tonight(handle, utc)) {
+                result.emplace_back(handle);
+            }
+        }
+        return result;
+    }
+
+    std::vector<Almanac::Window> Almanac::WindowsOf(FixedHandle handle) const noexcept {
+        const auto [first, last] = RangeOf(handle);
+        std::vector<Window> result{};
+        result.reserve(last - first);
+        for (auto index = first; index < last; ++index) {
+            result.emplace_back(WindowAt(index));
+        }
+        return result;
+    }
+
+    usize Almanac::BodyCount() const noexcept {
+        return bodyCount;
+    }
+}// namespace ephemeris
@@ -0,0 +1,190 @@
+#ifndef LIBENGINE_EPHEMERIS_ALMANAC_H
+#define LIBENGINE_EPHEMERIS_ALMANAC_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catalog.hpp"
+#include "coordinates.hpp"
+#include "horizon-profile.hpp"
+
+namespace ephemeris {
+
+    /**
+     * Describes the site, the year and the conditions of an almanac
+     */
+    struct AlmanacInfo {
+        Geographic Observer;
+        s64 Year;
+        f64 AltitudeThreshold;
+
+        /**
+         * Altitude of the sun, below which it is night, -12 degrees is the end of the nautical twilight
+         */
+        f64 SunAltitude;
+
+        /**
+         * Maximum number of threads, that compute the windows of the bodies. The result is the same for any number of
+         * threads
+         */
+        usize Threads;
+
+        /**
+         * Horizon, that the bodies have to be above in addition to the threshold, or nullptr for a flat horizon. The
+         * parts of the nights, in which the horizon decides, are sampled, which is considerably slower
+         */
+        std::shared_ptr<const HorizonProfile> Horizon;
+
+        AlmanacInfo() noexcept;
+
+        /**
+         * Identifies the horizon in the almanac file
+         * @return checksum of the horizon, or zero for a flat horizon
+         */
+        u64 HorizonChecksum() const noexcept;
+    };
+
+    /**
+     * @brief Precomputed windows, in which the fixed bodies of a catalog are above the altitude threshold during the
+     * night, for one site and one year. The nights run from local mean noon to local mean noon, the first one ends on
+     * the first day of the year. All times are whole minutes since the beginning of the year in utc.
+     *
+     * The almanac is a flat file of a header, one window per night, the windows of all bodies and the offset of the
+     * first window of each body, so that it is used directly from a mapped file without any parsing
+     */
+    class Almanac {
+    public:
+        /**
+         * Run of minutes
+         */
+        struct Window {
+            /** First minute since the beginning of the year in utc */
+            s32 Begin;
+            /** Number of minutes */
+            u16 Minutes;
+            /** Minute of the highest altitude, relative to the first minute */
+            u16 Best;
+        };
+
+        static constexpr s64 MinutesPerDay = 1440;
+
+    private:
+        std::string_view data{};
+        Instant epoch{};
+        s64 noon{ 0 };
+        usize nightCount{ 0 };
+        usize bodyCount{ 0 };
+        usize windowCount{ 0 };
+
+        /**
+         * Reads a window of the file
+         * @param index Index of the window, the windows of the nights come first
+         * @return window
+         */
+        Window WindowAt(usize index) const noexcept;
+
+        /**
+         * Reads the range of the windows of a body
+         * @param handle Handle of the body
+         * @return indices of the first and one past the last window
+         */
+        std::pair<usize, usize> RangeOf(FixedHandle handle) const noexcept;
+
+        /**
+         * Finds the night, that contains a minute
+         * @param minute Minute
+         * @return index of the night, or nothing if the minute is outside of the almanac
+         */
+        std::optional<usize> NightOf(s64 minute) const noexcept;
+
+    public:
+        Almanac() noexcept = default;
+
+        /**
+         * @brief Computes the almanac of the fixed bodies of a catalog. The nights are found with the sampled search
+         * of ComputeRiseSet on the sun, and the windows of the bodies with the closed-form search, which is refined by
+         * the sampled one where a horizon decides. The events are rounded inwards to whole minutes
+         * @param catalog Catalog
+         * @param info Site, year and conditions
+         * @param catalogChecksum Checksum of the source data of the catalog, as computed by Catalog::SourceChecksum
+         * @return content of the almanac file
+         */
+        static std::string Generate(const Catalog& catalog, const AlmanacInfo& info, u64 catalogChecksum) noexcept;
+
+        /**
+         * @brief Opens the content of an almanac file, that is not copied and has to outlive the almanac
+         * @param data Content, usually a mapped file
+         * @param info Site, year, horizon and conditions, that the almanac must have been generated for
+         * @param catalogChecksum Checksum of the source data of the catalog
+         * @return almanac, or nothing if the content is malformed, of another version or for other conditions
+         */
+        static std::optional<Almanac> Open(std::string_view data,
+                                           const AlmanacInfo& info,
+                                           u64 catalogChecksum) noexcept;
+
+        /**
+         * @brief Converts an instant into a minute of the almanac
+         * @param utc Instant in utc
+         * @return minute, rounded down
+         */
+        s64 MinuteOf(const Instant& utc) const noexcept;
+
+        /**
+         * @brief Converts a minute of the almanac into an instant
+         * @param minute Minute
+         * @return instant in utc
+         */
+        Instant InstantOf(s64 minute) const noexcept;
+
+        /**
+         * @brief Finds the dark part of the night, that contains an instant, the night lasts from local mean noon to
+         * the following one
+         * @param utc Instant in utc
+         * @return window, or nothing if the instant is outside of the almanac or the sun does not set far enough
+         */
+        std::optional<Window> Night(const Instant& utc) const noexcept;
+
+        /**
+         * @brief Finds the longest window of a body in the night, that contains an instant
+         * @param handle Handle of the body
+         * @param utc Instant in utc
+         * @return window, or nothing if the body can not be observed in that night
+         */
+        std::optional<Window> Tonight(FixedHandle handle, const Instant& utc) const noexcept;
+
+        /**
+         * @brief Checks if a body is observable at an instant
+         * @param handle Handle of the body
+         * @param utc Instant in utc
+         * @return boolean value
+         */
+        bool IsObservable(FixedHandle handle, const Instant& utc) const noexcept;
+
+        /**
+         * @brief Retains the bodies, that can be observed in the night, that contains an instant
+         * @param handles Handles of the catalog
+         * @param utc Instant in utc
+         * @return handles in the same order
+         */
+        std::vector<FixedHandle> FilterTonight(const std::vector<FixedHandle>& handles,
+                                               const Instant& utc) const noexcept;
+
+        /**
+         * @brief Retrieves the windows of a body
+         * @param handle Handle of the body
+         * @return windows by ascending beginning
+         */
+        std::vector<Window> WindowsOf(FixedHandle handle) const noexcept;
+
+        /**
+         * @brief Number of bodies in the almanac
+         * @return size
+         */
+        usize BodyCount() const noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_ALMANAC_H
@@ -0,0 +1,43 @@
+#include "attribute-mask.hpp"
+
+namespace ephemeris {
+
+    static_assert(AttributeMask::ClassificationOffset + ClassificationCount <= 128, "Attributes exceed the mask");
+
+    void AttributeMask::Set(usize bit) noexcept {
+        if (bit < 64) {
+            low |= u64{ 1 } << bit;
+        } else {
+            high |= u64{ 1 } << (bit - 64);
+        }
+    }
+
+    AttributeMask AttributeMask::OfBody(Classification classification, ConstellationId constellation) noexcept {
+        AttributeMask mask{};
+        mask.Set(constellation);
+        mask.Set(ClassificationOffset + static_cast<usize>(classification));
+        return mask;
+    }
+
+    AttributeMask AttributeMask::Accepting(const ClassificationMask& classifications,
+                                           const ConstellationMask& constellations) noexcept {
+        AttributeMask mask{};
+        if (constellations.none()) {
+            for (usize id = 0; id <= ConstellationCount; ++id) {
+                mask.Set(id);
+            }
+        } else {
+            for (usize id = 0; id < ConstellationCount; ++id) {
+                if (constellations.test(id)) {
+                    mask.Set(id);
+                }
+            }
+        }
+        for (usize classification = 0; classification < ClassificationCount; ++classification) {
+            if (classifications.none() || classifications.test(classification)) {
+                mask.Set(ClassificationOffset + classification);
+            }
+        }
+        return mask;
+    }
+}// namespace ephemeris
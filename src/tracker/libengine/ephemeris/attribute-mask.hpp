@@ -0,0 +1,62 @@
+#ifndef LIBENGINE_EPHEMERIS_ATTRIBUTEMASK_H
+#define LIBENGINE_EPHEMERIS_ATTRIBUTEMASK_H
+
+#include "constellation.hpp"
+#include "fixed-body.hpp"
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief 128 bit mask over the categorical attributes of a fixed body. The constellations including the unknown one
+     * occupy the bits [0, 89), the classifications the bits [89, 105). A body has exactly one bit of each group set, a
+     * filter has every accepted bit set, so that a body is accepted if it has no bit outside of the filter
+     */
+    class AttributeMask {
+    private:
+        u64 low{ 0 };
+        u64 high{ 0 };
+
+        /**
+         * Sets a single bit
+         * @param bit Position of the bit
+         */
+        void Set(usize bit) noexcept;
+
+    public:
+        /**
+         * First bit of the classifications
+         */
+        static constexpr usize ClassificationOffset = ConstellationCount + 1;
+
+        AttributeMask() noexcept = default;
+
+        /**
+         * Creates the mask of a body
+         * @param classification Classification of the body
+         * @param constellation Constellation of the body
+         * @return mask with two bits set
+         */
+        static AttributeMask OfBody(Classification classification, ConstellationId constellation) noexcept;
+
+        /**
+         * Creates the mask of a filter, an empty set accepts all of its group, including unknown constellations
+         * @param classifications Accepted classifications
+         * @param constellations Accepted constellations
+         * @return mask
+         */
+        static AttributeMask Accepting(const ClassificationMask& classifications,
+                                       const ConstellationMask& constellations) noexcept;
+
+        /**
+         * Checks if the body mask is accepted by the filter mask, without any branch
+         * @param filter Mask obtained by Accepting
+         * @return boolean value
+         */
+        bool AcceptedBy(const AttributeMask& filter) const noexcept {
+            return ((low & ~filter.low) | (high & ~filter.high)) == 0;
+        }
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_ATTRIBUTEMASK_H
@@ -0,0 +1,173 @@
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../clock.hpp"
+#include "../math.hpp"
+#include "body-columns.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Number of bodies that are rotated at once, so that the rotated vectors stay in the L1 cache
+         */
+        constexpr usize BlockSize = 256;
+
+        /**
+         * Applies one row of the matrix to the columns in [begin, end)
+         * @param row Row of the matrix
+         * @param x X column
+         * @param y Y column
+         * @param z Z column
+         * @param begin First index
+         * @param end One past the last index
+         * @param out Receives end - begin values
+         */
+        void RotateRow(const std::array<f64, 3>& row, const f64* x, const f64* y, const f64* z, usize begin, usize end,
+                       f64* out) noexcept {
+            auto index = begin;
+#if defined(__AVX2__)
+            const auto r0 = _mm256_set1_pd(row[0]);
+            const auto r1 = _mm256_set1_pd(row[1]);
+            const auto r2 = _mm256_set1_pd(row[2]);
+            for (; index + 4 <= end; index += 4) {
+                auto value = _mm256_mul_pd(r0, _mm256_loadu_pd(x + index));
+                value = _mm256_fmadd_pd(r1, _mm256_loadu_pd(y + index), value);
+                value = _mm256_fmadd_pd(r2, _mm256_loadu_pd(z + index), value);
+                _mm256_storeu_pd(out + index - begin, value);
+            }
+#endif
+            for (; index < end; ++index) {
+                out[index - begin] = row[0] * x[index] + row[1] * y[index] + row[2] * z[index];
+            }
+        }
+    }// namespace
+
+    void BodyColumns::Assign(const std::vector<FixedBody>& bodies) noexcept {
+        x.resize(bodies.size());
+        y.resize(bodies.size());
+        z.resize(bodies.size());
+        for (usize index = 0; index < bodies.size(); ++index) {
+            const auto& position = bodies[index].Position;
+            const auto cosDeclination = math::Cosine(position.Declination);
+            x[index] = cosDeclination * math::Cosine(position.RightAscension);
+            y[index] = cosDeclination * math::Sine(position.RightAscension);
+            z[index] = math::Sine(position.Declination);
+        }
+    }
+
+    usize BodyColumns::Size() const noexcept {
+        return x.size();
+    }
+
+    Matrix3x3 BodyColumns::HorizontalMatrix(const Instant& utc, const Geographic& observer) noexcept {
+        const auto siderealTime = Clock::GreenwichMeanSiderealTime(utc.JulianMidnight(), utc.DayFraction());
+        const auto localSiderealTime = siderealTime + observer.Longitude;
+        const auto sinSiderealTime = math::Sine(localSiderealTime);
+        const auto cosSiderealTime = math::Cosine(localSiderealTime);
+        const auto sinLatitude = math::Sine(observer.Latitude);
+        const auto cosLatitude = math::Cosine(observer.Latitude);
+
+        // Same rotations as in ObserveFrame, the hour angle frame followed by the rotation around the y-axis
+        Matrix3x3 horizon{};
+        horizon[0] = { sinLatitude * cosSiderealTime, sinLatitude * sinSiderealTime, -cosLatitude };
+        horizon[1] = { sinSiderealTime, -cosSiderealTime, 0.0 };
+        horizon[2] = { cosLatitude * cosSiderealTime, cosLatitude * sinSiderealTime, sinLatitude };
+        return horizon * TransformMatrix(EpochTransform::FixedB2000, utc.JulianCenturies());
+    }
+
+    void BodyColumns::Observe(const Matrix3x3& matrix, f64* altitudes, f64* azimuths) const noexcept {
+        std::array<f64, BlockSize> horizontalX{};
+        std::array<f64, BlockSize> horizontalY{};
+        std::array<f64, BlockSize> horizontalZ{};
+        for (usize begin = 0; begin < Size(); begin += BlockSize) {
+            const auto end = std::min(begin + BlockSize, Size());
+            RotateRow(matrix[0], x.data(), y.data(), z.data(), begin, end, horizontalX.data());
+            RotateRow(matrix[1], x.data(), y.data(), z.data(), begin, end, horizontalY.data());
+            RotateRow(matrix[2], x.data(), y.data(), z.data(), begin, end, horizontalZ.data());
+            for (auto index = begin; index < end; ++index) {
+                const auto local = index - begin;
+                altitudes[index] = math::ArcSine(std::clamp(horizontalZ[local], -1.0, 1.0));
+                azimuths[index] = math::ArcTangent2(horizontalY[local], horizontalX[local]) + 180.0;
+            }
+        }
+    }
+
+    void BodyColumns::Visible(const Matrix3x3& matrix,
+                              f64 altitudeThreshold,
+                              std::vector<u8>& visible,
+                              const HorizonProfile* horizon) const noexcept {
+        visible.resize(Size());
+
+        // The arcsine is monotonic, so the threshold can be compared against the z component directly
+        const auto threshold = math::Sine(std::clamp(altitudeThreshold, -90.0, 90.0));
+        std::array<f64, BlockSize> horizontalX{};
+        std::array<f64, BlockSize> horizontalY{};
+        std::array<f64, BlockSize> horizontalZ{};
+        for (usize begin = 0; begin < Size(); begin += BlockSize) {
+            const auto end = std::min(begin + BlockSize, Size());
+            RotateRow(matrix[2], x.data(), y.data(), z.data(), begin, end, horizontalZ.data());
+            if (horizon == nullptr) {
+                for (auto index = begin; index < end; ++index) {
+                    visible[index] = horizontalZ[index - begin] >= threshold ? 1 : 0;
+                }
+                continue;
+            }
+
+            // The direction selects the entry of the horizon, which is then compared the same way
+            RotateRow(matrix[0], x.data(), y.data(), z.data(), begin, end, horizontalX.data());
+            RotateRow(matrix[1], x.data(), y.data(), z.data(), begin, end, horizontalY.data());
+            for (auto index = begin; index < end; ++index) {
+                const auto local = index - begin;
+                const auto obstruction = horizon->SineAltitude(horizontalX[local], horizontalY[local]);
+                visible[index] = horizontalZ[local] >= std::max(threshold, obstruction) ? 1 : 0;
+            }
+        }
+    }
+
+    void BodyColumns::Visible(const Matrix3x3& matrix,
+                              f64 altitudeThreshold,
+                              const std::vector<u32>& indices,
+                              std::vector<u8>& visible,
+                              const HorizonProfile* horizon) const noexcept {
+        const auto threshold = math::Sine(std::clamp(altitudeThreshold, -90.0, 90.0));
+        visible.resize(indices.size());
+        if (horizon == nullptr) {
+            std::vector<f64> sines{};
+            SineAltitudes(matrix, indices, sines);
+            for (usize selected = 0; selected < indices.size(); ++selected) {
+                visible[selected] = sines[selected] >= threshold ? 1 : 0;
+            }
+            return;
+        }
+
+        const auto& row0 = matrix[0];
+        const auto& row1 = matrix[1];
+        const auto& row2 = matrix[2];
+        for (usize selected = 0; selected < indices.size(); ++selected) {
+            const auto index = indices[selected];
+            const auto horizontalX = row0[0] * x[index] + row0[1] * y[index] + row0[2] * z[index];
+            const auto horizontalY = row1[0] * x[index] + row1[1] * y[index] + row1[2] * z[index];
+            const auto horizontalZ = row2[0] * x[index] + row2[1] * y[index] + row2[2] * z[index];
+            const auto obstruction = horizon->SineAltitude(horizontalX, horizontalY);
+            visible[selected] = horizontalZ >= std::max(threshold, obstruction) ? 1 : 0;
+        }
+    }
+
+    void BodyColumns::SineAltitudes(const Matrix3x3& matrix,
+                                    const std::vector<u32>& indices,
+                                    std::vector<f64>& sines) const noexcept {
+        sines.resize(indices.size());
+
+        // The sine of the altitude is the z component of the horizontal vector
+        const auto& row = matrix[2];
+        for (usize selected = 0; selected < indices.size(); ++selected) {
+            const auto index = indices[selected];
+            sines[selected] = row[0] * x[index] + row[1] * y[index] + row[2] * z[index];
+        }
+    }
+}// namespace ephemeris
@@ -0,0 +1,97 @@
+#ifndef LIBENGINE_EPHEMERIS_BODYCOLUMNS_H
+#define LIBENGINE_EPHEMERIS_BODYCOLUMNS_H
+
+#include <memory>
+#include <vector>
+
+#include "coordinates.hpp"
+#include "fixed-body.hpp"
+#include "horizon-profile.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Structure of arrays of the catalog positions of fixed bodies as unit vectors. The precession, the
+     * sidereal rotation and the rotation into the horizon of the observer are combined into one matrix per instant,
+     * so that the whole catalog is transformed in a single pass over contiguous memory
+     */
+    class BodyColumns {
+    private:
+        std::vector<f64> x{};
+        std::vector<f64> y{};
+        std::vector<f64> z{};
+
+    public:
+        BodyColumns() noexcept = default;
+
+        /**
+         * @brief Rebuilds the columns, the index of each body is preserved
+         * @param bodies Fixed bodies
+         */
+        void Assign(const std::vector<FixedBody>& bodies) noexcept;
+
+        /**
+         * @brief Number of bodies in the columns
+         * @return size
+         */
+        usize Size() const noexcept;
+
+        /**
+         * @brief Combined matrix, that maps a B2000 unit vector to the horizon of the observer at the instant. The
+         * horizontal vector points north at zero azimuth, just like the result of ObserveGeographic
+         * @param utc Instant in utc
+         * @param observer Observer
+         * @return matrix
+         */
+        static Matrix3x3 HorizontalMatrix(const Instant& utc, const Geographic& observer) noexcept;
+
+        /**
+         * @brief Computes altitude and azimuth of every body
+         * @param matrix Matrix obtained by HorizontalMatrix
+         * @param altitudes Output of Size() altitudes in degrees
+         * @param azimuths Output of Size() azimuths in degrees
+         */
+        void Observe(const Matrix3x3& matrix, f64* altitudes, f64* azimuths) const noexcept;
+
+        /**
+         * @brief Checks which bodies are at or above the altitude threshold and the horizon, without evaluating any
+         * trigonometric function per body
+         * @param matrix Matrix obtained by HorizontalMatrix
+         * @param altitudeThreshold Threshold in degrees
+         * @param visible Receives 1 for each visible and 0 for each invisible body
+         * @param horizon Horizon profile, or nullptr for a flat horizon
+         */
+        void Visible(const Matrix3x3& matrix,
+                     f64 altitudeThreshold,
+                     std::vector<u8>& visible,
+                     const HorizonProfile* horizon = nullptr) const noexcept;
+
+        /**
+         * @brief Checks which of the selected bodies are at or above the altitude threshold and the horizon, so that
+         * the cost scales with the selection rather than the catalog
+         * @param matrix Matrix obtained by HorizontalMatrix
+         * @param altitudeThreshold Threshold in degrees
+         * @param indices Indices of the selected bodies
+         * @param visible Receives 1 for each visible and 0 for each invisible body, in the order of the indices
+         * @param horizon Horizon profile, or nullptr for a flat horizon
+         */
+        void Visible(const Matrix3x3& matrix,
+                     f64 altitudeThreshold,
+                     const std::vector<u32>& indices,
+                     std::vector<u8>& visible,
+                     const HorizonProfile* horizon = nullptr) const noexcept;
+
+        /**
+         * @brief Computes the sine of the altitude of the selected bodies, which is monotonic in the altitude and
+         * does not need any trigonometric function per body
+         * @param matrix Matrix obtained by HorizontalMatrix
+         * @param indices Indices of the selected bodies
+         * @param sines Receives the sine of each altitude, in the order of the indices
+         */
+        void SineAltitudes(const Matrix3x3& matrix,
+                           const std::vector<u32>& indices,
+                           std::vector<f64>& sines) const noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_BODYCOLUMNS_H
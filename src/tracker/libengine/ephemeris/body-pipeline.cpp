@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cmath>
+
+#include "../math.hpp"
+#include "body-pipeline.hpp"
+#include "utility/async.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Number of seconds of a unit, if the unit has a fixed length
+         * @param unit Unit
+         * @return seconds, or nothing for calendar units like months and years
+         */
+        std::optional<f64> UnitSeconds(DateTime::Unit unit) noexcept {
+            switch (unit) {
+                case DateTime::Unit::Seconds:
+                    return 1.0;
+                case DateTime::Unit::Minutes:
+                    return 60.0;
+                case DateTime::Unit::Hours:
+                    return 3600.0;
+                case DateTime::Unit::Days:
+                    return 86400.0;
+                case DateTime::Unit::Months:
+                case DateTime::Unit::Years:
+                    return {};
+            }
+            return {};
+        }
+
+        /**
+         * Smallest number of steps, for which another thread is employed
+         */
+        constexpr usize MinimumChunkSize = 512;
+
+        /**
+         * Upper bound of the angular motion of catalog positions due to precession in degrees per day
+         */
+        constexpr f64 PrecessionRate = 50.3 / 3600.0 / 365.25;
+    }// namespace
+
+    ComputeInfo::ComputeInfo() noexcept
+        : Date(DateTime::Now()),
+          Observer({ 0.0, 0.0 }),
+          Steps(1440),
+          StepSize(1),
+          Unit(DateTime::Unit::Minutes),
+          SiderealRecurrence(false),
+          RecurrenceTolerance(1e-4),
+          ReanchorInterval(3600),
+          Threads(1) { }
+
+    namespace pipeline {
+
+        std::optional<BatchInfo> ToBatch(const ComputeInfo& info) noexcept {
+            if (const auto seconds = UnitSeconds(info.Unit)) {
+                // The utc offset is resolved once for the whole time series
+                const auto julianDay = Clock::ToUtc(Instant::FromDateTime(info.Date)).JulianDay();
+                return BatchInfo{ julianDay, *seconds * static_cast<f64>(info.StepSize), info.Steps, info.Observer,
+                                  info.Threads };
+            }
+            return {};
+        }
+
+        usize RecurrenceInterval(const BatchInfo& info, f64 tolerance, usize reanchorInterval) noexcept {
+            const auto driftPerStep = PrecessionRate * std::fabs(info.StepSeconds) / 86400.0;
+            const auto steps = driftPerStep > 0.0 ? tolerance / driftPerStep : static_cast<f64>(reanchorInterval);
+            return std::max<usize>(1, std::min(reanchorInterval, static_cast<usize>(std::max(steps, 0.0))));
+        }
+
+        Matrix3x3 SiderealStepRotation(const BatchInfo& info, const ObserverFrame& frame) noexcept {
+            Matrix3x3 latitude{};
+            latitude[0] = { frame.SinLatitude, 0.0, -frame.CosLatitude };
+            latitude[1] = { 0.0, 1.0, 0.0 };
+            latitude[2] = { frame.CosLatitude, 0.0, frame.SinLatitude };
+            const auto stepDays = info.StepSeconds / 86400.0;
+            const auto siderealStep = math::Mod(360.0 * 1.0027379093 * stepDays, 360.0);
+            return latitude * RotationMatrix(RotationAxis::Z, siderealStep) * latitude.Transpose();
+        }
+
+        std::pair<f64, f64> BatchSpan(const BatchInfo& info) noexcept {
+            // The same arithmetic as in RunBatch
+            const auto steps = static_cast<f64>(std::max<usize>(info.Count, 1) - 1);
+            const auto first = (info.JulianDay - 2451545.0) / 36525.0;
+            const auto last = ((info.JulianDay - 2451545.0) + steps * (info.StepSeconds / 86400.0)) / 36525.0;
+            return { std::min(first, last), std::max(first, last) };
+        }
+
+        std::pair<f64, f64> CalendarSpan(const ComputeInfo& info) noexcept {
+            // The same arithmetic as in RunCalendar, the calendar steps are monotonic
+            const auto start = Instant::FromDateTime(info.Date);
+            const auto utcOffset = Clock::UtcOffset();
+            const auto at = [&](usize step) {
+                auto utc = start;
+                utc.Add(static_cast<s64>(step * info.StepSize), info.Unit).AddSeconds(utcOffset);
+                return utc.JulianCenturies();
+            };
+            const auto first = at(0);
+            const auto last = at(std::max<usize>(info.Steps, 1) - 1);
+            return { std::min(first, last), std::max(first, last) };
+        }
+
+        ComputeResult RunChunked(usize count,
+                                 usize threads,
+                                 usize alignment,
+                                 const std::function<void(ComputeResult&, usize, usize)>& kernel) noexcept {
+            ComputeResult result{};
+            result.Altitudes.resize(count);
+            result.Azimuths.resize(count);
+
+            const auto chunks = std::max<usize>(1, std::min(threads, count / MinimumChunkSize));
+            alignment = std::max<usize>(alignment, 1);
+            const auto chunkSize = ((count + chunks - 1) / chunks + alignment - 1) / alignment * alignment;
+            utility::ParallelFor(count, chunkSize, chunks,
+                                 [&result, &kernel](usize begin, usize end) { kernel(result, begin, end); });
+            return result;
+        }
+    }// namespace pipeline
+}// namespace ephemeris
@@ -0,0 +1,350 @@
+#ifndef LIBENGINE_EPHEMERIS_BODYPIPELINE_H
+#define LIBENGINE_EPHEMERIS_BODYPIPELINE_H
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../clock.hpp"
+#include "../date-time.hpp"
+#include "../instant.hpp"
+#include "coordinates.hpp"
+#include "fixed-body.hpp"
+#include "planet-cache.hpp"
+#include "planet.hpp"
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    struct ComputeResult {
+        std::vector<f64> Altitudes;
+        std::vector<f64> Azimuths;
+    };
+
+    struct ComputeInfo {
+        DateTime Date;
+        Geographic Observer;
+        std::size_t Steps;
+        std::size_t StepSize;
+        DateTime::Unit Unit;
+
+        /**
+         * Fixed bodies only: advance the horizontal vector with a constant sidereal rotation per step instead of
+         * evaluating precession and sidereal time for every step. Calendar units always use the full computation
+         */
+        bool SiderealRecurrence;
+
+        /**
+         * Maximum drift in degrees, that the recurrence may accumulate before it is re-anchored to the full
+         * computation. The drift is dominated by the neglected precession of about 50 arc seconds per year
+         */
+        f64 RecurrenceTolerance;
+
+        /**
+         * Maximum number of steps between two re-anchors of the recurrence
+         */
+        std::size_t ReanchorInterval;
+
+        /**
+         * Maximum number of threads, that compute the time series. The result is the same for any number of threads
+         */
+        std::size_t Threads;
+
+        ComputeInfo() noexcept;
+    };
+
+    /**
+     * Describes a time series on a continuous julian time axis, which means that there is no calendar arithmetic
+     * involved when stepping through time
+     */
+    struct BatchInfo {
+        f64 JulianDay;
+        f64 StepSeconds;
+        std::size_t Count;
+        Geographic Observer;
+        std::size_t Threads = 1;
+    };
+
+    /**
+     * @brief Maps a body to its rectangular position with the equinox of date, so that the time series of any body
+     * kind are computed by the same pipeline without virtual dispatch. A body kind joins the pipeline by specializing
+     * the provider with
+     *  - a constructor from `const Body&`, which precomputes everything that does not depend on time,
+     *  - `Vector3 operator()(f64 julianCenturies) const`, whose length is irrelevant, and
+     *  - `static constexpr bool FixedOnSphere`, which allows the sidereal recurrence for bodies that only move by
+     *    precession, and optionally
+     *  - a constructor from `const Body&` and the first and last time of the series in julian centuries, which is
+     *    preferred by the pipeline and lets the provider prepare caches for exactly that span
+     *
+     * The provider may refer to the body, which has to outlive it
+     * @tparam Body Body kind
+     */
+    template<typename Body>
+    struct PositionProvider;
+
+    /**
+     * The positions of a planet are taken from a PlanetSpan, whose intervals are fitted before the series runs, so the
+     * result does not depend on the background worker of the PlanetCache. Without a span the cache is bypassed
+     */
+    template<>
+    struct PositionProvider<Planet> {
+        static constexpr bool FixedOnSphere = false;
+
+        explicit PositionProvider(const Planet& planet) noexcept : span(planet, 0.0, -1.0) { }
+
+        PositionProvider(const Planet& planet, f64 firstCenturies, f64 lastCenturies) noexcept
+            : span(planet, firstCenturies, lastCenturies) { }
+
+        Vector3 operator()(f64 julianCenturies) const noexcept {
+            return TransformMatrix(EpochTransform::EclipticJ2000, julianCenturies) *
+                   span.GetEclipticVector(julianCenturies);
+        }
+
+    private:
+        PlanetSpan span;
+    };
+
+    /**
+     * The J2000 vector of a fixed body does not depend on time, so only the precession is done per call
+     */
+    template<>
+    struct PositionProvider<FixedBody> {
+        static constexpr bool FixedOnSphere = true;
+
+        explicit PositionProvider(const FixedBody& body) noexcept : cartesian(EquatorialToVector(body.Position)) { }
+
+        Vector3 operator()(f64 julianCenturies) const noexcept {
+            return TransformMatrix(EpochTransform::FixedB2000, julianCenturies) * cartesian;
+        }
+
+    private:
+        Vector3 cartesian;
+    };
+
+    /**
+     * @brief Checks if a body kind has a usable PositionProvider
+     * @tparam Body Body kind
+     */
+    template<typename Body, typename = void>
+    struct IsBody : std::false_type { };
+
+    template<typename Body>
+    struct IsBody<Body,
+                  std::void_t<decltype(PositionProvider<Body>::FixedOnSphere),
+                              decltype(std::declval<const PositionProvider<Body>&>()(f64{}))>>
+        : std::disjunction<std::is_constructible<PositionProvider<Body>, const Body&>,
+                           std::is_constructible<PositionProvider<Body>, const Body&, f64, f64>> { };
+
+    /**
+     * The strategies of the pipeline, which are templated on the position provider and instantiated per body kind
+     */
+    namespace pipeline {
+
+        /**
+         * Converts a ComputeInfo to a batch, which is only possible for units with a fixed length
+         * @param info ComputeInfo
+         * @return batch, or nothing if the unit requires calendar arithmetic
+         */
+        std::optional<BatchInfo> ToBatch(const ComputeInfo& info) noexcept;
+
+        /**
+         * Number of steps between two re-anchors of the recurrence, such that the neglected precession stays within
+         * the tolerance
+         * @param info Batch description
+         * @param tolerance Tolerance in degrees
+         * @param reanchorInterval Upper limit of the number of steps
+         * @return number of steps, at least one
+         */
+        usize RecurrenceInterval(const BatchInfo& info, f64 tolerance, usize reanchorInterval) noexcept;
+
+        /**
+         * Rotation of the horizon vector by the sidereal angle of one step. A rotation of the hour angle frame is a
+         * rotation about the z-axis, which is conjugated with the latitude rotation of the horizon
+         * @param info Batch description
+         * @param frame Observer frame
+         * @return rotation matrix
+         */
+        Matrix3x3 SiderealStepRotation(const BatchInfo& info, const ObserverFrame& frame) noexcept;
+
+        /**
+         * First and last time of a batch
+         * @param info Batch description
+         * @return julian centuries since J2000, the first is not larger than the last
+         */
+        std::pair<f64, f64> BatchSpan(const BatchInfo& info) noexcept;
+
+        /**
+         * First and last time of a time series with calendar aware stepping
+         * @param info ComputeInfo
+         * @return julian centuries since J2000, the first is not larger than the last
+         */
+        std::pair<f64, f64> CalendarSpan(const ComputeInfo& info) noexcept;
+
+        /**
+         * Creates the provider of a body, with the span of the series if the provider accepts it
+         * @tparam Body Body kind
+         * @param body Body
+         * @param span First and last time of the series in julian centuries
+         * @return position provider
+         */
+        template<typename Body>
+        PositionProvider<Body> MakeProvider(const Body& body, const std::pair<f64, f64>& span) noexcept {
+            if constexpr (std::is_constructible_v<PositionProvider<Body>, const Body&, f64, f64>) {
+                return PositionProvider<Body>{ body, span.first, span.second };
+            } else {
+                return PositionProvider<Body>{ body };
+            }
+        }
+
+        /**
+         * Runs the kernel over all steps in contiguous chunks on the shared thread pool. Each chunk writes to its own
+         * range of the preallocated result, and every step only depends on its index, so the result does not depend
+         * on the number of threads
+         * @param count Number of steps
+         * @param threads Maximum number of threads
+         * @param alignment Chunks begin at multiples of the alignment
+         * @param kernel Kernel, that is called once per chunk
+         * @return altitudes and azimuths of each step
+         */
+        ComputeResult RunChunked(usize count,
+                                 usize threads,
+                                 usize alignment,
+                                 const std::function<void(ComputeResult&, usize, usize)>& kernel) noexcept;
+
+        /**
+         * Runs a batch
+         * @tparam Provider PositionProvider of the body
+         * @param info Batch description
+         * @param provider Position provider
+         * @return altitudes and azimuths of each step
+         */
+        template<typename Provider>
+        ComputeResult RunBatch(const BatchInfo& info, const Provider& provider) noexcept {
+            // The elapsed time is kept apart from the julian day, as adding it to the large julian day costs precision
+            const ObserverFrame frame{ info.Observer };
+            const auto stepDays = info.StepSeconds / 86400.0;
+            return RunChunked(info.Count, info.Threads, 1, [&](ComputeResult& result, usize begin, usize end) {
+                for (auto step = begin; step < end; ++step) {
+                    const auto elapsedDays = static_cast<f64>(step) * stepDays;
+                    const auto julianCenturies = ((info.JulianDay - 2451545.0) + elapsedDays) / 36525.0;
+                    const auto position = provider(julianCenturies);
+                    const auto siderealTime = Clock::GreenwichMeanSiderealTime(info.JulianDay, elapsedDays);
+                    const auto horizontal = ObserveFrame(position, siderealTime, frame);
+                    result.Altitudes[step] = horizontal.Altitude;
+                    result.Azimuths[step] = horizontal.Azimuth;
+                }
+            });
+        }
+
+        /**
+         * Runs a batch of a body that is fixed on the celestial sphere. Every anchor is computed in full, the steps in
+         * between are advanced by the sidereal rotation, which is a constant rotation about the celestial pole
+         * expressed in the horizon of the observer
+         * @tparam Provider PositionProvider of the body
+         * @param info Batch description
+         * @param provider Position provider
+         * @param reanchorInterval Number of steps between two anchors
+         * @return altitudes and azimuths of each step
+         */
+        template<typename Provider>
+        ComputeResult RunRecurrence(const BatchInfo& info, const Provider& provider, usize reanchorInterval) noexcept {
+            const ObserverFrame frame{ info.Observer };
+            const auto stepDays = info.StepSeconds / 86400.0;
+            const auto step = SiderealStepRotation(info, frame);
+
+            const auto kernel = [&](ComputeResult& result, usize begin, usize end) {
+                auto rotation = step;
+                Vector3 horizon{};
+                for (auto index = begin; index < end; ++index) {
+                    if (index % reanchorInterval == 0) {
+                        const auto elapsedDays = static_cast<f64>(index) * stepDays;
+                        const auto julianCenturies = ((info.JulianDay - 2451545.0) + elapsedDays) / 36525.0;
+                        const auto siderealTime = Clock::GreenwichMeanSiderealTime(info.JulianDay, elapsedDays);
+                        horizon = ObserveFrameVector(provider(julianCenturies), siderealTime, frame);
+                    } else {
+                        horizon = rotation * horizon;
+                    }
+                    const auto horizontal = HorizonVectorToHorizontal(horizon);
+                    result.Altitudes[index] = horizontal.Altitude;
+                    result.Azimuths[index] = horizontal.Azimuth;
+                }
+            };
+
+            // Chunks are aligned to the anchors, so every chunk starts with a full computation
+            return RunChunked(info.Count, info.Threads, reanchorInterval, kernel);
+        }
+
+        /**
+         * Runs a time series with calendar aware stepping, which is required for months and years
+         * @tparam Provider PositionProvider of the body
+         * @param info ComputeInfo
+         * @param provider Position provider
+         * @return altitudes and azimuths of each step
+         */
+        template<typename Provider>
+        ComputeResult RunCalendar(const ComputeInfo& info, const Provider& provider) noexcept {
+            // Each step is derived from the start, so that the calendar fields never have to be normalized
+            const ObserverFrame frame{ info.Observer };
+            const auto start = Instant::FromDateTime(info.Date);
+            const auto utcOffset = Clock::UtcOffset();
+            return RunChunked(info.Steps, info.Threads, 1, [&](ComputeResult& result, usize begin, usize end) {
+                for (auto step = begin; step < end; ++step) {
+                    auto utc = start;
+                    utc.Add(static_cast<s64>(step * info.StepSize), info.Unit).AddSeconds(utcOffset);
+                    const auto position = provider(utc.JulianCenturies());
+                    const auto siderealTime = Clock::GreenwichMeanSiderealTime(utc.JulianMidnight(), utc.DayFraction());
+                    const auto horizontal = ObserveFrame(position, siderealTime, frame);
+                    result.Altitudes[step] = horizontal.Altitude;
+                    result.Azimuths[step] = horizontal.Azimuth;
+                }
+            });
+        }
+    }// namespace pipeline
+
+    /**
+     * Computes the horizontal positions of a body for each step of the batch
+     * @tparam Body Body kind with a PositionProvider
+     * @param body Body
+     * @param info Batch description, the julian day of the first sample is expected to be in utc
+     * @return altitudes and azimuths of each step
+     */
+    template<typename Body>
+    ComputeResult ComputeGeographicBatch(const Body& body, const BatchInfo& info) noexcept {
+        static_assert(IsBody<Body>::value, "The body kind has no PositionProvider");
+        return pipeline::RunBatch(info, pipeline::MakeProvider(body, pipeline::BatchSpan(info)));
+    }
+
+    /**
+     * Computes the horizontal positions of a body for each step, units with a fixed length are run as a batch
+     * @tparam Body Body kind with a PositionProvider
+     * @param body Body
+     * @param info Time series description, the date is expected to be in local time
+     * @return altitudes and azimuths of each step
+     */
+    template<typename Body>
+    ComputeResult ComputeGeographic(const Body& body, ComputeInfo info) noexcept {
+        static_assert(IsBody<Body>::value, "The body kind has no PositionProvider");
+        if (const auto batch = pipeline::ToBatch(info)) {
+            const auto provider = pipeline::MakeProvider(body, pipeline::BatchSpan(*batch));
+            if constexpr (PositionProvider<Body>::FixedOnSphere) {
+                if (info.SiderealRecurrence) {
+                    const auto interval =
+                            pipeline::RecurrenceInterval(*batch, info.RecurrenceTolerance, info.ReanchorInterval);
+                    return pipeline::RunRecurrence(*batch, provider, interval);
+                }
+            }
+            return pipeline::RunBatch(*batch, provider);
+        }
+        return pipeline::RunCalendar(info, pipeline::MakeProvider(body, pipeline::CalendarSpan(info)));
+    }
+
+    template<typename Body>
+    ComputeResult ComputeGeographic(const std::shared_ptr<Body>& body, ComputeInfo info) noexcept {
+        return ComputeGeographic(*body, std::move(info));
+    }
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_BODYPIPELINE_H
@@ -1,136 +1,37 @@
 #include <fmt/format.h>
+#include <algorithm>
+#include <array>
 #include <charconv>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <nlohmann/json.hpp>
+#include <numeric>
 #include <optional>
+#include <string>
+#include <type_traits>
 
+#include "../clock.hpp"
+#include "../instant.hpp"
 #include "../math.hpp"
 #include "catalog.hpp"
+#include "description.hpp"
+#include "planet-cache.hpp"
+#include "trigram-index.hpp"
+#include "utility/async.hpp"
 #include "utility/conversion.hpp"
 
 namespace ephemeris {
 
     namespace {
 
-        const std::unordered_map<std::string_view, Classification> ClassificationLookUpTable = {
-            { " Gx", Classification::Galaxy },
-            { " OC", Classification::OpenStarCluster },
-            { " Gb", Classification::GlobularStarCluster },
-            { " Nb", Classification::ReflectionNebula },
-            { " Pl", Classification::PlanetaryNebula },
-            { "C+N", Classification::Cluster },
-            { "Ast", Classification::Asterism },
-            { " Kt", Classification::Knot },
-            { "***", Classification::TripleStar },
-            { " D*", Classification::DoubleStar },
-            { "  *", Classification::SingleStar },
-            { "  ?", Classification::Uncertain },
-            { "   ", Classification::Unidentified },
-            { "  -", Classification::Nonexistent },
-            { " PD", Classification::PhotographicPlateDefect }
-        };
-
-        const std::unordered_map<std::string_view, std::string_view> CatalogDescriptionExpansionTable = {
-            { "ab", "about" },
-            { "alm", "almost" },
-            { "am", "among" },
-            { "annul", "annular or ring nebula" },
-            { "att", "attached" },
-            { "b", "brighter" },
-            { "bet", "between" },
-            { "biN", "binuclear" },
-            { "bn", "brightest to n side" },
-            { "bs", "brightest to s side" },
-            { "bp", "brightest to p side" },
-            { "bf", "brightest to f side" },
-            { "B", "bright" },
-            { "c", "considerably" },
-            { "chev", "chevelure" },
-            { "co", "coarse, coarsely" },
-            { "com", "cometic (cometary form)" },
-            { "comp", "companion " },
-            { "conn", "connected" },
-            { "cont", "in contact" },
-            { "C", "compressed" },
-            { "Cl", "cluster" },
-            { "d", "diameter" },
-            { "def", "defined" },
-            { "dif", "diffused" },
-            { "diffic", "difficult" },
-            { "dist", "distance, or distant" },
-            { "D", "f64" },
-            { "e", "extremely, excessively" },
-            { "ee", "most extremely" },
-            { "er", "easily resolvable" },
-            { "exc", "excentric" },
-            { "E", "extended" },
-            { "f", "following (eastward)" },
-            { "F", "faint" },
-            { "g", "gradually" },
-            { "glob.", "globular" },
-            { "gr", "group" },
-            { "i", "irregular" },
-            { "iF", "irregular figure" },
-            { "inv", "involved, involving" },
-            { "l", "little or long" },
-            { "L", "large" },
-            { "m", "much" },
-            { "m", "magnitude" },
-            { "M", "middle, or in the middle" },
-            { "n", "north" },
-            { "neb", "nebula" },
-            { "nebs", "nebulous" },
-            { "neby", "nebulosity" },
-            { "nf", "north following" },
-            { "np", "north preceding" },
-            { "ns", "north-south" },
-            { "nr", "near" },
-            { "N", "nucleus, or to a nucleus" },
-            { "p", "preceding (westward)" },
-            { "pf", "preceding-following" },
-            { "pF", "pretty faint" },
-            { "pB", "pretty bright" },
-            { "pL", "pretty large" },
-            { "pS", "pretty small in angular size" },
-            { "pg", "pretty gradually" },
-            { "pm", "pretty much" },
-            { "ps", "pretty suddenly" },
-            { "plan", "planetary nebula (same as PN)" },
-            { "prob", "probably" },
-            { "P", "poor (sparse) in stars" },
-            { "PN", "planetary nebula" },
-            { "r", "resolvable (mottled, not resolved)" },
-            { "rr", "partially resolved, some stars seen" },
-            { "rrr", "well resolved, clearly consisting of stars" },
-            { "R", "round" },
-            { "RR", "exactly round" },
-            { "Ri", "rich in stars" },
-            { "s", "suddenly (abruptly)" },
-            { "s", "south" },
-            { "sf", "south following" },
-            { "sp", "south preceding" },
-            { "sc", "scattered" },
-            { "sev", "several" },
-            { "st", "stars" },
-            { "9...", "of 9th magnitude and fainter" },
-            { "9..13", "of mag. 9 to 13" },
-            { "stell", "stellar, pointlike" },
-            { "susp", "suspected" },
-            { "S", "small in angular size" },
-            { "S*", "small (faint) star" },
-            { "trap", "trapezium" },
-            { "triangle", "triangle, forms a triangle with" },
-            { "triN", "trinuclear" },
-            { "v", "very" },
-            { "vv", "very" },
-            { "var", "variable" },
-            { "*", "a single star" },
-            { "*10", "a star of 10th magnitude" },
-            { "*7-8", "star of mag. 7 or 8" },
-            { "**", "f64 star (same as D*)" },
-            { "***", "triple star" },
-            { "!", "remarkable" },
-            { "!!", "very much so" },
-            { "!!!", "a magnificent or otherwise interesting object" }
+        /**
+         * @brief Copy of a body together with the storage of its strings, which is independent of the string pool of
+         * the catalog
+         */
+        struct OwnedFixedBody {
+            FixedBody Body;
+            std::string Strings;
         };
 
         /**
@@ -183,49 +84,24 @@ namespace ephemeris {
         }
 
         /**
-         * Expand a ngc2000 catalog description, as of
-         * http://cdsarc.u-strasbg.fr/viz-bin/ReadMe/VII/118?format=html&tex=true
-         * @param abbreviated Description in abbreviated form
-         * @return expanded description
+         * Removes the carriage return of a line, that was split at a line feed only
+         * @param line Line
+         * @return line without carriage return
          */
-        std::string ExpandCatalogDescription(std::string_view abbreviated) {
-            // Here is what we have to do:
-            // First, split by ` `
-            // then try to match each word with the expansion table, if there is no match,
-            // expand each character
-            std::string result;
-            std::vector<std::string_view> words{};
-            std::vector<std::string_view> parts{};
-            utility::Split(parts, abbreviated, ", "sv);
-            for (const auto& part : parts) {
-                utility::Split(words, part, " "sv);
-            }
-
-            for (const auto& word : words) {
-                if (CatalogDescriptionExpansionTable.find(word) != CatalogDescriptionExpansionTable.end()) {
-                    result += CatalogDescriptionExpansionTable.at(word);
-                    result += " ";
-                } else {
-                    for (const auto c : word) {
-                        const auto view = std::string_view{ &c, 1 };
-                        if (CatalogDescriptionExpansionTable.find(view) != CatalogDescriptionExpansionTable.end()) {
-                            result += CatalogDescriptionExpansionTable.at(view);
-                        } else {
-                            result += view;
-                        }
-                        result += " ";
-                    }
-                }
+        std::string_view TrimLineEnding(std::string_view line) noexcept {
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
             }
-            return result;
+            return line;
         }
 
         /**
          * Tries to obtain a FixedBody from an NGC2000.dat entry
          * @param data Entry line
+         * @param strings Pool for the strings of the body
          * @return optional FixedBody
          */
-        std::optional<FixedBody> ParseCatalogEntry(std::string_view data) {
+        std::optional<FixedBody> ParseCatalogEntry(std::string_view data, StringPool& strings) {
             if (data.size() < 46) {
                 return {};
             }
@@ -233,19 +109,20 @@ namespace ephemeris {
             FixedBody body{};
 
             // When there is a leading I in the designation, it is a IC designation, otherwise NGC
-            body.Designation = data.substr(0, 5);
-            if (body.Designation[0] == 'I') {
-                body.Designation = fmt::format("IC{}", LeftTrim(body.Designation.substr(1)));
+            const auto designation = data.substr(0, 5);
+            fmt::memory_buffer buffer{};
+            if (designation[0] == 'I') {
+                fmt::format_to(std::back_inserter(buffer), "IC{}", LeftTrim(designation.substr(1)));
             } else {
-                body.Designation = fmt::format("NGC{}", LeftTrim(body.Designation));
+                fmt::format_to(std::back_inserter(buffer), "NGC{}", LeftTrim(designation));
             }
 
             // Classification is encoded in three characters
             const auto classification = data.substr(6, 3);
             if (classification.find('?') != std::string_view::npos) {
                 body.Type = Classification::Uncertain;
-            } else if (ClassificationLookUpTable.find(classification) != ClassificationLookUpTable.end()) {
-                body.Type = ClassificationLookUpTable.at(classification);
+            } else if (const auto type = ClassificationFromCode(LeftTrim(classification))) {
+                body.Type = *type;
             } else {
                 return {};
             }
@@ -273,10 +150,12 @@ namespace ephemeris {
             // Distance is not an entry in the NGC data set
             body.Position.Radius = 1.0;
 
-            // Constellation
-            body.Const.Abbreviation = data.substr(29, 3);
-            if (ConstellationExpansionTable.find(body.Const.Abbreviation) != ConstellationExpansionTable.end()) {
-                body.Const.Name = ConstellationExpansionTable.at(body.Const.Abbreviation);
+            // Constellation, known ones refer to the static table
+            const auto abbreviation = data.substr(29, 3);
+            if (const auto id = FindConstellation(abbreviation); id != UnknownConstellation) {
+                body.Const = ConstellationTable[id];
+            } else {
+                body.Const.Abbreviation = strings.Store(abbreviation);
             }
 
             // Dimension
@@ -289,9 +168,10 @@ namespace ephemeris {
                 body.Magnitude = *magnitude;
             }
 
-            // Description
-            body.Description = ExpandCatalogDescription(data.substr(46));
+            // Description, which is only expanded when it is accessed
+            body.AbbreviatedDescription = DescriptionInterner::Intern(data.substr(46));
 
+            body.Designation = strings.Store({ buffer.data(), buffer.size() });
             return body;
         }
 
@@ -320,41 +200,484 @@ namespace ephemeris {
             return entry;
         }
 
+        /**
+         * Marks catalog numbers of the dense designation indices, that do not refer to a body
+         */
+        constexpr u32 NoIndex = std::numeric_limits<u32>::max();
+
+        /**
+         * Splits a designation like `NGC224` or `IC434` into its catalog and number
+         * @param designation Designation
+         * @return whether it is an IC designation and its number, or nothing for any other format
+         */
+        std::optional<std::pair<bool, usize>> ParseDesignation(std::string_view designation) noexcept {
+            auto isIndexCatalogue = false;
+            if (designation.substr(0, 3) == "NGC"sv) {
+                designation.remove_prefix(3);
+            } else if (designation.substr(0, 2) == "IC"sv) {
+                designation.remove_prefix(2);
+                isIndexCatalogue = true;
+            } else {
+                return {};
+            }
+
+            usize number{};
+            const auto end = designation.data() + designation.size();
+            const auto conversion = std::from_chars(designation.data(), end, number);
+            if (conversion.ec != std::errc() || conversion.ptr != end) {
+                return {};
+            }
+            return std::make_pair(isIndexCatalogue, number);
+        }
+
+        /**
+         * Identifies a catalog snapshot, the magic number also rejects snapshots of the other byte order
+         */
+        constexpr u32 SnapshotMagic = 0x53435453;
+
+        /**
+         * Version of the snapshot layout, which has to be incremented on any change of the records or the importer
+         */
+        constexpr u32 SnapshotVersion = 4;
+
+        // The records are followed by the designation indices, the attribute column, the sort permutations, the
+        // declination order, the trigrams with their posting lists and finally the string table
+        struct SnapshotHeader {
+            u32 Magic;
+            u32 Version;
+            u64 SourceChecksum;
+            u32 BodyCount;
+            u32 NgcCount;
+            u32 IcCount;
+            u32 TrigramCount;
+            u32 PostingCount;
+            u32 StringTableSize;
+        };
+
+        struct SnapshotString {
+            u32 Offset;
+            u32 Size;
+        };
+
+        struct SnapshotRecord {
+            f64 RightAscension;
+            f64 Declination;
+            f64 Radius;
+            f64 Dimension;
+            f64 Magnitude;
+            u32 Type;
+            u32 Reserved;
+            SnapshotString Name;
+            SnapshotString Designation;
+            SnapshotString Description;
+            SnapshotString ConstellationName;
+            SnapshotString ConstellationAbbreviation;
+        };
+
+        struct SnapshotTrigram {
+            u32 Trigram;
+            u32 PostingCount;
+        };
+
+        static_assert(std::is_trivially_copyable_v<SnapshotHeader> && std::is_trivially_copyable_v<SnapshotRecord> &&
+                      std::is_trivially_copyable_v<SnapshotTrigram> && std::is_trivially_copyable_v<AttributeMask>);
+
+        /**
+         * Appends the bytes of a trivially copyable value to the snapshot
+         * @tparam Type Type of the value
+         * @param snapshot Snapshot
+         * @param value Value
+         */
+        template<typename Type>
+        void AppendSnapshot(std::string& snapshot, const Type& value) noexcept {
+            snapshot.append(reinterpret_cast<const char*>(&value), sizeof(Type));
+        }
+
+        /**
+         * Appends the bytes of an array of trivially copyable values to the snapshot
+         * @tparam Type Type of the values
+         * @param snapshot Snapshot
+         * @param values Values
+         */
+        template<typename Type>
+        void AppendSnapshotArray(std::string& snapshot, const std::vector<Type>& values) noexcept {
+            snapshot.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(Type));
+        }
+
+        /**
+         * Reads a trivially copyable value from the snapshot, the snapshot does not need to be aligned
+         * @tparam Type Type of the value
+         * @param snapshot Snapshot
+         * @param offset Offset of the value, which is advanced past the value
+         * @return value, or nothing if the snapshot is too short
+         */
+        template<typename Type>
+        std::optional<Type> ReadSnapshot(std::string_view snapshot, usize& offset) noexcept {
+            if (offset > snapshot.size() || snapshot.size() - offset < sizeof(Type)) {
+                return {};
+            }
+            Type value{};
+            std::memcpy(&value, snapshot.data() + offset, sizeof(Type));
+            offset += sizeof(Type);
+            return value;
+        }
+
+        /**
+         * Reads an array of trivially copyable values from the snapshot at once
+         * @tparam Type Type of the values
+         * @param snapshot Snapshot
+         * @param offset Offset of the array, which is advanced past the array
+         * @param count Number of values
+         * @param values Values, which are resized to the count
+         * @return false if the snapshot is too short
+         */
+        template<typename Type>
+        bool ReadSnapshotArray(std::string_view snapshot,
+                               usize& offset,
+                               usize count,
+                               std::vector<Type>& values) noexcept {
+            if (offset > snapshot.size() || (snapshot.size() - offset) / sizeof(Type) < count) {
+                return false;
+            }
+            values.resize(count);
+            std::memcpy(values.data(), snapshot.data() + offset, count * sizeof(Type));
+            offset += count * sizeof(Type);
+            return true;
+        }
+
+        /**
+         * Checks if the values are a permutation of the indices 0 to the number of values
+         * @param values Values
+         * @return boolean value that indicates a permutation
+         */
+        bool IsPermutation(const std::vector<u32>& values) noexcept {
+            std::vector<bool> seen(values.size(), false);
+            for (const auto value : values) {
+                if (value >= values.size() || seen[value]) {
+                    return false;
+                }
+                seen[value] = true;
+            }
+            return true;
+        }
+
+        /**
+         * Resolves a string of the string table
+         * @param table String table
+         * @param string Reference into the string table
+         * @return string, or nothing if the reference exceeds the string table or is not null-terminated
+         */
+        std::optional<std::string_view> ResolveSnapshotString(std::string_view table, SnapshotString string) noexcept {
+            if (string.Offset > table.size() || table.size() - string.Offset <= string.Size ||
+                table[string.Offset + string.Size] != '\0') {
+                return {};
+            }
+            return table.substr(string.Offset, string.Size);
+        }
+
+        /**
+         * Smallest number of bytes of a text catalog, for which another thread is employed
+         */
+        constexpr usize MinimumImportChunkSize = 64 * 1024;
+
+        /**
+         * Splits the data into chunks of about equal size, which end at line boundaries
+         * @param data Data
+         * @param count Number of chunks, at least one
+         * @return at most count chunks, that cover the whole data
+         */
+        std::vector<std::string_view> SplitLineChunks(std::string_view data, usize count) noexcept {
+            std::vector<std::string_view> chunks{};
+            const auto targetSize = std::max<usize>(1, (data.size() + count - 1) / count);
+            while (!data.empty()) {
+                auto size = data.size();
+                if (targetSize < size) {
+                    const auto lineEnd = data.find('\n', targetSize - 1);
+                    size = lineEnd == std::string_view::npos ? data.size() : lineEnd + 1;
+                }
+                chunks.emplace_back(data.substr(0, size));
+                data.remove_prefix(size);
+            }
+            return chunks;
+        }
+
         bool ContainsIgnoreCase(std::string_view haystack, std::string_view needle) {
             const auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
-                                        [](char ch1, char ch2) { return std::tolower(ch1) == std::tolower(ch2); });
+                                        [](char ch1, char ch2) {
+                                            return TrigramIndex::Fold(ch1) == TrigramIndex::Fold(ch2);
+                                        });
             return it != haystack.end();
         }
     }// namespace
 
-    bool Catalog::ImportFixed(std::string_view catalog, std::string_view names) noexcept {
-        std::vector<std::string_view> data{};
-        utility::Split(data, catalog, "\n"sv);
-        for (const auto& entry : data) {
-            if (auto body = ParseCatalogEntry(entry)) {
-                bodies.emplace_back(std::make_shared<FixedBody>(std::move(*body)));
+    bool Catalog::ImportFixed(std::string_view catalog, std::string_view names, usize threads) noexcept {
+        // Every chunk is parsed into its own vector, and appending them in chunk order keeps the order of the file
+        const auto chunkCount = std::max<usize>(1, std::min(threads, catalog.size() / MinimumImportChunkSize));
+        const auto chunks = SplitLineChunks(catalog, chunkCount);
+        std::vector<std::vector<FixedBody>> parsed(chunks.size());
+        std::vector<StringPool> pools(chunks.size());
+        utility::ParallelFor(chunks.size(), 1, chunks.size(), [&chunks, &parsed, &pools](usize begin, usize end) {
+            std::vector<std::string_view> data{};
+            for (auto chunk = begin; chunk < end; ++chunk) {
+                data.clear();
+                utility::Split(data, chunks[chunk], "\n"sv);
+                for (const auto& entry : data) {
+                    if (auto body = ParseCatalogEntry(TrimLineEnding(entry), pools[chunk])) {
+                        parsed[chunk].emplace_back(*body);
+                    }
+                }
             }
+        });
+
+        const auto first = bodies.size();
+        for (usize chunk = 0; chunk < chunks.size(); ++chunk) {
+            bodies.insert(bodies.end(), parsed[chunk].begin(), parsed[chunk].end());
+            strings.Adopt(std::move(pools[chunk]));
         }
 
+        // Sort the imported bodies by dimension, bodies of equal dimension stay in the order of the file. The indices
+        // refer to positions and are therefore built afterwards
+        std::stable_sort(bodies.begin() + static_cast<std::ptrdiff_t>(first), bodies.end(),
+                         [](const FixedBody& a, const FixedBody& b) { return a.Dimension > b.Dimension; });
+        IndexFixed();
+
+        // Names are bound through the designation index, so binding is linear in the number of names
         std::vector<std::string_view> nameEntries{};
         utility::Split(nameEntries, names, "\n"sv);
         for (const auto& entry : nameEntries) {
-            if (auto name = ParseCommonNameEntry(entry)) {
-                if (const auto body = FindFixedByDesignation(name->Designation)) {
-                    body->Name = std::move(name->Name);
+            if (auto name = ParseCommonNameEntry(TrimLineEnding(entry))) {
+                if (const auto handle = FindFixedHandleByDesignation(name->Designation)) {
+                    bodies[handle->Index].Name = strings.Store(name->Name);
                 }
             }
         }
+        IndexNames();
 
-        // Sort them by dimension
-        std::sort(bodies.begin(), bodies.end(),
-                  [](const std::shared_ptr<FixedBody>& a, const std::shared_ptr<FixedBody>& b) {
-                      return a->Dimension > b->Dimension;
-                  });
+        // The columns follow the order of the bodies, so the kernel results can be indexed like the bodies
+        columns.Assign(bodies);
+        declinations.Build(bodies);
 
         return true;
     }
 
+    bool Catalog::ImportSnapshot(std::string_view snapshot, u64 sourceChecksum) noexcept {
+        usize offset = 0;
+        const auto header = ReadSnapshot<SnapshotHeader>(snapshot, offset);
+        if (!header || header->Magic != SnapshotMagic || header->Version != SnapshotVersion ||
+            header->SourceChecksum != sourceChecksum) {
+            return false;
+        }
+
+        // The string table is located behind the records and the indices
+        const usize bodyCount = header->BodyCount;
+        const auto tableOffset = sizeof(SnapshotHeader) + bodyCount * sizeof(SnapshotRecord) +
+                                 (static_cast<usize>(header->NgcCount) + header->IcCount) * sizeof(u32) +
+                                 bodyCount * sizeof(AttributeMask) + (SortKeyCount + 1) * bodyCount * sizeof(u32) +
+                                 header->TrigramCount * sizeof(SnapshotTrigram) + header->PostingCount * sizeof(u32);
+        if (tableOffset > snapshot.size() || snapshot.size() - tableOffset != header->StringTableSize) {
+            return false;
+        }
+        const auto table = snapshot.substr(tableOffset);
+
+        std::vector<FixedBody> snapshotBodies{};
+        snapshotBodies.reserve(header->BodyCount);
+        for (u32 index = 0; index < header->BodyCount; ++index) {
+            const auto record = ReadSnapshot<SnapshotRecord>(snapshot, offset);
+            if (!record || record->Type > static_cast<u32>(Classification::Planet)) {
+                return false;
+            }
+
+            const auto name = ResolveSnapshotString(table, record->Name);
+            const auto designation = ResolveSnapshotString(table, record->Designation);
+            const auto description = ResolveSnapshotString(table, record->Description);
+            const auto constellationName = ResolveSnapshotString(table, record->ConstellationName);
+            const auto constellationAbbreviation = ResolveSnapshotString(table, record->ConstellationAbbreviation);
+            if (!name || !designation || !description || !constellationName || !constellationAbbreviation) {
+                return false;
+            }
+
+            // The strings are not copied, the views refer to the string table of the snapshot
+            FixedBody body{};
+            body.Name = *name;
+            body.Designation = *designation;
+            body.AbbreviatedDescription = DescriptionInterner::Intern(*description);
+            body.Const.Name = *constellationName;
+            body.Const.Abbreviation = *constellationAbbreviation;
+            body.Dimension = record->Dimension;
+            body.Magnitude = record->Magnitude;
+            body.Type = static_cast<Classification>(record->Type);
+            body.Position = { record->Radius, record->RightAscension, record->Declination };
+            snapshotBodies.emplace_back(body);
+        }
+
+        // The designation indices are taken as they are, after checking that they refer to existing bodies
+        const auto readIndex = [&](std::vector<u32>& dense, u32 count) {
+            dense.resize(count);
+            for (auto& position : dense) {
+                const auto value = ReadSnapshot<u32>(snapshot, offset);
+                if (!value || (*value != NoIndex && *value >= header->BodyCount)) {
+                    return false;
+                }
+                position = *value;
+            }
+            return true;
+        };
+        std::vector<u32> snapshotNgcIndex{};
+        std::vector<u32> snapshotIcIndex{};
+        if (!readIndex(snapshotNgcIndex, header->NgcCount) || !readIndex(snapshotIcIndex, header->IcCount)) {
+            return false;
+        }
+
+        // The attribute column, the permutations and the posting lists are only checked to refer to existing bodies,
+        // not recomputed
+        std::vector<AttributeMask> snapshotAttributes{};
+        if (!ReadSnapshotArray(snapshot, offset, bodyCount, snapshotAttributes)) {
+            return false;
+        }
+        std::array<std::vector<u32>, SortKeyCount> snapshotOrders{};
+        for (auto& order : snapshotOrders) {
+            if (!ReadSnapshotArray(snapshot, offset, bodyCount, order) || !IsPermutation(order)) {
+                return false;
+            }
+        }
+        std::vector<u32> declinationOrder{};
+        if (!ReadSnapshotArray(snapshot, offset, bodyCount, declinationOrder) || !IsPermutation(declinationOrder)) {
+            return false;
+        }
+
+        std::vector<SnapshotTrigram> trigramEntries{};
+        std::vector<u32> postings{};
+        if (!ReadSnapshotArray(snapshot, offset, header->TrigramCount, trigramEntries) ||
+            !ReadSnapshotArray(snapshot, offset, header->PostingCount, postings)) {
+            return false;
+        }
+        std::unordered_map<u32, std::vector<u32>> postingLists{};
+        postingLists.reserve(trigramEntries.size());
+        auto posting = postings.begin();
+        for (const auto& entry : trigramEntries) {
+            if (static_cast<usize>(postings.end() - posting) < entry.PostingCount) {
+                return false;
+            }
+            const auto end = posting + entry.PostingCount;
+            const auto ascending = std::adjacent_find(posting, end, std::greater_equal<>{}) == end;
+            if (!ascending || (posting != end && *(end - 1) >= bodyCount) ||
+                !postingLists.try_emplace(entry.Trigram, posting, end).second) {
+                return false;
+            }
+            posting = end;
+        }
+        if (posting != postings.end()) {
+            return false;
+        }
+
+        bodies = std::move(snapshotBodies);
+        strings = StringPool{};
+        ngcIndex = std::move(snapshotNgcIndex);
+        icIndex = std::move(snapshotIcIndex);
+        attributes = std::move(snapshotAttributes);
+        orders = std::move(snapshotOrders);
+        IndexRanks();
+        trigrams.Assign(std::move(postingLists));
+        IndexNameLookup();
+        columns.Assign(bodies);
+        declinations.Assign(bodies, std::move(declinationOrder));
+        return true;
+    }
+
+    std::string Catalog::ExportSnapshot(u64 sourceChecksum) const noexcept {
+        // Equal strings, like constellations and common descriptions, share one null-terminated entry of the string
+        // table
+        std::string table{};
+        std::unordered_map<std::string_view, SnapshotString> strings{};
+        const auto intern = [&](std::string_view string) {
+            const auto [it, inserted] = strings.try_emplace(string, SnapshotString{});
+            if (inserted) {
+                it->second = { static_cast<u32>(table.size()), static_cast<u32>(string.size()) };
+                table += string;
+                table += '\0';
+            }
+            return it->second;
+        };
+
+        std::vector<SnapshotRecord> records{};
+        records.reserve(bodies.size());
+        for (const auto& body : bodies) {
+            SnapshotRecord record{};
+            record.RightAscension = body.Position.RightAscension;
+            record.Declination = body.Position.Declination;
+            record.Radius = body.Position.Radius;
+            record.Dimension = body.Dimension;
+            record.Magnitude = body.Magnitude;
+            record.Type = static_cast<u32>(body.Type);
+            record.Name = intern(body.Name);
+            record.Designation = intern(body.Designation);
+            record.Description = intern(body.AbbreviatedDescription);
+            record.ConstellationName = intern(body.Const.Name);
+            record.ConstellationAbbreviation = intern(body.Const.Abbreviation);
+            records.emplace_back(record);
+        }
+
+        // The posting lists are stored by ascending trigram, so equal catalogs produce equal snapshots
+        std::vector<SnapshotTrigram> trigramEntries{};
+        const auto& postingLists = trigrams.GetPostings();
+        trigramEntries.reserve(postingLists.size());
+        for (const auto& [trigram, list] : postingLists) {
+            trigramEntries.push_back({ trigram, static_cast<u32>(list.size()) });
+        }
+        std::sort(trigramEntries.begin(), trigramEntries.end(),
+                  [](const SnapshotTrigram& a, const SnapshotTrigram& b) { return a.Trigram < b.Trigram; });
+        std::vector<u32> postings{};
+        for (const auto& entry : trigramEntries) {
+            const auto& list = postingLists.at(entry.Trigram);
+            postings.insert(postings.end(), list.begin(), list.end());
+        }
+
+        const SnapshotHeader header{ SnapshotMagic,
+                                     SnapshotVersion,
+                                     sourceChecksum,
+                                     static_cast<u32>(records.size()),
+                                     static_cast<u32>(ngcIndex.size()),
+                                     static_cast<u32>(icIndex.size()),
+                                     static_cast<u32>(trigramEntries.size()),
+                                     static_cast<u32>(postings.size()),
+                                     static_cast<u32>(table.size()) };
+
+        std::string snapshot{};
+        snapshot.reserve(sizeof(header) + records.size() * sizeof(SnapshotRecord) +
+                         (ngcIndex.size() + icIndex.size()) * sizeof(u32) + attributes.size() * sizeof(AttributeMask) +
+                         (SortKeyCount + 1) * bodies.size() * sizeof(u32) +
+                         trigramEntries.size() * sizeof(SnapshotTrigram) + postings.size() * sizeof(u32) +
+                         table.size());
+        AppendSnapshot(snapshot, header);
+        AppendSnapshotArray(snapshot, records);
+        AppendSnapshotArray(snapshot, ngcIndex);
+        AppendSnapshotArray(snapshot, icIndex);
+        AppendSnapshotArray(snapshot, attributes);
+        for (const auto& order : orders) {
+            AppendSnapshotArray(snapshot, order);
+        }
+        AppendSnapshotArray(snapshot, declinations.GetOrder());
+        AppendSnapshotArray(snapshot, trigramEntries);
+        AppendSnapshotArray(snapshot, postings);
+        snapshot += table;
+        return snapshot;
+    }
+
+    u64 Catalog::SourceChecksum(std::string_view catalog, std::string_view names) noexcept {
+        // 64 bit FNV-1a over both sources, with the size of the catalog separating them
+        u64 hash = 0xcbf29ce484222325;
+        const auto mix = [&hash](std::string_view data) {
+            for (const auto c : data) {
+                hash = (hash ^ static_cast<u8>(c)) * 0x100000001b3;
+            }
+        };
+        const auto catalogSize = static_cast<u64>(catalog.size());
+        mix(catalog);
+        mix(std::string_view{ reinterpret_cast<const char*>(&catalogSize), sizeof(catalogSize) });
+        mix(names);
+        return hash;
+    }
+
     bool Catalog::ImportPlanets(std::string_view planetaryData) noexcept {
         const auto objects = nlohmann::json::parse(planetaryData, nullptr, false, true);
         if (!objects.contains("Data") || !objects["Data"].is_array()) {
@@ -385,90 +708,335 @@ namespace ephemeris {
             Planet planet{ element["Name"].get<std::string>(), elements, rate };
             planets.emplace_back(std::make_shared<Planet>(planet));
         }
+
+        IndexPlanets();
+
+        // Cached intervals are identified by the name of the planet, which might now refer to different elements
+        PlanetCache::Clear();
         return true;
     }
 
-    std::shared_ptr<FixedBody> Catalog::FindFixedByDesignation(std::string_view designation) const noexcept {
-        for (const auto& fixed : bodies) {
-            if (fixed->Designation == designation) {
-                return fixed;
+    void Catalog::IndexFixed() noexcept {
+        ngcIndex.clear();
+        icIndex.clear();
+        IndexAttributes();
+
+        for (usize index = 0; index < bodies.size(); ++index) {
+            // The first body in catalog order wins, which matches the former linear search
+            if (const auto designation = ParseDesignation(bodies[index].Designation)) {
+                const auto [isIndexCatalogue, number] = *designation;
+                auto& dense = isIndexCatalogue ? icIndex : ngcIndex;
+                if (number >= dense.size()) {
+                    dense.resize(number + 1, NoIndex);
+                }
+                if (dense[number] == NoIndex) {
+                    dense[number] = static_cast<u32>(index);
+                }
+            }
+        }
+    }
+
+    void Catalog::IndexAttributes() noexcept {
+        attributes.resize(bodies.size());
+        for (usize index = 0; index < bodies.size(); ++index) {
+            const auto& body = bodies[index];
+            attributes[index] = AttributeMask::OfBody(body.Type, FindConstellation(body.Const.Abbreviation));
+        }
+    }
+
+    void Catalog::IndexNames() noexcept {
+        trigrams.Build(bodies);
+        IndexNameLookup();
+        IndexOrders();
+    }
+
+    void Catalog::IndexNameLookup() noexcept {
+        filterCache.Clear();
+        nameIndex.clear();
+        nameIndex.reserve(bodies.size());
+        for (usize index = 0; index < bodies.size(); ++index) {
+            if (!bodies[index].Name.empty()) {
+                nameIndex.try_emplace(bodies[index].Name, static_cast<u32>(index));
+            }
+        }
+    }
+
+    void Catalog::IndexOrders() noexcept {
+        const auto sort = [this](SortKey key, auto before) {
+            auto& order = orders[static_cast<usize>(key)];
+            order.resize(bodies.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                             [this, &before](u32 a, u32 b) { return before(bodies[a], bodies[b]); });
+        };
+
+        sort(SortKey::Dimension, [](const FixedBody& a, const FixedBody& b) { return a.Dimension > b.Dimension; });
+
+        // A magnitude of zero does not occur in the catalog and marks a missing magnitude
+        sort(SortKey::Magnitude, [](const FixedBody& a, const FixedBody& b) {
+            const auto knownA = a.Magnitude != 0.0;
+            const auto knownB = b.Magnitude != 0.0;
+            if (knownA != knownB) {
+                return knownA;
+            }
+            return a.Magnitude < b.Magnitude;
+        });
+
+        sort(SortKey::Designation, [](const FixedBody& a, const FixedBody& b) {
+            const auto designationA = ParseDesignation(a.Designation);
+            const auto designationB = ParseDesignation(b.Designation);
+            if (designationA.has_value() != designationB.has_value()) {
+                return designationA.has_value();
+            }
+            if (designationA && *designationA != *designationB) {
+                return *designationA < *designationB;
+            }
+            return a.Designation < b.Designation;
+        });
+
+        sort(SortKey::Name, [](const FixedBody& a, const FixedBody& b) {
+            if (a.Name.empty() != b.Name.empty()) {
+                return b.Name.empty();
+            }
+            return std::lexicographical_compare(a.Name.begin(), a.Name.end(), b.Name.begin(), b.Name.end(),
+                                                [](char left, char right) {
+                                                    return TrigramIndex::Fold(left) < TrigramIndex::Fold(right);
+                                                });
+        });
+        IndexRanks();
+    }
+
+    void Catalog::IndexRanks() noexcept {
+        for (usize key = 0; key < SortKeyCount; ++key) {
+            const auto& order = orders[key];
+            auto& rank = ranks[key];
+            rank.resize(order.size());
+            for (usize position = 0; position < order.size(); ++position) {
+                rank[order[position]] = static_cast<u32>(position);
             }
         }
+    }
+
+    void Catalog::IndexPlanets() noexcept {
+        planetIndex.clear();
+        for (usize index = 0; index < planets.size(); ++index) {
+            planetIndex.try_emplace(planets[index]->Name, static_cast<u32>(index));
+        }
+    }
+
+    std::optional<FixedHandle> Catalog::FindFixedHandleByDesignation(std::string_view designation) const noexcept {
+        const auto parsed = ParseDesignation(designation);
+        if (!parsed) {
+            return {};
+        }
+
+        const auto [isIndexCatalogue, number] = *parsed;
+        const auto& dense = isIndexCatalogue ? icIndex : ngcIndex;
+        if (number >= dense.size() || dense[number] == NoIndex) {
+            return {};
+        }
+
+        // The number alone does not reject a designation with leading zeros
+        if (bodies[dense[number]].Designation != designation) {
+            return {};
+        }
+        return FixedHandle{ dense[number] };
+    }
+
+    std::optional<FixedHandle> Catalog::FindFixedHandleByName(std::string_view name) const noexcept {
+        if (const auto it = nameIndex.find(name); it != nameIndex.end()) {
+            return FixedHandle{ it->second };
+        }
+        return {};
+    }
+
+    std::shared_ptr<FixedBody> Catalog::FindFixedByDesignation(std::string_view designation) const noexcept {
+        if (const auto handle = FindFixedHandleByDesignation(designation)) {
+            return ShareFixed(*handle);
+        }
         return nullptr;
     }
 
     std::shared_ptr<FixedBody> Catalog::FindFixedByName(std::string_view name) const noexcept {
-        for (const auto& fixed : bodies) {
-            if (fixed->Name == name) {
-                return fixed;
-            }
+        if (const auto handle = FindFixedHandleByName(name)) {
+            return ShareFixed(*handle);
         }
         return nullptr;
     }
 
     std::shared_ptr<Planet> Catalog::FindPlanetByName(std::string_view name) const noexcept {
-        for (const auto& planet : planets) {
-            if (planet->Name == name) {
-                return planet;
-            }
+        if (const auto it = planetIndex.find(name); it != planetIndex.end()) {
+            return planets[it->second];
         }
         return nullptr;
     }
 
-    std::vector<std::shared_ptr<FixedBody>> Catalog::FilterFixed(const Filter& filter) const noexcept {
-        const auto ignoreIdentifier = filter.Identifier.empty();
-        const auto ignoreClassification = filter.Classifications.empty();
-        const auto ignoreConstellation = filter.Constellations.empty();
-        const auto ignoreVisibility = !filter.Visibility.has_value();
+    std::vector<u32> Catalog::MatchFixed(const FilterCache::Key& key, const std::vector<u32>* within) const noexcept {
+        // Classification and constellation are tested at once against the attribute column
+        const auto accepted = AttributeMask::Accepting(key.Classifications, key.Constellations);
+        const auto satisfied = [this, &accepted](u32 index) { return attributes[index].AcceptedBy(accepted); };
+        const auto identified = [this, &key](u32 index) {
+            return std::any_of(key.Terms->begin(), key.Terms->end(), [this, index](const std::string& term) {
+                return ContainsIgnoreCase(bodies[index].Name, term) ||
+                       ContainsIgnoreCase(bodies[index].Designation, term);
+            });
+        };
+
+        std::vector<u32> result{};
 
-        if (ignoreIdentifier && ignoreClassification && ignoreConstellation && ignoreVisibility) {
-            return bodies;
+        // A narrowed filter verifies the previous result directly, which is usually much smaller than the catalog
+        if (within != nullptr) {
+            for (const auto index : *within) {
+                if (satisfied(index) && (!key.Terms.has_value() || identified(index))) {
+                    result.emplace_back(index);
+                }
+            }
+            return result;
         }
 
-        std::vector<std::shared_ptr<FixedBody>> result{};
-        std::vector<std::string_view> filters{};
+        // Only the candidates of the trigram index are verified, terms shorter than a trigram are verified against
+        // every body
+        std::vector<u8> identifiedMask{};
+        if (key.Terms.has_value()) {
+            identifiedMask.resize(bodies.size(), 0);
+            const auto verify = [this, &identifiedMask](u32 index, std::string_view term) {
+                if (!identifiedMask[index] && (ContainsIgnoreCase(bodies[index].Name, term) ||
+                                               ContainsIgnoreCase(bodies[index].Designation, term))) {
+                    identifiedMask[index] = 1;
+                }
+            };
 
-        if (!ignoreIdentifier) {
-            utility::Split(filters, filter.Identifier, ";"sv);
+            std::vector<u32> candidates{};
+            for (const auto& term : *key.Terms) {
+                if (trigrams.Candidates(term, candidates)) {
+                    for (const auto index : candidates) {
+                        verify(index, term);
+                    }
+                } else {
+                    for (u32 index = 0; index < bodies.size(); ++index) {
+                        verify(index, term);
+                    }
+                }
+            }
         }
 
-        for (const auto& body : bodies) {
-            const auto classificationSatisfied =
-                    ignoreClassification || filter.Classifications.find(body->Type) != filter.Classifications.end();
-            const auto identifierSatisfied = std::invoke([&] {
-                if (!ignoreIdentifier) {
-                    for (const auto& currentFilter : filters) {
-                        if (ContainsIgnoreCase(body->Name, currentFilter)) {
-                            return true;
-                        }
-                        if (ContainsIgnoreCase(body->Designation, currentFilter)) {
-                            return true;
-                        }
-                    }
-                    return false;
+        for (u32 index = 0; index < bodies.size(); ++index) {
+            if (satisfied(index) && (!key.Terms.has_value() || identifiedMask[index] != 0)) {
+                result.emplace_back(index);
+            }
+        }
+        return result;
+    }
+
+    std::shared_ptr<const DeclinationIndex::Bands> Catalog::ClassifyFixed(
+            const VisibilityFilter& visibility) const noexcept {
+        const auto threshold = visibility.AltitudeThreshold;
+        if (visibility.Horizon == nullptr) {
+            return declinations.Classify(visibility.Observer.Latitude, threshold, threshold);
+        }
+        return declinations.Classify(visibility.Observer.Latitude, std::max(threshold, visibility.Horizon->Lowest()),
+                                     std::max(threshold, visibility.Horizon->Highest()));
+    }
+
+    std::vector<FixedHandle> Catalog::FilterFixed(const Filter& filter) const noexcept {
+        const FilterCache::Key key(filter.Identifier, filter.Classifications, filter.Constellations);
+
+        std::vector<u32> matches{};
+        if (key.Empty()) {
+            matches.resize(bodies.size());
+            std::iota(matches.begin(), matches.end(), 0);
+        } else {
+            std::vector<u32> cached{};
+            switch (filterCache.Lookup(key, cached)) {
+                case FilterCache::Match::Exact:
+                    matches = std::move(cached);
+                    break;
+                case FilterCache::Match::Narrowed:
+                    matches = MatchFixed(key, &cached);
+                    filterCache.Insert(key, matches);
+                    break;
+                case FilterCache::Match::None:
+                    matches = MatchFixed(key, nullptr);
+                    filterCache.Insert(key, matches);
+                    break;
+            }
+        }
+
+        // Visibility depends on the current time, so it is evaluated on every call, with the same instant for every
+        // body. The declination already decides it for bodies, that never rise above or never set below the threshold
+        std::vector<FixedHandle> result{};
+        result.reserve(matches.size());
+        if (filter.Visibility.has_value()) {
+            const auto bands = ClassifyFixed(*filter.Visibility);
+            std::vector<u32> crossing{};
+            for (const auto index : matches) {
+                if (bands->Of[index] == DeclinationIndex::Band::Sometimes) {
+                    crossing.emplace_back(index);
                 }
-                return true;
-            });
-            const auto constellationSatisfied =
-                    ignoreConstellation ||
-                    filter.Constellations.find(body->Const.Abbreviation) != filter.Constellations.end();
-
-            const auto visibilitySatisfied = std::invoke([&] {
-                if (!ignoreVisibility) {
-                    const auto now = DateTime::Now();
-                    const auto preview =
-                            ObserveGeographic(body->GetEquatorialPosition(now), filter.Visibility->Observer, now);
-                    return preview.Altitude >= filter.Visibility->AltitudeThreshold;
+            }
+
+            std::vector<u8> visible{};
+            if (!crossing.empty()) {
+                const auto utc = Clock::ToUtc(Instant::FromDateTime(Clock::Now()));
+                const auto matrix = BodyColumns::HorizontalMatrix(utc, filter.Visibility->Observer);
+                const auto* horizon = filter.Visibility->Horizon.get();
+                if (crossing.size() == bodies.size()) {
+                    columns.Visible(matrix, filter.Visibility->AltitudeThreshold, visible, horizon);
+                } else {
+                    columns.Visible(matrix, filter.Visibility->AltitudeThreshold, crossing, visible, horizon);
                 }
-                return true;
-            });
+            }
+
+            usize evaluated = 0;
+            for (const auto index : matches) {
+                switch (bands->Of[index]) {
+                    case DeclinationIndex::Band::Never:
+                        break;
+                    case DeclinationIndex::Band::Sometimes:
+                        if (visible[evaluated++] != 0) {
+                            result.emplace_back(FixedHandle{ index });
+                        }
+                        break;
+                    case DeclinationIndex::Band::Always:
+                        result.emplace_back(FixedHandle{ index });
+                        break;
+                }
+            }
+        } else {
+            for (const auto index : matches) {
+                result.emplace_back(FixedHandle{ index });
+            }
+        }
 
+        return result;
+    }
 
-            if (classificationSatisfied && identifierSatisfied && constellationSatisfied && visibilitySatisfied) {
-                result.emplace_back(body);
+    std::vector<FixedHandle> Catalog::QueryFixed(const Query& query,
+                                                 const Instant& utc,
+                                                 const Geographic& observer,
+                                                 const std::vector<FixedHandle>* within,
+                                                 std::vector<Query::Step>* profile) const noexcept {
+        std::vector<u32> selection{};
+        if (within != nullptr) {
+            selection.reserve(within->size());
+            for (const auto handle : *within) {
+                selection.emplace_back(handle.Index);
             }
+        } else {
+            selection.resize(bodies.size());
+            std::iota(selection.begin(), selection.end(), 0);
         }
 
+        // The horizon matrix is shared by all ephemeris predicates of the query
+        const auto horizon =
+                query.DependsOnEphemeris() ? BodyColumns::HorizontalMatrix(utc, observer) : Matrix3x3{ 1.0 };
+        const auto matches = query.Evaluate({ bodies, attributes, columns }, horizon, std::move(selection), profile);
+
+        std::vector<FixedHandle> result{};
+        result.reserve(matches.size());
+        for (const auto index : matches) {
+            result.emplace_back(FixedHandle{ index });
+        }
         return result;
     }
 
@@ -493,44 +1061,112 @@ namespace ephemeris {
         return result;
     }
 
+    ComputeResult Catalog::ObserveFixed(const Instant& utc, const Geographic& observer) const noexcept {
+        ComputeResult result{};
+        result.Altitudes.resize(columns.Size());
+        result.Azimuths.resize(columns.Size());
+        columns.Observe(BodyColumns::HorizontalMatrix(utc, observer), result.Altitudes.data(), result.Azimuths.data());
+        return result;
+    }
+
     std::vector<std::shared_ptr<Planet>>& Catalog::GetPlanets() noexcept {
         return planets;
     }
 
-    std::vector<std::shared_ptr<FixedBody>>& Catalog::GetBodies() noexcept {
+    const FixedBody& Catalog::GetFixed(FixedHandle handle) const noexcept {
+        return bodies[handle.Index];
+    }
+
+    std::shared_ptr<FixedBody> Catalog::ShareFixed(FixedHandle handle) const noexcept {
+        // The string pool is replaced by a snapshot import, so the strings are copied next to the body. The storage is
+        // complete before the views are taken, as appending may reallocate
+        auto owned = std::make_shared<OwnedFixedBody>();
+        owned->Body = bodies[handle.Index];
+        auto& body = owned->Body;
+        const std::array<std::string_view*, 4> views{ &body.Name, &body.Designation, &body.Const.Name,
+                                                      &body.Const.Abbreviation };
+        std::array<usize, 4> offsets{};
+        for (usize view = 0; view < views.size(); ++view) {
+            offsets[view] = owned->Strings.size();
+            owned->Strings.append(*views[view]).push_back('\0');
+        }
+        for (usize view = 0; view < views.size(); ++view) {
+            *views[view] = std::string_view{ owned->Strings.data() + offsets[view], views[view]->size() };
+        }
+        return std::shared_ptr<FixedBody>(owned, &owned->Body);
+    }
+
+    const std::vector<FixedBody>& Catalog::GetBodies() const noexcept {
         return bodies;
     }
 
-    ComputeInfo::ComputeInfo() noexcept
-        : Date(DateTime::Now()),
-          Observer({ 0.0, 0.0 }),
-          Steps(1440),
-          StepSize(1),
-          Unit(DateTime::Unit::Minutes) { }
+    const std::vector<u32>& Catalog::GetOrder(SortKey key) const noexcept {
+        return orders[static_cast<usize>(key)];
+    }
 
-    ComputeResult ComputeGeographic(const std::shared_ptr<Planet>& planet, ComputeInfo info) noexcept {
-        ComputeResult result{};
-        result.Altitudes.resize(info.Steps);
-        result.Azimuths.resize(info.Steps);
-        for (std::size_t step = 0; step < info.Steps; ++step) {
-            const auto position = ObserveGeographic(planet->GetEquatorialPosition(info.Date), info.Observer, info.Date);
-            result.Altitudes[step] = position.Altitude;
-            result.Azimuths[step] = position.Azimuth;
-            info.Date.Add(static_cast<std::int64_t>(info.StepSize), info.Unit);
+    void Catalog::SortFixed(std::vector<FixedHandle>& handles, SortKey key) const noexcept {
+        const auto& order = orders[static_cast<usize>(key)];
+        const auto& rank = ranks[static_cast<usize>(key)];
+
+        // Small selections are sorted by rank, large ones are collected by walking the permutation in linear time
+        if (handles.size() < bodies.size() / 16) {
+            std::sort(handles.begin(), handles.end(),
+                      [&rank](FixedHandle a, FixedHandle b) { return rank[a.Index] < rank[b.Index]; });
+            return;
+        }
+
+        std::vector<u8> selected(bodies.size(), 0);
+        for (const auto handle : handles) {
+            selected[handle.Index] = 1;
+        }
+        handles.clear();
+        for (const auto index : order) {
+            if (selected[index] != 0) {
+                handles.emplace_back(FixedHandle{ index });
+            }
         }
-        return result;
     }
 
-    ComputeResult ComputeGeographic(const std::shared_ptr<FixedBody>& body, ComputeInfo info) noexcept {
-        ComputeResult result{};
-        result.Altitudes.resize(info.Steps);
-        result.Azimuths.resize(info.Steps);
-        for (std::size_t step = 0; step < info.Steps; ++step) {
-            const auto position = ObserveGeographic(body->GetEquatorialPosition(info.Date), info.Observer, info.Date);
-            result.Altitudes[step] = position.Altitude;
-            result.Azimuths[step] = position.Azimuth;
-            info.Date.Add(static_cast<std::int64_t>(info.StepSize), info.Unit);
+    void Catalog::SortFixedByAltitude(std::vector<FixedHandle>& handles,
+                                      const Instant& utc,
+                                      const Geographic& observer) const noexcept {
+        std::vector<u32> indices{};
+        indices.reserve(handles.size());
+        for (const auto handle : handles) {
+            indices.emplace_back(handle.Index);
+        }
+        std::vector<f64> sines{};
+        columns.SineAltitudes(BodyColumns::HorizontalMatrix(utc, observer), indices, sines);
+
+        std::vector<std::pair<f64, u32>> keyed(handles.size());
+        for (usize selected = 0; selected < handles.size(); ++selected) {
+            keyed[selected] = { sines[selected], indices[selected] };
+        }
+        const auto higher = [](const std::pair<f64, u32>& a, const std::pair<f64, u32>& b) {
+            return a.first > b.first;
+        };
+
+        // Insertion sort is linear in the number of displacements, which are few for the order of the last call.
+        // Once the budget is exceeded, the order was not almost sorted and the rest is sorted from scratch
+        const auto budget = handles.size() * 8;
+        usize moves = 0;
+        for (usize current = 1; current < keyed.size(); ++current) {
+            auto value = keyed[current];
+            auto position = current;
+            for (; position > 0 && higher(value, keyed[position - 1]); --position) {
+                keyed[position] = keyed[position - 1];
+            }
+            keyed[position] = value;
+
+            moves += current - position;
+            if (moves > budget) {
+                std::stable_sort(keyed.begin(), keyed.end(), higher);
+                break;
+            }
+        }
+
+        for (usize selected = 0; selected < keyed.size(); ++selected) {
+            handles[selected] = FixedHandle{ keyed[selected].second };
         }
-        return result;
     }
 }// namespace ephemeris
\ No newline at end of file
@@ -4,31 +4,165 @@
 #include <cfloat>
 #include <filesystem>
 #include <optional>
-#include <unordered_set>
+#include <unordered_map>
 #include <vector>
 
 #include "../math.hpp"
+#include "attribute-mask.hpp"
+#include "body-columns.hpp"
+#include "body-pipeline.hpp"
 #include "coordinates.hpp"
+#include "declination-index.hpp"
+#include "filter-cache.hpp"
 #include "fixed-body.hpp"
+#include "horizon-profile.hpp"
 #include "planet.hpp"
+#include "query.hpp"
+#include "string-pool.hpp"
+#include "trigram-index.hpp"
 
 namespace ephemeris {
 
+    /**
+     * Handle of a fixed body in a catalog, which stays valid when further bodies are imported
+     */
+    struct FixedHandle {
+        u32 Index;
+    };
+
+    inline bool operator==(FixedHandle a, FixedHandle b) noexcept {
+        return a.Index == b.Index;
+    }
+
+    inline bool operator!=(FixedHandle a, FixedHandle b) noexcept {
+        return a.Index != b.Index;
+    }
+
+    /**
+     * @brief Orders, for which the catalog keeps a precomputed permutation
+     */
+    enum class SortKey {
+        /** Largest dimension first */
+        Dimension,
+        /** Brightest first, bodies without a magnitude last */
+        Magnitude,
+        /** NGC before IC, each by ascending number */
+        Designation,
+        /** Alphabetically ignoring case, unnamed bodies last */
+        Name
+    };
+
+    /**
+     * Number of sort keys
+     */
+    constexpr usize SortKeyCount = static_cast<usize>(SortKey::Name) + 1;
+
     class Catalog {
     private:
         std::vector<std::shared_ptr<Planet>> planets{};
-        std::vector<std::shared_ptr<FixedBody>> bodies{};
+        std::vector<FixedBody> bodies{};
+        StringPool strings{};
+        BodyColumns columns{};
+        DeclinationIndex declinations{};
+        std::vector<AttributeMask> attributes{};
+
+        // Permutation of the body indices for each sort key, and the position of each body in that permutation
+        std::array<std::vector<u32>, SortKeyCount> orders{};
+        std::array<std::vector<u32>, SortKeyCount> ranks{};
+
+        // Lookup indices into planets and bodies, the designation indices are dense and keyed by the catalog number
+        std::vector<u32> ngcIndex{};
+        std::vector<u32> icIndex{};
+        std::unordered_map<std::string_view, u32> nameIndex{};
+        std::unordered_map<std::string_view, u32> planetIndex{};
+        TrigramIndex trigrams{};
+        mutable FilterCache filterCache{};
+
+        /**
+         * Rebuilds the designation indices and the attribute column from the current order of the bodies, the name
+         * indices are left to IndexNames, as names are bound through the designation index
+         */
+        void IndexFixed() noexcept;
+
+        /**
+         * Rebuilds the attribute column from the current order of the bodies
+         */
+        void IndexAttributes() noexcept;
+
+        /**
+         * Rebuilds the name index, the trigram index and the sort permutations from the current order of the bodies,
+         * and drops cached filter results
+         */
+        void IndexNames() noexcept;
+
+        /**
+         * Rebuilds the name index alone and drops cached filter results
+         */
+        void IndexNameLookup() noexcept;
+
+        /**
+         * Rebuilds the sort permutations
+         */
+        void IndexOrders() noexcept;
+
+        /**
+         * Rebuilds the position of each body in the sort permutations
+         */
+        void IndexRanks() noexcept;
+
+        /**
+         * Rebuilds the name index of the planets
+         */
+        void IndexPlanets() noexcept;
+
+        /**
+         * Evaluates the time independent part of a filter
+         * @param key Normalized filter
+         * @param within Indices of a superset of the result, or nullptr to evaluate the whole catalog
+         * @return indices of the matching bodies in catalog order
+         */
+        std::vector<u32> MatchFixed(const FilterCache::Key& key, const std::vector<u32>* within) const noexcept;
 
     public:
         Catalog() noexcept = default;
 
         /**
-         * Import the NGC2000 catalog and the corresponding common names
+         * Import the NGC2000 catalog and the corresponding common names. Large catalogs are split at line boundaries
+         * and parsed in parallel, the result does not depend on the number of threads. The imported bodies are
+         * appended in the order of their dimension
          * @param catalog Data of the ngc2000 catalog
          * @param names Data of the names
+         * @param threads Maximum number of threads, that parse the catalog
          * @return boolean value that indicates success
          */
-        bool ImportFixed(std::string_view catalog, std::string_view names) noexcept;
+        bool ImportFixed(std::string_view catalog, std::string_view names, usize threads = 1) noexcept;
+
+        /**
+         * Replaces the fixed bodies with the content of a snapshot, that was created by ExportSnapshot. Handles of the
+         * previous bodies are invalidated. The strings of the bodies refer to the snapshot instead of a copy, so the
+         * snapshot has to outlive the bodies
+         * @param snapshot Data of the snapshot, usually a mapped file
+         * @param sourceChecksum Checksum of the source data, that the snapshot must have been created from
+         * @return false if the snapshot is malformed, of another version or stale, the catalog is unchanged then
+         */
+        bool ImportSnapshot(std::string_view snapshot, u64 sourceChecksum) noexcept;
+
+        /**
+         * Serializes the fixed bodies into fixed-width records and a string table, together with the designation
+         * indices, the attribute column, the sort permutations, the declination order and the trigram index, that
+         * ImportSnapshot loads without any parsing or sorting. The byte order is the one of the host
+         * @param sourceChecksum Checksum of the source data, that the fixed bodies were imported from
+         * @return snapshot
+         */
+        std::string ExportSnapshot(u64 sourceChecksum) const noexcept;
+
+        /**
+         * Computes the checksum, that identifies the source data of a snapshot
+         * @param catalog Data of the ngc2000 catalog
+         * @param names Data of the names
+         * @return checksum
+         */
+        static u64 SourceChecksum(std::string_view catalog, std::string_view names) noexcept;
 
         /**
          * Import the planetary catalog from `planets.json`
@@ -40,14 +174,28 @@ namespace ephemeris {
         /**
          * Find a FixedBody by its designation
          * @param designation Designation for the search
-         * @return reference or null
+         * @return handle or nothing
          */
-        std::shared_ptr<FixedBody> FindFixedByDesignation(std::string_view designation) const noexcept;
+        std::optional<FixedHandle> FindFixedHandleByDesignation(std::string_view designation) const noexcept;
 
         /**
          * Find a FixedBody by its name
          * @param name Name for the search
-         * @return reference or null
+         * @return handle or nothing
+         */
+        std::optional<FixedHandle> FindFixedHandleByName(std::string_view name) const noexcept;
+
+        /**
+         * Find a FixedBody by its designation, compatibility shim around FindFixedHandleByDesignation
+         * @param designation Designation for the search
+         * @return owning copy or null
+         */
+        std::shared_ptr<FixedBody> FindFixedByDesignation(std::string_view designation) const noexcept;
+
+        /**
+         * Find a FixedBody by its name, compatibility shim around FindFixedHandleByName
+         * @param name Name for the search
+         * @return owning copy or null
          */
         std::shared_ptr<FixedBody> FindFixedByName(std::string_view name) const noexcept;
 
@@ -61,21 +209,48 @@ namespace ephemeris {
         struct VisibilityFilter {
             f64 AltitudeThreshold;
             Geographic Observer;
+
+            /** Bodies have to be above the horizon as well, nullptr for a flat horizon */
+            std::shared_ptr<const HorizonProfile> Horizon{};
         };
 
         struct Filter {
             std::string_view Identifier;
-            std::unordered_set<Classification> Classifications;
-            std::unordered_set<std::string_view> Constellations;
+            ClassificationMask Classifications;
+            ConstellationMask Constellations;
             std::optional<VisibilityFilter> Visibility;
         };
 
         /**
-         * Filter
+         * Classifies the fixed bodies by their declination into bodies, that never reach the altitude threshold and the
+         * horizon of the filter, that never drop below them, and that cross them during a day
+         * @param visibility Visibility filter
+         * @return classification, only the crossing bodies need a time-dependent evaluation
+         */
+        std::shared_ptr<const DeclinationIndex::Bands> ClassifyFixed(const VisibilityFilter& visibility) const noexcept;
+
+        /**
+         * Filter, a filter that narrows a recently used one is only evaluated against the previous result. The
+         * visibility is only evaluated for bodies, whose declination lets them cross the altitude threshold
          * @param filter Filter
-         * @return matching FixedBodies
+         * @return handles of the matching FixedBodies in catalog order
          */
-        std::vector<std::shared_ptr<FixedBody>> FilterFixed(const Filter& filter) const noexcept;
+        std::vector<FixedHandle> FilterFixed(const Filter& filter) const noexcept;
+
+        /**
+         * Evaluates a query, ephemeris predicates are evaluated at the instant for the observer
+         * @param query Query
+         * @param utc Instant in utc
+         * @param observer Observer
+         * @param within Handles in catalog order, to which the query is restricted, or nullptr for the whole catalog
+         * @param profile Receives the measurements of the predicates, if not nullptr
+         * @return handles of the matching FixedBodies in catalog order
+         */
+        std::vector<FixedHandle> QueryFixed(const Query& query,
+                                            const Instant& utc,
+                                            const Geographic& observer,
+                                            const std::vector<FixedHandle>* within = nullptr,
+                                            std::vector<Query::Step>* profile = nullptr) const noexcept;
 
         /*
          * Filter
@@ -85,16 +260,65 @@ namespace ephemeris {
         std::vector<std::shared_ptr<Planet>> FilterPlanets(std::string_view filter) const noexcept;
 
         /**
-         * Retrieves the planets
+         * Computes the horizontal position of every fixed body in a single pass
+         * @param utc Instant in utc
+         * @param observer Observer
+         * @return altitudes and azimuths in the order of GetBodies
+         */
+        ComputeResult ObserveFixed(const Instant& utc, const Geographic& observer) const noexcept;
+
+        /**
+         * Retrieves the planets, the lookup indices are not updated when names are modified through the reference
          * @return planets
          */
         std::vector<std::shared_ptr<Planet>>& GetPlanets() noexcept;
 
         /**
-         * Retrieves the bodies
+         * Retrieves the body of a handle, the reference is valid until the next import
+         * @param handle Handle of this catalog
+         * @return body
+         */
+        const FixedBody& GetFixed(FixedHandle handle) const noexcept;
+
+        /**
+         * Copies the body of a handle, for callers that keep a body beyond the next import. The copy owns its strings
+         * and stays valid after later imports and after the catalog is destroyed
+         * @param handle Handle of this catalog
+         * @return copy
+         */
+        std::shared_ptr<FixedBody> ShareFixed(FixedHandle handle) const noexcept;
+
+        /**
+         * Retrieves the bodies, the index of a body is the index of its handle
          * @return bodies
          */
-        std::vector<std::shared_ptr<FixedBody>>& GetBodies() noexcept;
+        const std::vector<FixedBody>& GetBodies() const noexcept;
+
+        /**
+         * Retrieves the precomputed permutation of a sort key
+         * @param key Sort key
+         * @return indices of all bodies in the order of the key
+         */
+        const std::vector<u32>& GetOrder(SortKey key) const noexcept;
+
+        /**
+         * Orders handles through the precomputed permutation of a key, without comparing any bodies
+         * @param handles Handles of this catalog
+         * @param key Sort key
+         */
+        void SortFixed(std::vector<FixedHandle>& handles, SortKey key) const noexcept;
+
+        /**
+         * Orders handles by descending altitude. As the sky rotates slowly, handles that were ordered by a previous
+         * call are almost sorted, and a few insertion sort passes restore the order in about linear time. Handles in
+         * any other order are sorted from scratch
+         * @param handles Handles of this catalog
+         * @param utc Instant in utc
+         * @param observer Observer
+         */
+        void SortFixedByAltitude(std::vector<FixedHandle>& handles,
+                                 const Instant& utc,
+                                 const Geographic& observer) const noexcept;
     };
 
     inline bool operator==(const Catalog::Filter& a, const Catalog::Filter& b) noexcept {
@@ -109,7 +333,8 @@ namespace ephemeris {
                 const auto f64Equal = [](f64 a, f64 b) { return fabs(a - b) < DBL_EPSILON * 10.0; };
                 return f64Equal(a.Visibility->AltitudeThreshold, b.Visibility->AltitudeThreshold) &&
                        f64Equal(a.Visibility->Observer.Latitude, b.Visibility->Observer.Latitude) &&
-                       f64Equal(a.Visibility->Observer.Longitude, b.Visibility->Observer.Longitude);
+                       f64Equal(a.Visibility->Observer.Longitude, b.Visibility->Observer.Longitude) &&
+                       a.Visibility->Horizon == b.Visibility->Horizon;
             }
             return false;
         }
@@ -122,115 +347,6 @@ namespace ephemeris {
     inline bool operator!=(const Catalog::Filter& a, const Catalog::Filter& b) noexcept {
         return !(a == b);
     }
-
-    struct ComputeResult {
-        std::vector<f64> Altitudes;
-        std::vector<f64> Azimuths;
-    };
-
-    struct ComputeInfo {
-        DateTime Date;
-        Geographic Observer;
-        std::size_t Steps;
-        std::size_t StepSize;
-        DateTime::Unit Unit;
-
-        ComputeInfo() noexcept;
-    };
-
-    ComputeResult ComputeGeographic(const std::shared_ptr<Planet>& planet, ComputeInfo info) noexcept;
-    ComputeResult ComputeGeographic(const std::shared_ptr<FixedBody>& body, ComputeInfo info) noexcept;
-
-    static inline const std::unordered_map<std::string_view, std::string_view> ConstellationExpansionTable = {
-        { "And", "Andromeda" },
-        { "Ant", "Antlia" },
-        { "Aps", "Apus" },
-        { "Aqr", "Aquarius" },
-        { "Aql", "Aquila" },
-        { "Ara", "Ara" },
-        { "Ari", "Aries" },
-        { "Aur", "Auriga" },
-        { "Boo", "Bo�tes" },
-        { "Cae", "Caelum" },
-        { "Cam", "Camelopardalis" },
-        { "Cnc", "Cancer" },
-        { "CVn", "Canes Venatici" },
-        { "CMa", "Canis Major" },
-        { "CMi", "Canis Minor" },
-        { "Cap", "Capricornus" },
-        { "Car", "Carina" },
-        { "Cas", "Cassiopeia" },
-        { "Cen", "Centaurus" },
-        { "Cep", "Cepheus" },
-        { "Cet", "Cetus" },
-        { "Cha", "Chamaeleon" },
-        { "Cir", "Circinus" },
-        { "Col", "Columba" },
-        { "Com", "Coma Berenices" },
-        { "CrA", "Corona Australis" },
-        { "CrB", "Corona Borealis" },
-        { "Crv", "Corvus" },
-        { "Crt", "Crater" },
-        { "Cru", "Crux" },
-        { "Cyg", "Cygnus" },
-        { "Del", "Delphinus" },
-        { "Dor", "Dorado" },
-        { "Dra", "Draco" },
-        { "Equ", "Equuleus" },
-        { "Eri", "Eridanus" },
-        { "For", "Fornax" },
-        { "Gem", "Gemini" },
-        { "Gru", "Grus" },
-        { "Her", "Hercules" },
-        { "Hor", "Horologium" },
-        { "Hya", "Hydra" },
-        { "Hyi", "Hydrus" },
-        { "Ind", "Indus" },
-        { "Lac", "Lacerta" },
-        { "Leo", "Leo" },
-        { "Lib", "Libra" },
-        { "LMi", "Leo Minor" },
-        { "Lep", "Lepus" },
-        { "Lup", "Lupus" },
-        { "Lyn", "Lynx" },
-        { "Lyr", "Lyra" },
-        { "Men", "Mensa" },
-        { "Mic", "Microscopium" },
-        { "Mon", "Monoceros" },
-        { "Mus", "Musca" },
-        { "Nor", "Norma" },
-        { "Oct", "Octans" },
-        { "Oph", "Ophiuchus" },
-        { "Ori", "Orion" },
-        { "Pav", "Pavo" },
-        { "Peg", "Pegasus" },
-        { "Per", "Perseus" },
-        { "Phe", "Phoenix" },
-        { "Pic", "Pictor" },
-        { "Psc", "Pisces" },
-        { "PsA", "Piscis Austrinus" },
-        { "Pup", "Puppis" },
-        { "Pyx", "Pyxis" },
-        { "Ret", "Reticulum" },
-        { "Sge", "Sagitta" },
-        { "Sgr", "Sagittarius" },
-        { "Sco", "Scorpius" },
-        { "Scl", "Sculptor" },
-        { "Sct", "Scutum" },
-        { "Ser", "Serpens" },
-        { "Sex", "Sextans" },
-        { "Tau", "Taurus" },
-        { "Tel", "Telescopium" },
-        { "Tri", "Triangulum" },
-        { "TrA", "Triangulum Australe" },
-        { "Tuc", "Tucana" },
-        { "UMa", "Ursa Major" },
-        { "UMi", "Ursa Minor" },
-        { "Vel", "Vela" },
-        { "Vir", "Virgo" },
-        { "Vol", "Volans" },
-        { "Vul", "Vulpecula" },
-    };
 }// namespace ephemeris
 
 #endif// LIBENGINE_EPHEMERIS_CATALOG_H
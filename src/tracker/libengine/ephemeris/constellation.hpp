@@ -0,0 +1,157 @@
+#ifndef LIBENGINE_EPHEMERIS_CONSTELLATION_H
+#define LIBENGINE_EPHEMERIS_CONSTELLATION_H
+
+#include <array>
+#include <bitset>
+#include <string_view>
+
+#include "utility/perfect-hash.hpp"
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    struct Constellation {
+        std::string_view Name{ "" };
+        std::string_view Abbreviation{ "" };
+    };
+
+    /**
+     * Number of constellations, that are recognized by the IAU
+     */
+    constexpr usize ConstellationCount = 88;
+
+    /**
+     * @brief Dense identifier of a constellation, which is its index in the ConstellationTable
+     */
+    using ConstellationId = u8;
+
+    /**
+     * Identifier of all constellations, that are not in the table
+     */
+    constexpr ConstellationId UnknownConstellation = ConstellationCount;
+
+    /**
+     * @brief Set of constellations, in which bit i stands for the constellation with identifier i
+     */
+    using ConstellationMask = std::bitset<ConstellationCount>;
+
+    /**
+     * @brief Constellations in the order of their identifiers
+     */
+    constexpr std::array<Constellation, ConstellationCount> ConstellationTable = { {
+        { "Andromeda", "And" },
+        { "Antlia", "Ant" },
+        { "Apus", "Aps" },
+        { "Aquarius", "Aqr" },
+        { "Aquila", "Aql" },
+        { "Ara", "Ara" },
+        { "Aries", "Ari" },
+        { "Auriga", "Aur" },
+        { "Bo�tes", "Boo" },
+        { "Caelum", "Cae" },
+        { "Camelopardalis", "Cam" },
+        { "Cancer", "Cnc" },
+        { "Canes Venatici", "CVn" },
+        { "Canis Major", "CMa" },
+        { "Canis Minor", "CMi" },
+        { "Capricornus", "Cap" },
+        { "Carina", "Car" },
+        { "Cassiopeia", "Cas" },
+        { "Centaurus", "Cen" },
+        { "Cepheus", "Cep" },
+        { "Cetus", "Cet" },
+        { "Chamaeleon", "Cha" },
+        { "Circinus", "Cir" },
+        { "Columba", "Col" },
+        { "Coma Berenices", "Com" },
+        { "Corona Australis", "CrA" },
+        { "Corona Borealis", "CrB" },
+        { "Corvus", "Crv" },
+        { "Crater", "Crt" },
+        { "Crux", "Cru" },
+        { "Cygnus", "Cyg" },
+        { "Delphinus", "Del" },
+        { "Dorado", "Dor" },
+        { "Draco", "Dra" },
+        { "Equuleus", "Equ" },
+        { "Eridanus", "Eri" },
+        { "Fornax", "For" },
+        { "Gemini", "Gem" },
+        { "Grus", "Gru" },
+        { "Hercules", "Her" },
+        { "Horologium", "Hor" },
+        { "Hydra", "Hya" },
+        { "Hydrus", "Hyi" },
+        { "Indus", "Ind" },
+        { "Lacerta", "Lac" },
+        { "Leo", "Leo" },
+        { "Libra", "Lib" },
+        { "Leo Minor", "LMi" },
+        { "Lepus", "Lep" },
+        { "Lupus", "Lup" },
+        { "Lynx", "Lyn" },
+        { "Lyra", "Lyr" },
+        { "Mensa", "Men" },
+        { "Microscopium", "Mic" },
+        { "Monoceros", "Mon" },
+        { "Musca", "Mus" },
+        { "Norma", "Nor" },
+        { "Octans", "Oct" },
+        { "Ophiuchus", "Oph" },
+        { "Orion", "Ori" },
+        { "Pavo", "Pav" },
+        { "Pegasus", "Peg" },
+        { "Perseus", "Per" },
+        { "Phoenix", "Phe" },
+        { "Pictor", "Pic" },
+        { "Pisces", "Psc" },
+        { "Piscis Austrinus", "PsA" },
+        { "Puppis", "Pup" },
+        { "Pyxis", "Pyx" },
+        { "Reticulum", "Ret" },
+        { "Sagitta", "Sge" },
+        { "Sagittarius", "Sgr" },
+        { "Scorpius", "Sco" },
+        { "Sculptor", "Scl" },
+        { "Scutum", "Sct" },
+        { "Serpens", "Ser" },
+        { "Sextans", "Sex" },
+        { "Taurus", "Tau" },
+        { "Telescopium", "Tel" },
+        { "Triangulum", "Tri" },
+        { "Triangulum Australe", "TrA" },
+        { "Tucana", "Tuc" },
+        { "Ursa Major", "UMa" },
+        { "Ursa Minor", "UMi" },
+        { "Vela", "Vel" },
+        { "Virgo", "Vir" },
+        { "Volans", "Vol" },
+        { "Vulpecula", "Vul" },
+    } };
+
+    using ConstellationIndexTable = utility::PerfectHashTable<ConstellationId, ConstellationCount>;
+
+    /**
+     * Ids of the constellations by their abbreviation, generated from the table at compile time
+     */
+    inline constexpr ConstellationIndexTable ConstellationIndex{ [] {
+        std::array<ConstellationIndexTable::Entry, ConstellationCount> entries{};
+        for (usize id = 0; id < ConstellationTable.size(); ++id) {
+            entries[id] = { ConstellationTable[id].Abbreviation, static_cast<ConstellationId>(id) };
+        }
+        return entries;
+    }() };
+    static_assert(ConstellationIndex.Valid(), "Abbreviations have to be distinct");
+
+    /**
+     * Looks up the identifier of a constellation
+     * @param abbreviation Abbreviation, e.g. `And`
+     * @return identifier, or UnknownConstellation if the abbreviation is not in the table
+     */
+    constexpr ConstellationId FindConstellation(std::string_view abbreviation) noexcept {
+        const auto* id = ConstellationIndex.Find(abbreviation);
+        return id != nullptr ? *id : UnknownConstellation;
+    }
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_CONSTELLATION_H
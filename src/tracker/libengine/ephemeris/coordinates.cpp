@@ -1,8 +1,54 @@
+#include <algorithm>
+#include <atomic>
+
 #include "coordinates.hpp"
+#include "fixed-body.hpp"
+#include "libengine/clock.hpp"
 #include "libengine/math.hpp"
 
 namespace ephemeris {
 
+    namespace {
+
+        std::atomic<f64> transformQuantum{ DefaultTransformQuantum };
+
+        /**
+         * Cached transformation, valid for a quantised epoch and the quantum it was computed with
+         */
+        struct TransformEntry {
+            bool Valid;
+            s64 Key;
+            f64 Quantum;
+            Matrix3x3 Matrix;
+        };
+
+        /**
+         * Number of epochs that are cached per transformation, so that a time series crossing the boundary of a quantum
+         * does not evict the previous matrix
+         */
+        constexpr usize TransformCacheSize = 4;
+
+        thread_local std::array<std::array<TransformEntry, TransformCacheSize>, 2> transformCache{};
+
+        /**
+         * Computes the transformation without any caching
+         * @param transform Transformation
+         * @param julianCenturies Epoch of date in julian centuries since J2000
+         * @return transformation matrix
+         */
+        Matrix3x3 ComputeTransform(EpochTransform transform, f64 julianCenturies) noexcept {
+            switch (transform) {
+                case EpochTransform::FixedB2000:
+                    return PrecessionMatrix(ReferencePlane::Equatorial, EpochB2000, julianCenturies);
+                case EpochTransform::EclipticJ2000: {
+                    auto precession = PrecessionMatrix(ReferencePlane::Equatorial, 0.0, julianCenturies);
+                    return precession * ReferencePlaneMatrix(ReferencePlane::Ecliptic, ReferencePlane::Equatorial, 0.0);
+                }
+            }
+            return Matrix3x3(1.0);
+        }
+    }// namespace
+
     f64 Vector3::Length() const noexcept {
         return std::sqrt(X * X + Y * Y + Z * Z);
     }
@@ -147,6 +193,29 @@ namespace ephemeris {
         return {};
     }
 
+    void SetTransformQuantum(f64 julianCenturies) noexcept {
+        transformQuantum.store(std::max(julianCenturies, 0.0));
+    }
+
+    f64 GetTransformQuantum() noexcept {
+        return transformQuantum.load();
+    }
+
+    Matrix3x3 TransformMatrix(EpochTransform transform, f64 julianCenturies) noexcept {
+        const auto quantum = transformQuantum.load(std::memory_order_relaxed);
+        if (quantum <= 0.0) {
+            return ComputeTransform(transform, julianCenturies);
+        }
+
+        const auto key = static_cast<s64>(std::llround(julianCenturies / quantum));
+        auto& entries = transformCache[static_cast<usize>(transform)];
+        auto& entry = entries[static_cast<usize>(key) % TransformCacheSize];
+        if (!entry.Valid || entry.Key != key || entry.Quantum != quantum) {
+            entry = { true, key, quantum, ComputeTransform(transform, static_cast<f64>(key) * quantum) };
+        }
+        return entry.Matrix;
+    }
+
     Vector3 EquatorialToVector(const Equatorial& coords) noexcept {
         Vector3 rectCoords{};
         rectCoords.X = coords.Radius * math::Cosine(coords.RightAscension) * math::Cosine(coords.Declination);
@@ -191,4 +260,47 @@ namespace ephemeris {
         const auto hourAngle = localMeanSiderealTime - sphericalCoords.RightAscension;
         return LocalEquatorialToHorizontal(sphericalCoords.Declination, hourAngle, observer.Latitude);
     }
+
+    Horizontal ObserveGeographic(const Equatorial& sphericalCoords,
+                                 const Geographic& observer,
+                                 const Instant& utc) noexcept {
+        const auto siderealTime = Clock::GreenwichMeanSiderealTime(utc.JulianMidnight(), utc.DayFraction());
+        const auto hourAngle = siderealTime + observer.Longitude - sphericalCoords.RightAscension;
+        return LocalEquatorialToHorizontal(sphericalCoords.Declination, hourAngle, observer.Latitude);
+    }
+
+    ObserverFrame::ObserverFrame(const Geographic& observer) noexcept
+        : Longitude{ observer.Longitude },
+          SinLatitude{ math::Sine(observer.Latitude) },
+          CosLatitude{ math::Cosine(observer.Latitude) } { }
+
+    Vector3 ObserveFrameVector(const Vector3& position,
+                               f64 greenwichSiderealTime,
+                               const ObserverFrame& frame) noexcept {
+        const auto localSiderealTime = greenwichSiderealTime + frame.Longitude;
+        const auto sinSiderealTime = math::Sine(localSiderealTime);
+        const auto cosSiderealTime = math::Cosine(localSiderealTime);
+        const auto length = position.Length();
+
+        // Rotate into the frame of the hour angle, which is the same as
+        // EquatorialToVector with the right ascension replaced by the hour angle
+        const auto x = (cosSiderealTime * position.X + sinSiderealTime * position.Y) / length;
+        const auto y = (sinSiderealTime * position.X - cosSiderealTime * position.Y) / length;
+        const auto z = position.Z / length;
+
+        // Same rotation around the y-axis as in LocalEquatorialToHorizontal, with the sine and cosine of the
+        // co-latitude expressed via the latitude
+        return { frame.SinLatitude * x - frame.CosLatitude * z, y, frame.CosLatitude * x + frame.SinLatitude * z };
+    }
+
+    Horizontal HorizonVectorToHorizontal(const Vector3& horizon) noexcept {
+        Horizontal horizontalCoords{};
+        horizontalCoords.Azimuth = math::ArcTangent2(horizon.Y, horizon.X) + 180.0;
+        horizontalCoords.Altitude = math::ArcSine(std::clamp(horizon.Z, -1.0, 1.0));
+        return horizontalCoords;
+    }
+
+    Horizontal ObserveFrame(const Vector3& position, f64 greenwichSiderealTime, const ObserverFrame& frame) noexcept {
+        return HorizonVectorToHorizontal(ObserveFrameVector(position, greenwichSiderealTime, frame));
+    }
 }// namespace ephemeris
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "coordinates.hpp"
 #include "date-time.hpp"
+#include "instant.hpp"
 
 /**
  * @brief Calculations are based on the book "Astronomie mit dem Personal Computer"
@@ -137,6 +138,45 @@ namespace ephemeris {
      */
     Matrix3x3 PrecessionMatrix(ReferencePlane referencePlane, f64 t1, f64 t2) noexcept;
 
+    /**
+     * @brief Combined transformations, whose origin epoch is fixed, so that they only depend on the epoch of date
+     */
+    enum class EpochTransform {
+        /** Precession of B2000 catalog positions to the equinox of date */
+        FixedB2000,
+        /** J2000 ecliptic coordinates to equatorial coordinates with the equinox of date */
+        EclipticJ2000
+    };
+
+    /**
+     * Default quantum of the transformation cache, which is one day. The general precession amounts to 50.3 arc
+     * seconds per year, so rounding the epoch to the nearest day displaces a position by at most 0.07 arc seconds.
+     * This is well below the accuracy of the catalog positions (0.1 minutes of right ascension, 1 arc minute of
+     * declination) and of the mean kepler elements of the planets
+     */
+    constexpr f64 DefaultTransformQuantum = 1.0 / 36525.0;
+
+    /**
+     * Sets the quantum, to which the epoch of cached transformations is rounded
+     * @param julianCenturies Quantum in julian centuries, zero disables the cache
+     */
+    void SetTransformQuantum(f64 julianCenturies) noexcept;
+
+    /**
+     * Retrieves the quantum of the transformation cache
+     * @return quantum in julian centuries
+     */
+    f64 GetTransformQuantum() noexcept;
+
+    /**
+     * Retrieves the combined transformation matrix for the epoch. Matrices are cached per thread and quantised epoch,
+     * so all bodies that are evaluated at the same instant share one matrix build
+     * @param transform Transformation
+     * @param julianCenturies Epoch of date in julian centuries since J2000
+     * @return transformation matrix, which is evaluated at the quantised epoch
+     */
+    Matrix3x3 TransformMatrix(EpochTransform transform, f64 julianCenturies) noexcept;
+
     /**
      * @brief Transform equatorial coordinates to a Vector3
      * @param coords The equatorial coordinates
@@ -170,6 +210,58 @@ namespace ephemeris {
     Horizontal ObserveGeographic(const Equatorial& sphericalCoords,
                                  const Geographic& observer,
                                  const DateTime& date) noexcept;
+
+    /**
+     * @brief Computes the Horizontal position of an object with spherical coordinates
+     * @param sphericalCoords The spherical coordinates of the object
+     * @param observer The geographic coordinates of the observer
+     * @param utc The instant for the computation in utc
+     * @return the Computed horizontal coordinates
+     */
+    Horizontal ObserveGeographic(const Equatorial& sphericalCoords,
+                                 const Geographic& observer,
+                                 const Instant& utc) noexcept;
+
+    /**
+     * @brief Observer dependent invariants, so that they can be hoisted out of time series computations
+     */
+    struct ObserverFrame {
+        f64 Longitude;
+        f64 SinLatitude;
+        f64 CosLatitude;
+
+        /**
+         * Precomputes the trigonometric terms of the observer's latitude
+         * @param observer The geographic coordinates of the observer
+         */
+        explicit ObserverFrame(const Geographic& observer) noexcept;
+    };
+
+    /**
+     * @brief Rotates rectangular equatorial coordinates into the horizon of the observer
+     * @param position Rectangular equatorial coordinates with the equinox of date, length is irrelevant
+     * @param greenwichSiderealTime Greenwich mean sidereal time in degrees
+     * @param frame Precomputed observer frame
+     * @return unit vector, whose z-axis points to the zenith and whose x-axis points south
+     */
+    Vector3 ObserveFrameVector(const Vector3& position, f64 greenwichSiderealTime, const ObserverFrame& frame) noexcept;
+
+    /**
+     * @brief Converts a unit vector in the horizon of the observer to horizontal coordinates
+     * @param horizon Unit vector as obtained by ObserveFrameVector
+     * @return the Computed horizontal coordinates
+     */
+    Horizontal HorizonVectorToHorizontal(const Vector3& horizon) noexcept;
+
+    /**
+     * @brief Computes the Horizontal position of an object from its rectangular coordinates
+     * @param position Rectangular equatorial coordinates with the equinox of date, length is irrelevant
+     * @param greenwichSiderealTime Greenwich mean sidereal time in degrees
+     * @param frame Precomputed observer frame
+     * @return the Computed horizontal coordinates
+     * @note This is equivalent to ObserveGeographic, but does not need any calendar arithmetic
+     */
+    Horizontal ObserveFrame(const Vector3& position, f64 greenwichSiderealTime, const ObserverFrame& frame) noexcept;
 }// namespace ephemeris
 
 #endif// LIBENGINE_EPHEMERIS_COORDINATES_H
\ No newline at end of file
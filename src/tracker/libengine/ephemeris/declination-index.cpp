@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <numeric>
+
+#include "declination-index.hpp"
+
+namespace ephemeris {
+
+    void DeclinationIndex::Build(const std::vector<FixedBody>& bodies) noexcept {
+        std::vector<u32> ascending(bodies.size());
+        std::iota(ascending.begin(), ascending.end(), 0);
+        std::stable_sort(ascending.begin(), ascending.end(), [&bodies](u32 a, u32 b) {
+            return bodies[a].Position.Declination < bodies[b].Position.Declination;
+        });
+        Assign(bodies, std::move(ascending));
+    }
+
+    void DeclinationIndex::Assign(const std::vector<FixedBody>& bodies, std::vector<u32> ascending) noexcept {
+        order = std::move(ascending);
+        declinations.resize(order.size());
+        for (usize position = 0; position < order.size(); ++position) {
+            declinations[position] = bodies[order[position]].Position.Declination;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        recent.reset();
+    }
+
+    const std::vector<u32>& DeclinationIndex::GetOrder() const noexcept {
+        return order;
+    }
+
+    std::shared_ptr<const DeclinationIndex::Bands>
+    DeclinationIndex::Classify(f64 latitude, f64 lowestThreshold, f64 highestThreshold) const noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (recent && recent->Latitude == latitude && recent->LowestThreshold == lowestThreshold &&
+                recent->HighestThreshold == highestThreshold) {
+                return recent;
+            }
+        }
+
+        // The upper culmination is at 90 - |latitude - declination| and the lower one at |latitude + declination| - 90
+        const auto lowest = std::clamp(lowestThreshold, -90.0, 90.0);
+        const auto highest = std::clamp(std::max(lowestThreshold, highestThreshold), -90.0, 90.0);
+        const auto reach = 90.0 - lowest;
+        const auto lowestCrossing = latitude - reach - Margin;
+        const auto highestCrossing = latitude + reach + Margin;
+        const auto lowestAbove = 90.0 + highest - latitude + Margin;
+        const auto highestAbove = -90.0 - highest - latitude - Margin;
+
+        const auto below = [this](f64 declination) {
+            return static_cast<usize>(std::lower_bound(declinations.begin(), declinations.end(), declination) -
+                                      declinations.begin());
+        };
+        const auto above = [this](f64 declination) {
+            return static_cast<usize>(std::upper_bound(declinations.begin(), declinations.end(), declination) -
+                                      declinations.begin());
+        };
+        const auto assign = [this](Bands& bands, usize begin, usize end, Band band) {
+            for (auto at = begin; at < end; ++at) {
+                bands.Of[order[at]] = band;
+            }
+        };
+
+        auto bands = std::make_shared<Bands>();
+        bands->Latitude = latitude;
+        bands->LowestThreshold = lowestThreshold;
+        bands->HighestThreshold = highestThreshold;
+        bands->Of.assign(order.size(), Band::Sometimes);
+
+        // Both bands are narrowed by the margin, so they never overlap
+        assign(*bands, 0, below(lowestCrossing), Band::Never);
+        assign(*bands, above(highestCrossing), order.size(), Band::Never);
+        assign(*bands, 0, above(highestAbove), Band::Always);
+        assign(*bands, below(lowestAbove), order.size(), Band::Always);
+
+        bands->Never = static_cast<usize>(std::count(bands->Of.begin(), bands->Of.end(), Band::Never));
+        bands->Always = static_cast<usize>(std::count(bands->Of.begin(), bands->Of.end(), Band::Always));
+        bands->Sometimes = order.size() - bands->Never - bands->Always;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        recent = bands;
+        return recent;
+    }
+}// namespace ephemeris
@@ -0,0 +1,96 @@
+#ifndef LIBENGINE_EPHEMERIS_DECLINATIONINDEX_H
+#define LIBENGINE_EPHEMERIS_DECLINATIONINDEX_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "fixed-body.hpp"
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Index of the bodies by their catalog declination. For an observer latitude and an altitude threshold,
+     * the declination alone decides whether a body never reaches the threshold, never drops below it, or crosses it
+     * during a day. Each of these bands is a contiguous range of the index, so that only the crossing band needs
+     * a time-dependent evaluation. A threshold, that depends on the azimuth, is bounded by its lowest and highest
+     * value
+     */
+    class DeclinationIndex {
+    public:
+        enum class Band : u8 {
+            /** The upper culmination stays below the lowest threshold */
+            Never,
+            /** The altitude crosses the threshold during a day */
+            Sometimes,
+            /** The lower culmination stays above the highest threshold */
+            Always
+        };
+
+        /**
+         * @brief Classification of every body for one latitude and threshold
+         */
+        struct Bands {
+            f64 Latitude;
+            f64 LowestThreshold;
+            f64 HighestThreshold;
+
+            /** Band of each body, indexed like the bodies */
+            std::vector<Band> Of;
+
+            usize Never;
+            usize Sometimes;
+            usize Always;
+        };
+
+        /**
+         * Margin in degrees, by which the bands are narrowed. The catalog declinations refer to B2000 and precession
+         * moves them by less than 20 arc seconds per year, so that the classification stays conservative for
+         * centuries
+         */
+        static constexpr f64 Margin = 1.0;
+
+    private:
+        std::vector<u32> order{};
+        std::vector<f64> declinations{};
+
+        // The most recent classification, observer and threshold rarely change between two filters
+        mutable std::mutex mutex{};
+        mutable std::shared_ptr<const Bands> recent{};
+
+    public:
+        DeclinationIndex() noexcept = default;
+
+        /**
+         * @brief Rebuilds the index and drops the recent classification
+         * @param bodies Bodies, whose indices are stored in the index
+         */
+        void Build(const std::vector<FixedBody>& bodies) noexcept;
+
+        /**
+         * @brief Takes over an order, that was built before for the same bodies, and drops the recent classification
+         * @param bodies Bodies, whose indices are stored in the order
+         * @param ascending Permutation of the body indices by ascending declination, as returned by GetOrder
+         */
+        void Assign(const std::vector<FixedBody>& bodies, std::vector<u32> ascending) noexcept;
+
+        /**
+         * @brief Retrieves the order of the bodies
+         * @return permutation of the body indices by ascending declination
+         */
+        const std::vector<u32>& GetOrder() const noexcept;
+
+        /**
+         * @brief Classifies every body for an observer latitude and an altitude threshold
+         * @param latitude Latitude of the observer in degrees
+         * @param lowestThreshold Lowest value of the threshold in degrees
+         * @param highestThreshold Highest value of the threshold in degrees, which is the lowest one for a flat
+         * threshold
+         * @return classification, which is shared with later calls for the same latitude and thresholds
+         */
+        std::shared_ptr<const Bands> Classify(f64 latitude, f64 lowestThreshold, f64 highestThreshold) const noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_DECLINATIONINDEX_H
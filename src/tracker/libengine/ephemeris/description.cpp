@@ -0,0 +1,245 @@
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "description.hpp"
+#include "utility/conversion.hpp"
+#include "utility/perfect-hash.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        using ExpansionTable = utility::PerfectHashTable<std::string_view, 99>;
+
+        /**
+         * Abbreviations of the ngc2000 descriptions. The source lists `m` and `s` twice, only the first meaning was
+         * ever used, so the second one is omitted
+         */
+        constexpr ExpansionTable CatalogDescriptionExpansionTable{ std::array<ExpansionTable::Entry, 99>{ {
+            { "ab", "about" },
+            { "alm", "almost" },
+            { "am", "among" },
+            { "annul", "annular or ring nebula" },
+            { "att", "attached" },
+            { "b", "brighter" },
+            { "bet", "between" },
+            { "biN", "binuclear" },
+            { "bn", "brightest to n side" },
+            { "bs", "brightest to s side" },
+            { "bp", "brightest to p side" },
+            { "bf", "brightest to f side" },
+            { "B", "bright" },
+            { "c", "considerably" },
+            { "chev", "chevelure" },
+            { "co", "coarse, coarsely" },
+            { "com", "cometic (cometary form)" },
+            { "comp", "companion " },
+            { "conn", "connected" },
+            { "cont", "in contact" },
+            { "C", "compressed" },
+            { "Cl", "cluster" },
+            { "d", "diameter" },
+            { "def", "defined" },
+            { "dif", "diffused" },
+            { "diffic", "difficult" },
+            { "dist", "distance, or distant" },
+            { "D", "f64" },
+            { "e", "extremely, excessively" },
+            { "ee", "most extremely" },
+            { "er", "easily resolvable" },
+            { "exc", "excentric" },
+            { "E", "extended" },
+            { "f", "following (eastward)" },
+            { "F", "faint" },
+            { "g", "gradually" },
+            { "glob.", "globular" },
+            { "gr", "group" },
+            { "i", "irregular" },
+            { "iF", "irregular figure" },
+            { "inv", "involved, involving" },
+            { "l", "little or long" },
+            { "L", "large" },
+            { "m", "much" },
+            { "M", "middle, or in the middle" },
+            { "n", "north" },
+            { "neb", "nebula" },
+            { "nebs", "nebulous" },
+            { "neby", "nebulosity" },
+            { "nf", "north following" },
+            { "np", "north preceding" },
+            { "ns", "north-south" },
+            { "nr", "near" },
+            { "N", "nucleus, or to a nucleus" },
+            { "p", "preceding (westward)" },
+            { "pf", "preceding-following" },
+            { "pF", "pretty faint" },
+            { "pB", "pretty bright" },
+            { "pL", "pretty large" },
+            { "pS", "pretty small in angular size" },
+            { "pg", "pretty gradually" },
+            { "pm", "pretty much" },
+            { "ps", "pretty suddenly" },
+            { "plan", "planetary nebula (same as PN)" },
+            { "prob", "probably" },
+            { "P", "poor (sparse) in stars" },
+            { "PN", "planetary nebula" },
+            { "r", "resolvable (mottled, not resolved)" },
+            { "rr", "partially resolved, some stars seen" },
+            { "rrr", "well resolved, clearly consisting of stars" },
+            { "R", "round" },
+            { "RR", "exactly round" },
+            { "Ri", "rich in stars" },
+            { "s", "suddenly (abruptly)" },
+            { "sf", "south following" },
+            { "sp", "south preceding" },
+            { "sc", "scattered" },
+            { "sev", "several" },
+            { "st", "stars" },
+            { "9...", "of 9th magnitude and fainter" },
+            { "9..13", "of mag. 9 to 13" },
+            { "stell", "stellar, pointlike" },
+            { "susp", "suspected" },
+            { "S", "small in angular size" },
+            { "S*", "small (faint) star" },
+            { "trap", "trapezium" },
+            { "triangle", "triangle, forms a triangle with" },
+            { "triN", "trinuclear" },
+            { "v", "very" },
+            { "vv", "very" },
+            { "var", "variable" },
+            { "*", "a single star" },
+            { "*10", "a star of 10th magnitude" },
+            { "*7-8", "star of mag. 7 or 8" },
+            { "**", "f64 star (same as D*)" },
+            { "***", "triple star" },
+            { "!", "remarkable" },
+            { "!!", "very much so" },
+            { "!!!", "a magnificent or otherwise interesting object" },
+        } } };
+        static_assert(CatalogDescriptionExpansionTable.Valid(), "Abbreviations have to be distinct");
+
+        /**
+         * Expansions of the single character abbreviations, indexed by the character, so that the fallback for unknown
+         * words does not hash each character
+         */
+        constexpr std::array<std::string_view, 256> CharacterExpansionTable = [] {
+            std::array<std::string_view, 256> table{};
+            for (usize c = 0; c < table.size(); ++c) {
+                const auto character = static_cast<char>(c);
+                if (const auto* expansion = CatalogDescriptionExpansionTable.Find({ &character, 1 })) {
+                    table[c] = *expansion;
+                }
+            }
+            return table;
+        }();
+
+        /**
+         * Expand a ngc2000 catalog description
+         * @param abbreviated Description in abbreviated form
+         * @return expanded description
+         */
+        std::string ExpandCatalogDescription(std::string_view abbreviated) {
+            // Here is what we have to do:
+            // First, split by ` `
+            // then try to match each word with the expansion table, if there is no match,
+            // expand each character
+            std::string result;
+            std::vector<std::string_view> words{};
+            std::vector<std::string_view> parts{};
+            utility::Split(parts, abbreviated, ", "sv);
+            for (const auto& part : parts) {
+                utility::Split(words, part, " "sv);
+            }
+
+            for (const auto& word : words) {
+                if (const auto* expansion = CatalogDescriptionExpansionTable.Find(word)) {
+                    result += *expansion;
+                    result += " ";
+                } else {
+                    for (const auto c : word) {
+                        const auto& expansion = CharacterExpansionTable[static_cast<u8>(c)];
+                        if (!expansion.empty()) {
+                            result += expansion;
+                        } else {
+                            result += c;
+                        }
+                        result += " ";
+                    }
+                }
+            }
+            return result;
+        }
+
+        struct InternerState {
+            std::shared_mutex Mutex;
+
+            // Elements of a deque are never moved, so the views into the storage stay valid
+            std::deque<std::string> Storage;
+            std::unordered_set<std::string_view> Descriptions;
+            std::unordered_map<std::string_view, std::string> Expansions;
+        };
+
+        InternerState& GetState() noexcept {
+            static InternerState state;
+            return state;
+        }
+
+        /**
+         * Stores the description, the caller holds the unique lock
+         * @param state State
+         * @param abbreviated Description in abbreviated form
+         * @return view of the stored description
+         */
+        std::string_view InternLocked(InternerState& state, std::string_view abbreviated) noexcept {
+            if (const auto it = state.Descriptions.find(abbreviated); it != state.Descriptions.end()) {
+                return *it;
+            }
+            return *state.Descriptions.emplace(state.Storage.emplace_back(abbreviated)).first;
+        }
+    }// namespace
+
+    std::string_view DescriptionInterner::Intern(std::string_view abbreviated) noexcept {
+        auto& state = GetState();
+        {
+            std::shared_lock lock(state.Mutex);
+            if (const auto it = state.Descriptions.find(abbreviated); it != state.Descriptions.end()) {
+                return *it;
+            }
+        }
+        std::unique_lock lock(state.Mutex);
+        return InternLocked(state, abbreviated);
+    }
+
+    const std::string& DescriptionInterner::Expand(std::string_view abbreviated) noexcept {
+        auto& state = GetState();
+        {
+            std::shared_lock lock(state.Mutex);
+            if (const auto it = state.Expansions.find(abbreviated); it != state.Expansions.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock lock(state.Mutex);
+        const auto key = InternLocked(state, abbreviated);
+        const auto [it, inserted] = state.Expansions.try_emplace(key);
+        if (inserted) {
+            it->second = ExpandCatalogDescription(key);
+        }
+        return it->second;
+    }
+
+    usize DescriptionInterner::Size() noexcept {
+        auto& state = GetState();
+        std::shared_lock lock(state.Mutex);
+        return state.Descriptions.size();
+    }
+
+    usize DescriptionInterner::Expanded() noexcept {
+        auto& state = GetState();
+        std::shared_lock lock(state.Mutex);
+        return state.Expansions.size();
+    }
+}// namespace ephemeris
\ No newline at end of file
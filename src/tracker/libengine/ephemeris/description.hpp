@@ -0,0 +1,47 @@
+#ifndef LIBENGINE_EPHEMERIS_DESCRIPTION_H
+#define LIBENGINE_EPHEMERIS_DESCRIPTION_H
+
+#include <string>
+#include <string_view>
+
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Process wide storage of the abbreviated catalog descriptions and their expansions. Equal descriptions
+     * share one entry, and a description is only expanded when it is accessed for the first time. Entries are never
+     * released, so views and references stay valid until the program exits
+     */
+    class DescriptionInterner {
+    public:
+        /**
+         * @brief Stores the abbreviated description, if there is no equal one yet
+         * @param abbreviated Description in abbreviated form, as of the ngc2000 catalog
+         * @return view of the stored description
+         */
+        static std::string_view Intern(std::string_view abbreviated) noexcept;
+
+        /**
+         * @brief Expands the abbreviated description, as of
+         * http://cdsarc.u-strasbg.fr/viz-bin/ReadMe/VII/118?format=html&tex=true
+         * @param abbreviated Description in abbreviated form
+         * @return expanded description
+         */
+        static const std::string& Expand(std::string_view abbreviated) noexcept;
+
+        /**
+         * @brief Number of distinct descriptions
+         * @return size
+         */
+        static usize Size() noexcept;
+
+        /**
+         * @brief Number of descriptions, that have been expanded
+         * @return number of expansions
+         */
+        static usize Expanded() noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_DESCRIPTION_H
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include <algorithm>
+
+#include "filter-cache.hpp"
+#include "trigram-index.hpp"
+#include "utility/conversion.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Checks if every element of the narrower set is in the wider set, an empty set accepts all
+         * @tparam Bits Size of the sets
+         * @param narrower Narrower set
+         * @param wider Wider set
+         * @return boolean value
+         */
+        template<usize Bits>
+        bool NarrowsSet(const std::bitset<Bits>& narrower, const std::bitset<Bits>& wider) noexcept {
+            if (wider.none()) {
+                return true;
+            }
+            return narrower.any() && (narrower & ~wider).none();
+        }
+    }// namespace
+
+    FilterCache::Key::Key(std::string_view identifier,
+                          const ClassificationMask& classifications,
+                          const ConstellationMask& constellations) noexcept
+        : Classifications(classifications), Constellations(constellations) {
+        if (!identifier.empty()) {
+            std::vector<std::string_view> terms{};
+            utility::Split(terms, identifier, ";"sv);
+            Terms.emplace();
+            for (const auto term : terms) {
+                auto& folded = Terms->emplace_back(term);
+                std::transform(folded.begin(), folded.end(), folded.begin(), TrigramIndex::Fold);
+            }
+            std::sort(Terms->begin(), Terms->end());
+            Terms->erase(std::unique(Terms->begin(), Terms->end()), Terms->end());
+        }
+    }
+
+    bool FilterCache::Key::Empty() const noexcept {
+        return !Terms.has_value() && Classifications.none() && Constellations.none();
+    }
+
+    bool FilterCache::Key::Narrows(const Key& wider) const noexcept {
+        if (!NarrowsSet(Classifications, wider.Classifications) || !NarrowsSet(Constellations, wider.Constellations)) {
+            return false;
+        }
+        if (!wider.Terms.has_value()) {
+            return true;
+        }
+        if (!Terms.has_value()) {
+            return false;
+        }
+
+        // Terms are combined by disjunction, so every term has to contain one of the wider terms
+        return std::all_of(Terms->begin(), Terms->end(), [&wider](const std::string& term) {
+            return std::any_of(wider.Terms->begin(), wider.Terms->end(), [&term](const std::string& widerTerm) {
+                return term.find(widerTerm) != std::string::npos;
+            });
+        });
+    }
+
+    bool operator==(const FilterCache::Key& left, const FilterCache::Key& right) noexcept {
+        return left.Terms == right.Terms && left.Classifications == right.Classifications &&
+               left.Constellations == right.Constellations;
+    }
+
+    FilterCache::Match FilterCache::Lookup(const Key& key, std::vector<u32>& indices) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto best = entries.end();
+        auto match = Match::None;
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->Filter == key) {
+                best = it;
+                match = Match::Exact;
+                break;
+            }
+            if (key.Narrows(it->Filter) && (best == entries.end() || it->Indices.size() < best->Indices.size())) {
+                best = it;
+                match = Match::Narrowed;
+            }
+        }
+        if (best == entries.end()) {
+            return Match::None;
+        }
+
+        // The used entry becomes the most recently used one
+        std::rotate(entries.begin(), best, best + 1);
+        indices = entries.front().Indices;
+        return match;
+    }
+
+    void FilterCache::Insert(const Key& key, const std::vector<u32>& indices) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [&key](const Entry& entry) { return entry.Filter == key; });
+        if (it == entries.end()) {
+            if (entries.size() == Capacity) {
+                entries.pop_back();
+            }
+            entries.push_back({ key, indices });
+            it = entries.end() - 1;
+        } else {
+            it->Indices = indices;
+        }
+        std::rotate(entries.begin(), it, it + 1);
+    }
+
+    void FilterCache::Clear() noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+    }
+}// namespace ephemeris
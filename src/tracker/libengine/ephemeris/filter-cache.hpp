@@ -0,0 +1,104 @@
+#ifndef LIBENGINE_EPHEMERIS_FILTERCACHE_H
+#define LIBENGINE_EPHEMERIS_FILTERCACHE_H
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fixed-body.hpp"
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Least recently used cache of the time independent part of fixed body filters, i.e. identifier,
+     * classification and constellation. A filter, that narrows a cached filter, only has to be evaluated against the
+     * cached result instead of the whole catalog. Visibility depends on the current time and is never cached
+     */
+    class FilterCache {
+    public:
+        /**
+         * Number of cached filters, which covers backspacing over a few characters
+         */
+        static constexpr usize Capacity = 8;
+
+        /**
+         * @brief Normalized filter, the identifier terms are case-folded and sorted
+         */
+        struct Key {
+            std::optional<std::vector<std::string>> Terms;
+            ClassificationMask Classifications;
+            ConstellationMask Constellations;
+
+            /**
+             * Normalizes the time independent part of a filter
+             * @param identifier Semicolon separated identifier terms, empty accepts all
+             * @param classifications Accepted classifications, empty accepts all
+             * @param constellations Accepted constellation abbreviations, empty accepts all
+             */
+            Key(std::string_view identifier,
+                const ClassificationMask& classifications,
+                const ConstellationMask& constellations) noexcept;
+
+            /**
+             * Checks if the key accepts every body
+             * @return boolean value
+             */
+            bool Empty() const noexcept;
+
+            /**
+             * Checks if every body that is accepted by this key, is also accepted by the other key
+             * @param wider Other key
+             * @return boolean value
+             */
+            bool Narrows(const Key& wider) const noexcept;
+
+            friend bool operator==(const Key& left, const Key& right) noexcept;
+        };
+
+        enum class Match {
+            /** The key is cached, the indices are its result */
+            Exact,
+            /** The key narrows a cached key, the indices are a superset of its result */
+            Narrowed,
+            /** Nothing usable is cached */
+            None
+        };
+
+    private:
+        struct Entry {
+            Key Filter;
+            std::vector<u32> Indices;
+        };
+
+        mutable std::mutex mutex{};
+        std::vector<Entry> entries{};
+
+    public:
+        FilterCache() noexcept = default;
+
+        /**
+         * @brief Looks up the key, an exact match is preferred, otherwise the smallest result of a wider key is used
+         * @param key Key
+         * @param indices Receives the cached indices in catalog order
+         * @return kind of the match
+         */
+        Match Lookup(const Key& key, std::vector<u32>& indices) noexcept;
+
+        /**
+         * @brief Inserts the result of a key as the most recently used entry, the least recently used entry is evicted
+         * @param key Key
+         * @param indices Indices in catalog order
+         */
+        void Insert(const Key& key, const std::vector<u32>& indices) noexcept;
+
+        /**
+         * @brief Drops all entries, must be called whenever the bodies change
+         */
+        void Clear() noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_FILTERCACHE_H
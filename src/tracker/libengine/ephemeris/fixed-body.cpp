@@ -1,15 +1,52 @@
 #include "fixed-body.hpp"
+#include "description.hpp"
 #include "math.hpp"
+#include "utility/perfect-hash.hpp"
 
 namespace ephemeris {
 
+    namespace {
+
+        using ClassificationTable = utility::PerfectHashTable<Classification, 15>;
+
+        /**
+         * Codes of the NGC2000 catalog, which are right-aligned in a three character column
+         */
+        constexpr ClassificationTable ClassificationCodes{ std::array<ClassificationTable::Entry, 15>{ {
+            { "Gx", Classification::Galaxy },
+            { "OC", Classification::OpenStarCluster },
+            { "Gb", Classification::GlobularStarCluster },
+            { "Nb", Classification::ReflectionNebula },
+            { "Pl", Classification::PlanetaryNebula },
+            { "C+N", Classification::Cluster },
+            { "Ast", Classification::Asterism },
+            { "Kt", Classification::Knot },
+            { "***", Classification::TripleStar },
+            { "D*", Classification::DoubleStar },
+            { "*", Classification::SingleStar },
+            { "?", Classification::Uncertain },
+            { "", Classification::Unidentified },
+            { "-", Classification::Nonexistent },
+            { "PD", Classification::PhotographicPlateDefect },
+        } } };
+        static_assert(ClassificationCodes.Valid(), "Codes have to be distinct");
+    }// namespace
+
     Equatorial FixedBody::GetEquatorialPosition(const DateTime& dateTime) const noexcept {
+        return VectorToEquatorial(GetEquatorialVector(DateTime::JulianCenturies(dateTime)));
+    }
+
+    Equatorial FixedBody::GetEquatorialPosition(const Instant& instant) const noexcept {
+        return VectorToEquatorial(GetEquatorialVector(instant.JulianCenturies()));
+    }
+
+    Vector3 FixedBody::GetEquatorialVector(f64 julianCenturies) const noexcept {
         const auto cartesian = EquatorialToVector(Position);
+        return TransformMatrix(EpochTransform::FixedB2000, julianCenturies) * cartesian;
+    }
 
-        constexpr auto epochB2000 = -0.000012775;
-        const auto epochOfDate = DateTime::JulianCenturies(dateTime);
-        const auto precessed = PrecessionMatrix(ReferencePlane::Equatorial, epochB2000, epochOfDate) * cartesian;
-        return VectorToEquatorial(precessed);
+    const std::string& FixedBody::GetDescription() const noexcept {
+        return DescriptionInterner::Expand(AbbreviatedDescription);
     }
 
     const char* ClassificationToString(Classification classification) noexcept {
@@ -49,4 +86,11 @@ namespace ephemeris {
         }
         return "";
     }
-}// namespace ephemeris
\ No newline at end of file
+
+    std::optional<Classification> ClassificationFromCode(std::string_view code) noexcept {
+        if (const auto* classification = ClassificationCodes.Find(code)) {
+            return *classification;
+        }
+        return {};
+    }
+}// namespace ephemeris
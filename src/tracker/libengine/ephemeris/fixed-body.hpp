@@ -1,9 +1,12 @@
 #ifndef LIBENGINE_EPHEMERIS_FIXEDBODY_H
 #define LIBENGINE_EPHEMERIS_FIXEDBODY_H
 
+#include <bitset>
+#include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
+#include "constellation.hpp"
 #include "coordinates.hpp"
 
 namespace ephemeris {
@@ -27,15 +30,29 @@ namespace ephemeris {
         Planet
     };
 
-    struct Constellation {
-        std::string Name;
-        std::string Abbreviation;
-    };
+    /**
+     * Number of classifications
+     */
+    constexpr usize ClassificationCount = static_cast<usize>(Classification::Planet) + 1;
+
+    /**
+     * @brief Set of classifications, in which bit i stands for the classification with the underlying value i
+     */
+    using ClassificationMask = std::bitset<ClassificationCount>;
 
+    /**
+     * Epoch of the NGC2000 catalog positions (B2000) in julian centuries since J2000
+     */
+    constexpr f64 EpochB2000 = -0.000012775;
+
+    /**
+     * Fixed body of a catalog. The strings are null-terminated views, that are owned by the string pool of the catalog,
+     * the DescriptionInterner or static tables, so copies of a body are cheap
+     */
     struct FixedBody {
-        std::string Name;
-        std::string Designation;
-        std::string Description;
+        std::string_view Name{ "" };
+        std::string_view Designation{ "" };
+        std::string_view AbbreviatedDescription{ "" };
         Constellation Const;
         f64 Dimension;
         f64 Magnitude;
@@ -48,9 +65,36 @@ namespace ephemeris {
          * @return precessed position
          */
         Equatorial GetEquatorialPosition(const DateTime& dateTime) const noexcept;
+
+        /**
+         * Computes the precessed equatorial position of the fixed body with the equinox of date
+         * @param instant Instant for computation
+         * @return precessed position
+         */
+        Equatorial GetEquatorialPosition(const Instant& instant) const noexcept;
+
+        /**
+         * Computes the precessed position of the fixed body with the equinox of date
+         * @param julianCenturies Time in julian centuries since J2000
+         * @return precessed position as rectangular coordinates
+         */
+        Vector3 GetEquatorialVector(f64 julianCenturies) const noexcept;
+
+        /**
+         * Expands the abbreviated description, which happens only once for equal descriptions
+         * @return expanded description
+         */
+        const std::string& GetDescription() const noexcept;
     };
 
     const char* ClassificationToString(Classification classification) noexcept;
+
+    /**
+     * Looks up the classification of a code of the NGC2000 catalog
+     * @param code Code without leading spaces, e.g. `Gx`, `C+N` or `D*`
+     * @return classification, or nothing if the code is unknown
+     */
+    std::optional<Classification> ClassificationFromCode(std::string_view code) noexcept;
 }// namespace ephemeris
 
 #endif// LIBENGINE_EPHEMERIS_FIXEDBODY_H
\ No newline at end of file
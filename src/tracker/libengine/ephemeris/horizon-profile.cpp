@@ -0,0 +1,134 @@
+#include <algorithm>
+
+#include "../math.hpp"
+#include "horizon-profile.hpp"
+#include "utility/conversion.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Interpolates the profile linearly, the last point is followed by the first one
+         * @param points Points by ascending azimuth in [0, 360)
+         * @param azimuth Azimuth in [0, 360)
+         * @return altitude in degrees
+         */
+        f64 Interpolate(const std::vector<HorizonProfile::Point>& points, f64 azimuth) noexcept {
+            if (points.empty()) {
+                return 0.0;
+            }
+            const auto upper = std::upper_bound(
+                    points.begin(), points.end(), azimuth,
+                    [](f64 value, const HorizonProfile::Point& point) { return value < point.Azimuth; });
+            const auto& next = upper == points.end() ? points.front() : *upper;
+            const auto& previous = upper == points.begin() ? points.back() : *(upper - 1);
+
+            const auto span = math::Mod(next.Azimuth - previous.Azimuth, 360.0);
+            if (span == 0.0) {
+                return previous.Altitude;
+            }
+            const auto offset = math::Mod(azimuth - previous.Azimuth, 360.0);
+            return previous.Altitude + (next.Altitude - previous.Altitude) * offset / span;
+        }
+
+        /**
+         * Strips the comment and the surrounding white space of a line
+         * @param line Line
+         * @return content
+         */
+        std::string_view Content(std::string_view line) noexcept {
+            line = line.substr(0, line.find('#'));
+            const auto begin = line.find_first_not_of(" \t\r");
+            if (begin == std::string_view::npos) {
+                return {};
+            }
+            return line.substr(begin, line.find_last_not_of(" \t\r") - begin + 1);
+        }
+    }// namespace
+
+    HorizonProfile::HorizonProfile() noexcept : HorizonProfile(std::vector<Point>{}) { }
+
+    HorizonProfile::HorizonProfile(std::vector<Point> profile) noexcept : points(std::move(profile)) {
+        for (auto& point : points) {
+            point.Azimuth = math::Mod(point.Azimuth, 360.0);
+            point.Altitude = std::clamp(point.Altitude, -90.0, 90.0);
+        }
+        std::stable_sort(points.begin(), points.end(),
+                         [](const Point& a, const Point& b) { return a.Azimuth < b.Azimuth; });
+
+        // Each entry holds the horizon in the direction of the center of its section of the diamond
+        lowest = 90.0;
+        highest = -90.0;
+        for (usize entry = 0; entry < Resolution; ++entry) {
+            const auto diamond = (static_cast<f64>(entry) + 0.5) / static_cast<f64>(Resolution / 4);
+            const auto cosine = diamond < 2.0 ? 1.0 - diamond : diamond - 3.0;
+            const auto sine = diamond < 2.0 ? 1.0 - std::fabs(cosine) : std::fabs(cosine) - 1.0;
+            const auto azimuth = math::Mod(math::ArcTangent2(sine, cosine), 360.0);
+            altitudes[entry] = Interpolate(points, azimuth);
+            sines[entry] = math::Sine(altitudes[entry]);
+            lowest = std::min(lowest, altitudes[entry]);
+            highest = std::max(highest, altitudes[entry]);
+        }
+    }
+
+    std::optional<HorizonProfile> HorizonProfile::Parse(std::string_view data) noexcept {
+        std::vector<std::string_view> lines{};
+        utility::Split(lines, data, "\n"sv);
+
+        std::vector<Point> parsed{};
+        for (const auto line : lines) {
+            const auto content = Content(line);
+            if (content.empty()) {
+                continue;
+            }
+
+            const auto separator = content.find_first_of(" \t");
+            if (separator == std::string_view::npos) {
+                return {};
+            }
+            const auto azimuth = utility::FromString<f64>(content.substr(0, separator));
+            const auto altitude = utility::FromString<f64>(Content(content.substr(separator)));
+            if (!azimuth || !altitude) {
+                return {};
+            }
+            parsed.push_back({ *azimuth, *altitude });
+        }
+        if (parsed.empty()) {
+            return {};
+        }
+        return HorizonProfile{ std::move(parsed) };
+    }
+
+    f64 HorizonProfile::Altitude(f64 azimuth) const noexcept {
+        return altitudes[Entry(-math::Cosine(azimuth), -math::Sine(azimuth))];
+    }
+
+    f64 HorizonProfile::Lowest() const noexcept {
+        return lowest;
+    }
+
+    f64 HorizonProfile::Highest() const noexcept {
+        return highest;
+    }
+
+    const std::vector<HorizonProfile::Point>& HorizonProfile::GetPoints() const noexcept {
+        return points;
+    }
+
+    u64 HorizonProfile::Checksum() const noexcept {
+        // 64 bit FNV-1a over the points in ascending order
+        u64 hash = 0xcbf29ce484222325;
+        const auto mix = [&hash](f64 value) {
+            const auto bytes = reinterpret_cast<const u8*>(&value);
+            for (usize byte = 0; byte < sizeof(value); ++byte) {
+                hash = (hash ^ bytes[byte]) * 0x100000001b3;
+            }
+        };
+        for (const auto& point : points) {
+            mix(point.Azimuth);
+            mix(point.Altitude);
+        }
+        return hash;
+    }
+}// namespace ephemeris
@@ -0,0 +1,121 @@
+#ifndef LIBENGINE_EPHEMERIS_HORIZONPROFILE_H
+#define LIBENGINE_EPHEMERIS_HORIZONPROFILE_H
+
+#include <array>
+#include <cmath>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Altitude of the visible horizon as a function of the azimuth, e.g. trees and buildings around a site.
+     * The profile is given by points, that are interpolated linearly and periodically, and is evaluated through a
+     * lookup table. The table is indexed by the diamond angle of the horizontal vector, which is monotonic in the
+     * azimuth but needs neither a trigonometric function nor a division by the length, so that the visibility of a
+     * body costs a single fetch
+     */
+    class HorizonProfile {
+    public:
+        /**
+         * Number of entries of the lookup table, which resolves the azimuth to about a tenth of a degree
+         */
+        static constexpr usize Resolution = 4096;
+
+        struct Point {
+            /** Azimuth in degrees, in the convention of ObserveGeographic */
+            f64 Azimuth;
+            /** Altitude of the horizon in degrees */
+            f64 Altitude;
+        };
+
+    private:
+        std::vector<Point> points{};
+        std::array<f64, Resolution> altitudes{};
+        std::array<f64, Resolution> sines{};
+        f64 lowest{ 0.0 };
+        f64 highest{ 0.0 };
+
+        /**
+         * Computes the entry of the lookup table for a horizontal vector
+         * @param x X component of the horizontal vector, as computed by BodyColumns
+         * @param y Y component of the horizontal vector
+         * @return entry
+         */
+        static usize Entry(f64 x, f64 y) noexcept {
+            // The azimuth is the angle of (-x, -y), which is mapped onto the perimeter of a diamond in [0, 4)
+            const auto norm = std::fabs(x) + std::fabs(y);
+            const auto cosine = norm > 0.0 ? -x / norm : 1.0;
+            const auto diamond = y <= 0.0 ? 1.0 - cosine : 3.0 + cosine;
+            const auto entry = static_cast<usize>(diamond * static_cast<f64>(Resolution / 4));
+            return entry < Resolution ? entry : Resolution - 1;
+        }
+
+    public:
+        /**
+         * @brief Flat horizon at an altitude of zero
+         */
+        HorizonProfile() noexcept;
+
+        /**
+         * @brief Builds the lookup table from the points
+         * @param points Points in any order, an empty profile is flat at an altitude of zero
+         */
+        explicit HorizonProfile(std::vector<Point> points) noexcept;
+
+        /**
+         * @brief Parses a profile, one point per line as azimuth and altitude in degrees, separated by white space.
+         * Empty lines and everything after a `#` are ignored
+         * @param data Data of the profile
+         * @return profile, or nothing if a line is malformed or there is no point
+         */
+        static std::optional<HorizonProfile> Parse(std::string_view data) noexcept;
+
+        /**
+         * @brief Altitude of the horizon at an azimuth
+         * @param azimuth Azimuth in degrees
+         * @return altitude in degrees
+         */
+        f64 Altitude(f64 azimuth) const noexcept;
+
+        /**
+         * @brief Sine of the altitude of the horizon in the direction of a horizontal vector, which is compared
+         * against the z component of the unit vector
+         * @param x X component of the horizontal vector, as computed by BodyColumns
+         * @param y Y component of the horizontal vector
+         * @return sine of the altitude
+         */
+        f64 SineAltitude(f64 x, f64 y) const noexcept {
+            return sines[Entry(x, y)];
+        }
+
+        /**
+         * @brief Lowest altitude of the horizon
+         * @return altitude in degrees
+         */
+        f64 Lowest() const noexcept;
+
+        /**
+         * @brief Highest altitude of the horizon
+         * @return altitude in degrees
+         */
+        f64 Highest() const noexcept;
+
+        /**
+         * @brief Retrieves the points of the profile
+         * @return points by ascending azimuth
+         */
+        const std::vector<Point>& GetPoints() const noexcept;
+
+        /**
+         * @brief Checksum of the points, which identifies the profile in precomputed data
+         * @return checksum
+         */
+        u64 Checksum() const noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_HORIZONPROFILE_H
@@ -0,0 +1,321 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "../math.hpp"
+#include "planet-cache.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Limit of intervals per planet, which covers more than twenty years
+         */
+        constexpr usize MaximumSegments = 1024;
+
+        using Coefficients = std::array<f64, PlanetCacheCoefficients>;
+        using Segment = PlanetCacheSegment;
+
+        struct Request {
+            Planet Body;
+            s64 Index;
+            u64 Generation;
+        };
+
+        /**
+         * State of the cache, the destructor stops the worker before the state is torn down
+         */
+        struct CacheState {
+            std::atomic<bool> Enabled{ false };
+            std::atomic<f64> MaximumError{ 0.0 };
+
+            /**
+             * Incremented by Clear, fits of an older generation are discarded
+             */
+            std::atomic<u64> Generation{ 0 };
+
+            std::shared_mutex SegmentMutex;
+            std::map<std::string, std::unordered_map<s64, Segment>, std::less<>> Segments;
+
+            std::mutex QueueMutex;
+            std::condition_variable QueueCondition;
+            std::condition_variable IdleCondition;
+            std::deque<Request> Queue;
+            std::set<std::pair<std::string, s64>> Pending;
+            std::thread Worker;
+            bool Busy{ false };
+            bool Stop{ false };
+
+            ~CacheState() {
+                {
+                    std::unique_lock lock(QueueMutex);
+                    Stop = true;
+                }
+                QueueCondition.notify_all();
+                if (Worker.joinable()) {
+                    Worker.join();
+                }
+            }
+        };
+
+        CacheState& GetState() noexcept {
+            static CacheState state;
+            return state;
+        }
+
+        /**
+         * Maps the time to the chebyshev domain [-1, 1] of its interval
+         * @param julianCenturies Time
+         * @param index Index of the interval
+         * @return time in the chebyshev domain
+         */
+        f64 ToDomain(f64 julianCenturies, s64 index) noexcept {
+            const auto begin = static_cast<f64>(index) * PlanetCacheInterval;
+            return 2.0 * (julianCenturies - begin) / PlanetCacheInterval - 1.0;
+        }
+
+        /**
+         * Evaluates a chebyshev series with the clenshaw recurrence
+         * @param coefficients Coefficients
+         * @param x Time in the chebyshev domain
+         * @return value
+         */
+        f64 Evaluate(const Coefficients& coefficients, f64 x) noexcept {
+            auto b1 = 0.0;
+            auto b2 = 0.0;
+            for (auto j = PlanetCacheCoefficients - 1; j > 0; --j) {
+                const auto b0 = 2.0 * x * b1 - b2 + coefficients[j];
+                b2 = b1;
+                b1 = b0;
+            }
+            return x * b1 - b2 + coefficients[0];
+        }
+
+        Vector3 Evaluate(const Segment& segment, f64 x) noexcept {
+            return { Evaluate(segment.Axes[0], x), Evaluate(segment.Axes[1], x), Evaluate(segment.Axes[2], x) };
+        }
+
+        /**
+         * Fits the interval of the planet at the chebyshev nodes and verifies the fit in between the nodes
+         * @param planet Planet
+         * @param index Index of the interval
+         * @return fitted segment
+         */
+        Segment Fit(const Planet& planet, s64 index) noexcept {
+            constexpr auto n = static_cast<f64>(PlanetCacheCoefficients);
+            const auto begin = static_cast<f64>(index) * PlanetCacheInterval;
+            const auto toCenturies = [begin](f64 x) { return begin + (x + 1.0) * 0.5 * PlanetCacheInterval; };
+
+            std::array<Vector3, PlanetCacheCoefficients> samples{};
+            for (usize k = 0; k < PlanetCacheCoefficients; ++k) {
+                const auto node = std::cos(math::PI * (static_cast<f64>(k) + 0.5) / n);
+                samples[k] = planet.ComputeEclipticVector(toCenturies(node));
+            }
+
+            Segment segment{};
+            for (usize j = 0; j < PlanetCacheCoefficients; ++j) {
+                Vector3 sum{};
+                for (usize k = 0; k < PlanetCacheCoefficients; ++k) {
+                    const auto weight = std::cos(math::PI * static_cast<f64>(j) * (static_cast<f64>(k) + 0.5) / n);
+                    sum = sum + Vector3{ weight * samples[k].X, weight * samples[k].Y, weight * samples[k].Z };
+                }
+                const auto scale = (j == 0 ? 1.0 : 2.0) / n;
+                segment.Axes[0][j] = scale * sum.X;
+                segment.Axes[1][j] = scale * sum.Y;
+                segment.Axes[2][j] = scale * sum.Z;
+            }
+
+            // The largest deviations of a chebyshev fit are in between the nodes and at the boundaries
+            auto error = 0.0;
+            constexpr usize verificationPoints = 4 * PlanetCacheCoefficients;
+            for (usize i = 0; i <= verificationPoints; ++i) {
+                const auto x = -1.0 + 2.0 * static_cast<f64>(i) / static_cast<f64>(verificationPoints);
+                const auto expected = planet.ComputeEclipticVector(toCenturies(x));
+                const auto difference = (Evaluate(segment, x) - expected).Length() / expected.Length();
+                error = std::max(error, difference);
+            }
+            segment.Usable = error <= PlanetCacheTolerance;
+            if (segment.Usable) {
+                auto& maximum = GetState().MaximumError;
+                auto current = maximum.load();
+                while (error > current && !maximum.compare_exchange_weak(current, error)) { }
+            }
+            return segment;
+        }
+
+        /**
+         * Inserts a fitted interval, unless the cache was cleared since the fit was requested
+         * @param planet Planet
+         * @param index Index of the interval
+         * @param generation Generation of the cache, when the fit was requested
+         * @param segment Fitted segment
+         */
+        void Insert(const Planet& planet, s64 index, u64 generation, const Segment& segment) noexcept {
+            auto& state = GetState();
+            std::unique_lock segmentLock(state.SegmentMutex);
+            if (generation != state.Generation.load()) {
+                return;
+            }
+            auto& segments = state.Segments[planet.Name];
+            if (segments.size() >= MaximumSegments) {
+                segments.clear();
+            }
+            segments[index] = segment;
+        }
+
+        void RunWorker() noexcept {
+            auto& state = GetState();
+            while (true) {
+                std::unique_lock lock(state.QueueMutex);
+                state.QueueCondition.wait(lock, [&state] { return state.Stop || !state.Queue.empty(); });
+                if (state.Stop) {
+                    return;
+                }
+                auto request = std::move(state.Queue.front());
+                state.Queue.pop_front();
+                state.Busy = true;
+                lock.unlock();
+
+                Insert(request.Body, request.Index, request.Generation, Fit(request.Body, request.Index));
+
+                lock.lock();
+                if (request.Generation == state.Generation.load()) {
+                    state.Pending.erase({ request.Body.Name, request.Index });
+                }
+                state.Busy = false;
+                if (state.Queue.empty()) {
+                    state.IdleCondition.notify_all();
+                }
+            }
+        }
+
+        /**
+         * Schedules the interval of the planet, unless it is already scheduled
+         * @param planet Planet
+         * @param index Index of the interval
+         */
+        void Schedule(const Planet& planet, s64 index) noexcept {
+            auto& state = GetState();
+            {
+                std::unique_lock lock(state.QueueMutex);
+                if (!state.Pending.emplace(planet.Name, index).second) {
+                    return;
+                }
+                state.Queue.push_back({ planet, index, state.Generation.load() });
+                if (!state.Worker.joinable()) {
+                    state.Worker = std::thread(RunWorker);
+                }
+            }
+            state.QueueCondition.notify_one();
+        }
+    }// namespace
+
+    void PlanetCache::SetEnabled(bool enabled) noexcept {
+        GetState().Enabled.store(enabled);
+    }
+
+    bool PlanetCache::IsEnabled() noexcept {
+        return GetState().Enabled.load(std::memory_order_relaxed);
+    }
+
+    std::optional<Vector3> PlanetCache::Lookup(const Planet& planet, f64 julianCenturies) noexcept {
+        auto& state = GetState();
+        const auto index = static_cast<s64>(std::floor(julianCenturies / PlanetCacheInterval));
+        const auto x = ToDomain(julianCenturies, index);
+        {
+            std::shared_lock lock(state.SegmentMutex);
+            if (const auto planetIterator = state.Segments.find(planet.Name); planetIterator != state.Segments.end()) {
+                const auto& segments = planetIterator->second;
+                if (const auto segmentIterator = segments.find(index); segmentIterator != segments.end()) {
+                    if (!segmentIterator->second.Usable) {
+                        return {};
+                    }
+
+                    // Time series usually move forward, so the next interval is fitted ahead of time
+                    const auto prefetch = x > 0.5 && segments.find(index + 1) == segments.end();
+                    const auto position = Evaluate(segmentIterator->second, x);
+                    lock.unlock();
+                    if (prefetch) {
+                        Schedule(planet, index + 1);
+                    }
+                    return position;
+                }
+            }
+        }
+        Schedule(planet, index);
+        return {};
+    }
+
+    void PlanetCache::Wait() noexcept {
+        auto& state = GetState();
+        std::unique_lock lock(state.QueueMutex);
+        state.IdleCondition.wait(lock, [&state] { return state.Queue.empty() && !state.Busy; });
+    }
+
+    void PlanetCache::Clear() noexcept {
+        auto& state = GetState();
+        {
+            std::unique_lock lock(state.QueueMutex);
+            state.Queue.clear();
+            state.Pending.clear();
+            ++state.Generation;
+            if (!state.Busy) {
+                state.IdleCondition.notify_all();
+            }
+        }
+        std::unique_lock lock(state.SegmentMutex);
+        state.Segments.clear();
+    }
+
+    f64 PlanetCache::MaximumError() noexcept {
+        return GetState().MaximumError.load();
+    }
+
+    PlanetSpan::PlanetSpan(const Planet& planet, f64 firstCenturies, f64 lastCenturies) noexcept : planet(&planet) {
+        if (!PlanetCache::IsEnabled() || !(firstCenturies <= lastCenturies)) {
+            return;
+        }
+        first = static_cast<s64>(std::floor(firstCenturies / PlanetCacheInterval));
+        const auto last = static_cast<s64>(std::floor(lastCenturies / PlanetCacheInterval));
+        if (last - first >= static_cast<s64>(MaximumSegments)) {
+            return;
+        }
+
+        // A fit only depends on the planet and the interval, so the shared and the own fits are identical
+        auto& state = GetState();
+        const auto generation = state.Generation.load();
+        segments.reserve(static_cast<usize>(last - first + 1));
+        for (auto index = first; index <= last; ++index) {
+            {
+                std::shared_lock lock(state.SegmentMutex);
+                if (const auto planetIterator = state.Segments.find(planet.Name);
+                    planetIterator != state.Segments.end()) {
+                    if (const auto segment = planetIterator->second.find(index);
+                        segment != planetIterator->second.end()) {
+                        segments.emplace_back(segment->second);
+                        continue;
+                    }
+                }
+            }
+            Insert(planet, index, generation, segments.emplace_back(Fit(planet, index)));
+        }
+    }
+
+    Vector3 PlanetSpan::GetEclipticVector(f64 julianCenturies) const noexcept {
+        const auto index = static_cast<s64>(std::floor(julianCenturies / PlanetCacheInterval));
+        if (index >= first && index - first < static_cast<s64>(segments.size())) {
+            const auto& segment = segments[static_cast<usize>(index - first)];
+            if (segment.Usable) {
+                return Evaluate(segment, ToDomain(julianCenturies, index));
+            }
+        }
+        return planet->ComputeEclipticVector(julianCenturies);
+    }
+}// namespace ephemeris
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef LIBENGINE_EPHEMERIS_PLANETCACHE_H
+#define LIBENGINE_EPHEMERIS_PLANETCACHE_H
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "planet.hpp"
+
+namespace ephemeris {
+
+    /**
+     * Length of a cached interval in julian centuries, which is eight days
+     */
+    constexpr f64 PlanetCacheInterval = 8.0 / 36525.0;
+
+    /**
+     * Number of chebyshev coefficients per coordinate and interval
+     */
+    constexpr usize PlanetCacheCoefficients = 14;
+
+    /**
+     * Maximum error of a fitted interval relative to the distance of the planet. 1e-9 corresponds to 0.0002 arc
+     * seconds, so the cache is indistinguishable from the direct computation. Intervals that fail the verification are
+     * never used
+     */
+    constexpr f64 PlanetCacheTolerance = 1e-9;
+
+    /**
+     * Chebyshev polynomials of the three coordinates over one interval
+     */
+    struct PlanetCacheSegment {
+        std::array<std::array<f64, PlanetCacheCoefficients>, 3> Axes;
+        bool Usable;
+    };
+
+    /**
+     * @brief Cache of chebyshev polynomials for the geocentric ecliptic position of the planets. Intervals are fitted
+     * lazily by a background worker, until an interval is ready, the direct computation is used
+     */
+    class PlanetCache {
+    public:
+        /**
+         * @brief Enables or disables the cache, when disabled Planet always uses the direct computation
+         * @param enabled Switch
+         */
+        static void SetEnabled(bool enabled) noexcept;
+
+        /**
+         * @brief Checks if the cache is enabled
+         * @return boolean value
+         */
+        static bool IsEnabled() noexcept;
+
+        /**
+         * @brief Evaluates the cached polynomials of the planet, if the interval is missing, it is scheduled for
+         * fitting. Planets are identified by their name
+         * @param planet Planet
+         * @param julianCenturies Time in julian centuries since J2000
+         * @return geocentric ecliptic position, or nothing if the interval is not fitted yet
+         */
+        static std::optional<Vector3> Lookup(const Planet& planet, f64 julianCenturies) noexcept;
+
+        /**
+         * @brief Blocks until all scheduled intervals are fitted
+         */
+        static void Wait() noexcept;
+
+        /**
+         * @brief Drops all fitted and scheduled intervals, e.g. when the planets were imported again. Intervals, that
+         * are being fitted while the cache is cleared, are discarded
+         */
+        static void Clear() noexcept;
+
+        /**
+         * @brief Largest error relative to the distance, that was measured during the verification of an accepted
+         * interval
+         * @return relative error
+         */
+        static f64 MaximumError() noexcept;
+    };
+
+    /**
+     * @brief Positions of a planet over a span of time, whose intervals are all fitted when the span is created, on
+     * the calling thread if the worker has not fitted them yet. Every time in the span is thereby decided up front to
+     * use either its polynomial, or the direct computation if the interval failed the verification or the cache is
+     * disabled, so that time series do not depend on the progress of the worker
+     */
+    class PlanetSpan {
+    private:
+        const Planet* planet{ nullptr };
+        s64 first{ 0 };
+        std::vector<PlanetCacheSegment> segments{};
+
+    public:
+        /**
+         * @brief Fits the intervals of the span, a span that is empty or longer than the cache holds uses the direct
+         * computation throughout
+         * @param planet Planet, which has to outlive the span
+         * @param firstCenturies First time of the span in julian centuries since J2000
+         * @param lastCenturies Last time of the span in julian centuries since J2000
+         */
+        PlanetSpan(const Planet& planet, f64 firstCenturies, f64 lastCenturies) noexcept;
+
+        /**
+         * @brief Computes the geocentric position of the planet in the J2000 ecliptic frame, times outside of the span
+         * use the direct computation
+         * @param julianCenturies Time in julian centuries since J2000
+         * @return the computed rectangular ecliptic coordinates in au
+         */
+        Vector3 GetEclipticVector(f64 julianCenturies) const noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_PLANETCACHE_H
@@ -2,6 +2,7 @@
 
 #include "coordinates.hpp"
 #include "libengine/math.hpp"
+#include "planet-cache.hpp"
 #include "planet.hpp"
 
 namespace ephemeris {
@@ -25,6 +26,29 @@ namespace ephemeris {
             return eccentricAnomaly;
         }
 
+        /**
+         * Rotates a position in the orbital plane to ecliptic coordinates, which is the product of the rotations
+         * Rz(ascendingNode) * Rx(inclination) * Rz(perihelion) applied to a vector without z component
+         * @param orbit Position in the orbital plane
+         * @param ascendingNode Longitude of the ascending node in degrees
+         * @param inclination Inclination in degrees
+         * @param perihelion Argument of the perihelion in degrees
+         * @return ecliptic position
+         */
+        Vector3 OrbitToEcliptic(const Vector3& orbit, f64 ascendingNode, f64 inclination, f64 perihelion) noexcept {
+            const auto cosPerihelion = math::Cosine(perihelion);
+            const auto sinPerihelion = math::Sine(perihelion);
+            const auto cosNode = math::Cosine(ascendingNode);
+            const auto sinNode = math::Sine(ascendingNode);
+            const auto cosInclination = math::Cosine(inclination);
+            const auto sinInclination = math::Sine(inclination);
+
+            const auto u = orbit.X * cosPerihelion - orbit.Y * sinPerihelion;
+            const auto v = orbit.X * sinPerihelion + orbit.Y * cosPerihelion;
+            return { u * cosNode - v * cosInclination * sinNode, u * sinNode + v * cosInclination * cosNode,
+                     v * sinInclination };
+        }
+
         Vector3 PositionOfEarth(f64 julianCenturies) noexcept {
             // The EM-Barycenter kepler elements are hardcoded because they are needed for every computation
             Elements meanEarth{};
@@ -48,45 +72,162 @@ namespace ephemeris {
 
             return RotationMatrix(RotationAxis::Z, w) * positionInOrbit;
         }
+
+        /**
+         * Solves the kepler equation for several orbits at once, every orbit performs exactly the iterations of
+         * EccentricAnomaly, so the results are identical
+         * @param meanAnomalies Mean anomalies in degrees
+         * @param eccentricities Eccentricities
+         * @param eccentricAnomalies Receives the eccentric anomalies in degrees
+         */
+        void EccentricAnomalies(const std::vector<f64>& meanAnomalies,
+                                const std::vector<f64>& eccentricities,
+                                std::vector<f64>& eccentricAnomalies) noexcept {
+            const auto count = meanAnomalies.size();
+            eccentricAnomalies.resize(count);
+            std::vector<u8> converged(count, 0);
+            for (usize index = 0; index < count; ++index) {
+                const auto eccentricityDegrees = math::Degrees(eccentricities[index]);
+                eccentricAnomalies[index] =
+                        meanAnomalies[index] + eccentricityDegrees * math::Sine(meanAnomalies[index]);
+            }
+
+            for (usize iteration = 0; iteration < 10; ++iteration) {
+                auto pending = false;
+                for (usize index = 0; index < count; ++index) {
+                    if (converged[index]) {
+                        continue;
+                    }
+                    const auto eccentricityDegrees = math::Degrees(eccentricities[index]);
+                    const auto eccentricAnomaly = eccentricAnomalies[index];
+                    const auto dm = meanAnomalies[index] -
+                                    (eccentricAnomaly - eccentricityDegrees * math::Sine(eccentricAnomaly));
+                    const auto deltaEccentric = dm / (1 - eccentricities[index] * math::Cosine(eccentricAnomaly));
+                    eccentricAnomalies[index] += deltaEccentric;
+                    converged[index] = math::Abs(deltaEccentric) > 1.0E-12 ? 0 : 1;
+                    pending = pending || !converged[index];
+                }
+                if (!pending) {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * Computes the mean kepler elements of the planet
+         * @param planet Planet
+         * @param julianCenturies Time in julian centuries since J2000
+         * @return elements at the time
+         */
+        Elements MeanElements(const Planet& planet, f64 julianCenturies) noexcept {
+            const auto t = julianCenturies;
+            Elements meanKeplerElem{};
+            meanKeplerElem.SemiMajorAxis = planet.Orbit.SemiMajorAxis + planet.Rate.SemiMajorAxis * t;
+            meanKeplerElem.Eccentricity = planet.Orbit.Eccentricity + planet.Rate.Eccentricity * t;
+            meanKeplerElem.Inclination = planet.Orbit.Inclination + planet.Rate.Inclination * t;
+            meanKeplerElem.MeanLongitude = planet.Orbit.MeanLongitude + planet.Rate.MeanLongitude * t;
+            meanKeplerElem.LonPerihelion = planet.Orbit.LonPerihelion + planet.Rate.LonPerihelion * t;
+            meanKeplerElem.LonAscendingNode = planet.Orbit.LonAscendingNode + planet.Rate.LonAscendingNode * t;
+            return meanKeplerElem;
+        }
+
+        /**
+         * Heliocentric ecliptic position from the mean elements and the solved eccentric anomaly
+         * @param elements Mean elements
+         * @param eccentricAnomaly Eccentric anomaly in degrees
+         * @return heliocentric ecliptic position in au
+         */
+        Vector3 HeliocentricPosition(const Elements& elements, f64 eccentricAnomaly) noexcept {
+            const auto a = elements.SemiMajorAxis;
+            const auto e = elements.Eccentricity;
+            Vector3 positionInOrbit{};
+            positionInOrbit.X = a * (math::Cosine(eccentricAnomaly) - e);
+            positionInOrbit.Y = a * std::sqrt(1 - e * e) * math::Sine(eccentricAnomaly);
+            positionInOrbit.Z = 0;
+            return OrbitToEcliptic(positionInOrbit, elements.LonAscendingNode, elements.Inclination,
+                                   elements.LonPerihelion - elements.LonAscendingNode);
+        }
     }// namespace
 
     Equatorial Planet::GetEquatorialPosition(const DateTime& date) const noexcept {
-        const auto t = DateTime::JulianCenturies(date);
-
-        Elements meanKeplerElem{};
-        meanKeplerElem.SemiMajorAxis = Orbit.SemiMajorAxis + Rate.SemiMajorAxis * t;
-        meanKeplerElem.Eccentricity = Orbit.Eccentricity + Rate.Eccentricity * t;
-        meanKeplerElem.Inclination = Orbit.Inclination + Rate.Inclination * t;
-        meanKeplerElem.MeanLongitude = Orbit.MeanLongitude + Rate.MeanLongitude * t;
-        meanKeplerElem.LonPerihelion = Orbit.LonPerihelion + Rate.LonPerihelion * t;
-        meanKeplerElem.LonAscendingNode = Orbit.LonAscendingNode + Rate.LonAscendingNode * t;
-
-        const auto a = meanKeplerElem.SemiMajorAxis;
-        const auto e = meanKeplerElem.Eccentricity;
-        const auto w = meanKeplerElem.LonPerihelion;
-        const auto Om = meanKeplerElem.LonAscendingNode;
-        const auto L = meanKeplerElem.MeanLongitude;
-        const auto I = meanKeplerElem.Inclination;
-
-        // compute argument of perihelion and mean anomaly
-        const auto perihelion = w - Om;
-        const auto M = math::Mod(L - w, 360.0);
-
-        // compute eccentric anomaly
-        const auto E = EccentricAnomaly(M, e);
-
-        // true anomaly
-        Vector3 positionInOrbit{};
-        positionInOrbit.X = a * (math::Cosine(E) - e);
-        positionInOrbit.Y = a * std::sqrt(1 - e * e) * math::Sine(E);
-        positionInOrbit.Z = 0;
-
-        const auto helioEcliptic = RotationMatrix(RotationAxis::Z, Om) * RotationMatrix(RotationAxis::X, I) *
-                                   RotationMatrix(RotationAxis::Z, perihelion) * positionInOrbit;
-
-        const auto geoEcliptic = helioEcliptic - PositionOfEarth(t);
-        const auto geoEquatorial =
-                ReferencePlaneMatrix(ReferencePlane::Ecliptic, ReferencePlane::Equatorial, 0) * geoEcliptic;
-        return VectorToEquatorial(PrecessionMatrix(ReferencePlane::Equatorial, 0, t) * geoEquatorial);
+        return VectorToEquatorial(GetEquatorialVector(DateTime::JulianCenturies(date)));
+    }
+
+    Equatorial Planet::GetEquatorialPosition(const Instant& instant) const noexcept {
+        return VectorToEquatorial(GetEquatorialVector(instant.JulianCenturies()));
+    }
+
+    Vector3 Planet::GetEquatorialVector(f64 julianCenturies) const noexcept {
+        return TransformMatrix(EpochTransform::EclipticJ2000, julianCenturies) * GetEclipticVector(julianCenturies);
+    }
+
+    Vector3 Planet::GetEclipticVector(f64 julianCenturies) const noexcept {
+        if (PlanetCache::IsEnabled()) {
+            if (const auto cached = PlanetCache::Lookup(*this, julianCenturies)) {
+                return *cached;
+            }
+        }
+        return ComputeEclipticVector(julianCenturies);
+    }
+
+    Vector3 Planet::ComputeEclipticVector(f64 julianCenturies) const noexcept {
+        const auto elements = MeanElements(*this, julianCenturies);
+
+        // compute mean anomaly and eccentric anomaly
+        const auto M = math::Mod(elements.MeanLongitude - elements.LonPerihelion, 360.0);
+        const auto E = EccentricAnomaly(M, elements.Eccentricity);
+        return HeliocentricPosition(elements, E) - PositionOfEarth(julianCenturies);
+    }
+
+    SolarSystemSnapshot::SolarSystemSnapshot(const std::vector<std::shared_ptr<Planet>>& planets,
+                                             const Instant& utc) noexcept
+        : instant(utc) {
+        const auto t = utc.JulianCenturies();
+        const auto count = planets.size();
+
+        std::vector<Elements> elements{};
+        std::vector<f64> meanAnomalies{};
+        std::vector<f64> eccentricities{};
+        std::vector<f64> eccentricAnomalies{};
+        elements.reserve(count);
+        meanAnomalies.reserve(count);
+        eccentricities.reserve(count);
+        for (const auto& planet : planets) {
+            const auto& current = elements.emplace_back(MeanElements(*planet, t));
+            meanAnomalies.emplace_back(math::Mod(current.MeanLongitude - current.LonPerihelion, 360.0));
+            eccentricities.emplace_back(current.Eccentricity);
+            this->planets.emplace_back(planet.get());
+        }
+        EccentricAnomalies(meanAnomalies, eccentricities, eccentricAnomalies);
+
+        // The earth and the transformation to the equator of date are shared by all planets
+        const auto earth = PositionOfEarth(t);
+        auto transform = TransformMatrix(EpochTransform::EclipticJ2000, t);
+        positions.reserve(count);
+        for (usize index = 0; index < count; ++index) {
+            const auto geoEcliptic = HeliocentricPosition(elements[index], eccentricAnomalies[index]) - earth;
+            positions.emplace_back(VectorToEquatorial(transform * geoEcliptic));
+        }
+    }
+
+    const Instant& SolarSystemSnapshot::GetInstant() const noexcept {
+        return instant;
+    }
+
+    usize SolarSystemSnapshot::Size() const noexcept {
+        return positions.size();
+    }
+
+    const Equatorial& SolarSystemSnapshot::GetEquatorialPosition(usize index) const noexcept {
+        return positions[index];
+    }
+
+    std::optional<Equatorial> SolarSystemSnapshot::Find(const Planet& planet) const noexcept {
+        for (usize index = 0; index < planets.size(); ++index) {
+            if (planets[index] == &planet) {
+                return positions[index];
+            }
+        }
+        return {};
     }
 }// namespace ephemeris
\ No newline at end of file
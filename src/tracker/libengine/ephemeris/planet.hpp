@@ -1,6 +1,10 @@
 #ifndef LIBENGINE_EPHEMERIS_PLANET_H
 #define LIBENGINE_EPHEMERIS_PLANET_H
 
+#include <memory>
+#include <optional>
+#include <vector>
+
 #include "coordinates.hpp"
 
 namespace ephemeris {
@@ -25,6 +29,83 @@ namespace ephemeris {
          * @return the computed equatorial coordinates
          */
         Equatorial GetEquatorialPosition(const DateTime& date) const noexcept;
+
+        /**
+         * @brief Computes the equatorial position of the planet
+         * @param instant instant for the computation
+         * @return the computed equatorial coordinates
+         */
+        Equatorial GetEquatorialPosition(const Instant& instant) const noexcept;
+
+        /**
+         * @brief Computes the geocentric position of the planet with the equinox of date
+         * @param julianCenturies Time in julian centuries since J2000
+         * @return the computed rectangular equatorial coordinates in au
+         */
+        Vector3 GetEquatorialVector(f64 julianCenturies) const noexcept;
+
+        /**
+         * @brief Computes the geocentric position of the planet in the J2000 ecliptic frame, which is taken from the
+         * PlanetCache when it is enabled
+         * @param julianCenturies Time in julian centuries since J2000
+         * @return the computed rectangular ecliptic coordinates in au
+         */
+        Vector3 GetEclipticVector(f64 julianCenturies) const noexcept;
+
+        /**
+         * @brief Computes the geocentric position of the planet in the J2000 ecliptic frame from the kepler elements,
+         * bypassing the PlanetCache
+         * @param julianCenturies Time in julian centuries since J2000
+         * @return the computed rectangular ecliptic coordinates in au
+         */
+        Vector3 ComputeEclipticVector(f64 julianCenturies) const noexcept;
+    };
+
+    /**
+     * @brief Geocentric positions of several planets at one instant. The earth is computed once and the kepler
+     * equations of all planets are solved together over contiguous arrays
+     */
+    class SolarSystemSnapshot {
+    private:
+        Instant instant{};
+        std::vector<const Planet*> planets{};
+        std::vector<Equatorial> positions{};
+
+    public:
+        SolarSystemSnapshot() noexcept = default;
+
+        /**
+         * @brief Computes the positions of the planets
+         * @param planets Planets, which have to outlive the snapshot
+         * @param utc Instant in utc
+         */
+        SolarSystemSnapshot(const std::vector<std::shared_ptr<Planet>>& planets, const Instant& utc) noexcept;
+
+        /**
+         * @brief Instant of the snapshot
+         * @return instant in utc
+         */
+        const Instant& GetInstant() const noexcept;
+
+        /**
+         * @brief Number of planets in the snapshot
+         * @return size
+         */
+        usize Size() const noexcept;
+
+        /**
+         * @brief Equatorial position of the planet at the index, in the order the planets were passed
+         * @param index Index of the planet
+         * @return the computed equatorial coordinates
+         */
+        const Equatorial& GetEquatorialPosition(usize index) const noexcept;
+
+        /**
+         * @brief Equatorial position of the planet
+         * @param planet Planet that was passed to the snapshot
+         * @return the computed equatorial coordinates, or nothing if the planet is not part of the snapshot
+         */
+        std::optional<Equatorial> Find(const Planet& planet) const noexcept;
     };
 }// namespace ephemeris
 
@@ -0,0 +1,516 @@
+#include <fmt/format.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+
+#include "../math.hpp"
+#include "query.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Compares two values
+         * @param left Left operand, which is NaN for a missing attribute
+         * @param comparison Comparison
+         * @param right Right operand
+         * @return boolean value, which is false for any comparison with a missing attribute
+         */
+        bool Compare(f64 left, Query::Comparison comparison, f64 right) noexcept {
+            if (std::isnan(left)) {
+                return false;
+            }
+            switch (comparison) {
+                case Query::Comparison::Less:
+                    return left < right;
+                case Query::Comparison::LessEqual:
+                    return left <= right;
+                case Query::Comparison::Greater:
+                    return left > right;
+                case Query::Comparison::GreaterEqual:
+                    return left >= right;
+                case Query::Comparison::Equal:
+                    return left == right;
+                case Query::Comparison::NotEqual:
+                    return left != right;
+            }
+            return false;
+        }
+
+        /**
+         * Reads a numeric attribute of a body
+         * @param body FixedBody
+         * @param field Field, except for the altitude
+         * @return value, or NaN if the catalog does not list it. A magnitude of zero means that it is missing, as in
+         * the magnitude sort order
+         */
+        f64 FieldValue(const FixedBody& body, Query::Field field) noexcept {
+            switch (field) {
+                case Query::Field::Magnitude:
+                    return body.Magnitude != 0.0 ? body.Magnitude : std::numeric_limits<f64>::quiet_NaN();
+                case Query::Field::Dimension:
+                    return body.Dimension;
+                case Query::Field::RightAscension:
+                    return body.Position.RightAscension;
+                case Query::Field::Declination:
+                    return body.Position.Declination;
+                case Query::Field::Altitude:
+                    break;
+            }
+            return 0.0;
+        }
+
+        /**
+         * Removes the hits from the selection
+         * @param selection Ascending indices
+         * @param hits Ascending subset of the selection
+         * @return ascending indices of the selection, that are no hits
+         */
+        std::vector<u32> Difference(const std::vector<u32>& selection, const std::vector<u32>& hits) noexcept {
+            std::vector<u32> difference{};
+            difference.reserve(selection.size() - hits.size());
+            std::set_difference(selection.begin(), selection.end(), hits.begin(), hits.end(),
+                                std::back_inserter(difference));
+            return difference;
+        }
+
+        /**
+         * Maximum nesting of negations and parentheses, which bounds the recursion of the parser and the evaluation
+         */
+        constexpr usize MaximumNesting = 64;
+    }// namespace
+
+    /**
+     * @brief Recursive descent parser, that appends the nodes of the program in post-order
+     */
+    class Query::Parser {
+    private:
+        std::string_view text;
+        usize position{ 0 };
+        usize nesting{ 0 };
+        std::vector<Node>& nodes;
+        std::string error{};
+
+        /**
+         * Skips whitespace
+         */
+        void SkipSpace() noexcept {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+                ++position;
+            }
+        }
+
+        /**
+         * Consumes the token, if it is next
+         * @param token Token
+         * @return true if the token was consumed
+         */
+        bool Accept(std::string_view token) noexcept {
+            SkipSpace();
+            if (text.compare(position, token.size(), token) == 0) {
+                position += token.size();
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * Consumes the next word of letters
+         * @return word, which is empty if the next character is no letter
+         */
+        std::string_view Word() noexcept {
+            SkipSpace();
+            const auto begin = position;
+            while (position < text.size() && std::isalpha(static_cast<unsigned char>(text[position]))) {
+                ++position;
+            }
+            return text.substr(begin, position - begin);
+        }
+
+        /**
+         * Records the first error
+         * @param message Description
+         * @return nothing
+         */
+        std::nullopt_t Fail(std::string_view message) noexcept {
+            if (error.empty()) {
+                error = fmt::format("{} at position {}", message, position);
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Appends a node
+         * @param node Node
+         * @return index of the node
+         */
+        u32 Add(Node node) noexcept {
+            nodes.emplace_back(std::move(node));
+            return static_cast<u32>(nodes.size() - 1);
+        }
+
+        /**
+         * Parses a chain of operands, that are combined by the same operator
+         * @param kind And or Or
+         * @param separator Operator token
+         * @param operand Parser of an operand
+         * @return index of the node
+         */
+        template<typename OperandParser>
+        std::optional<u32> Chain(Kind kind, std::string_view separator, OperandParser operand) noexcept {
+            const auto first = operand();
+            if (!first || !Accept(separator)) {
+                return first;
+            }
+
+            Node chain{};
+            chain.Type = kind;
+            chain.Children.emplace_back(*first);
+            do {
+                const auto next = operand();
+                if (!next) {
+                    return std::nullopt;
+                }
+                chain.Children.emplace_back(*next);
+            } while (Accept(separator));
+            return Add(std::move(chain));
+        }
+
+        std::optional<u32> Conjunction() noexcept {
+            return Chain(Kind::And, "&&"sv, [this] { return Unary(); });
+        }
+
+        std::optional<u32> Unary() noexcept {
+            if (nesting >= MaximumNesting) {
+                return Fail("Expression nested too deeply");
+            }
+            ++nesting;
+            const auto unary = Nested();
+            --nesting;
+            return unary;
+        }
+
+        std::optional<u32> Nested() noexcept {
+            if (Accept("!"sv)) {
+                const auto operand = Unary();
+                if (!operand) {
+                    return std::nullopt;
+                }
+                Node negation{};
+                negation.Type = Kind::Not;
+                negation.Children.emplace_back(*operand);
+                return Add(std::move(negation));
+            }
+            if (Accept("("sv)) {
+                const auto inner = Expression();
+                if (!inner) {
+                    return std::nullopt;
+                }
+                if (!Accept(")"sv)) {
+                    return Fail("Expected ')'");
+                }
+                return inner;
+            }
+            return Predicate();
+        }
+
+        std::optional<u32> Predicate() noexcept {
+            SkipSpace();
+            const auto begin = position;
+            const auto name = Word();
+
+            Node predicate{};
+            if (name == "type" || name == "const") {
+                if (Word() != "in") {
+                    return Fail("Expected 'in'");
+                }
+                if (!Accept("{"sv)) {
+                    return Fail("Expected '{'");
+                }
+
+                ClassificationMask classifications{};
+                ConstellationMask constellations{};
+                do {
+                    SkipSpace();
+                    const auto itemBegin = position;
+                    while (position < text.size() && text[position] != ',' && text[position] != '}') {
+                        ++position;
+                    }
+                    auto item = text.substr(itemBegin, position - itemBegin);
+                    while (!item.empty() && std::isspace(static_cast<unsigned char>(item.back()))) {
+                        item.remove_suffix(1);
+                    }
+
+                    if (name == "type") {
+                        // The catalog leaves the type of unidentified bodies empty, which can not be written as an item
+                        const auto classification = item == "Unidentified" ? Classification::Unidentified
+                                                                           : ClassificationFromCode(item);
+                        if (!classification || item.empty()) {
+                            return Fail(fmt::format("Unknown type '{}'", item));
+                        }
+                        classifications.set(static_cast<usize>(*classification));
+                    } else {
+                        const auto constellation = FindConstellation(item);
+                        if (constellation == UnknownConstellation) {
+                            return Fail(fmt::format("Unknown constellation '{}'", item));
+                        }
+                        constellations.set(constellation);
+                    }
+                } while (Accept(","sv));
+                if (!Accept("}"sv)) {
+                    return Fail("Expected '}'");
+                }
+
+                predicate.Type = Kind::Attribute;
+                predicate.Accepted = AttributeMask::Accepting(classifications, constellations);
+                predicate.Cost = AttributeCost;
+            } else {
+                if (name == "mag") {
+                    predicate.Column = Field::Magnitude;
+                } else if (name == "dim") {
+                    predicate.Column = Field::Dimension;
+                } else if (name == "ra") {
+                    predicate.Column = Field::RightAscension;
+                } else if (name == "dec") {
+                    predicate.Column = Field::Declination;
+                } else if (name == "alt") {
+                    if (!Accept("("sv) || Word() != "now" || !Accept(")"sv)) {
+                        return Fail("Expected 'alt(now)'");
+                    }
+                    predicate.Column = Field::Altitude;
+                } else {
+                    return Fail(fmt::format("Unknown field '{}'", name));
+                }
+
+                // Two character comparisons come first, so that they are not mistaken for their prefixes
+                constexpr std::array<std::pair<std::string_view, Comparison>, 6> comparisons = { {
+                    { "<=", Comparison::LessEqual },
+                    { ">=", Comparison::GreaterEqual },
+                    { "==", Comparison::Equal },
+                    { "!=", Comparison::NotEqual },
+                    { "<", Comparison::Less },
+                    { ">", Comparison::Greater },
+                } };
+                const auto comparison = std::find_if(comparisons.begin(), comparisons.end(),
+                                                     [this](const auto& entry) { return Accept(entry.first); });
+                if (comparison == comparisons.end()) {
+                    return Fail("Expected a comparison");
+                }
+                predicate.Operator = comparison->second;
+
+                SkipSpace();
+                const auto conversion = std::from_chars(text.data() + position, text.data() + text.size(),
+                                                        predicate.Value);
+                if (conversion.ec != std::errc()) {
+                    return Fail("Expected a number");
+                }
+                position = static_cast<usize>(conversion.ptr - text.data());
+
+                predicate.Type = Kind::Compare;
+                predicate.Cost = predicate.Column == Field::Altitude ? EphemerisCost : AttributeCost;
+            }
+
+            predicate.Text = std::string{ text.substr(begin, position - begin) };
+            return Add(std::move(predicate));
+        }
+
+    public:
+        Parser(std::string_view text, std::vector<Node>& nodes) noexcept : text{ text }, nodes{ nodes } { }
+
+        std::optional<u32> Expression() noexcept {
+            return Chain(Kind::Or, "||"sv, [this] { return Conjunction(); });
+        }
+
+        /**
+         * Parses the whole text
+         * @return index of the root node
+         */
+        std::optional<u32> Parse() noexcept {
+            const auto root = Expression();
+            if (!root) {
+                return std::nullopt;
+            }
+            SkipSpace();
+            if (position != text.size()) {
+                return Fail("Unexpected input");
+            }
+            return root;
+        }
+
+        /**
+         * Sums up the costs and orders the operands of each node by their cost, the order of equally expensive
+         * operands is kept
+         * @param node Index of the node
+         */
+        void Order(u32 node) noexcept {
+            if (nodes[node].Type == Kind::Compare || nodes[node].Type == Kind::Attribute) {
+                return;
+            }
+
+            auto& children = nodes[node].Children;
+            for (const auto child : children) {
+                Order(child);
+            }
+            std::stable_sort(children.begin(), children.end(),
+                             [this](u32 left, u32 right) { return nodes[left].Cost < nodes[right].Cost; });
+
+            nodes[node].Cost = 0;
+            for (const auto child : children) {
+                nodes[node].Cost += nodes[child].Cost;
+            }
+        }
+
+        const std::string& Error() const noexcept {
+            return error;
+        }
+    };
+
+    std::optional<Query> Query::Parse(std::string_view expression, std::string* error) noexcept {
+        Query query{};
+        Parser parser{ expression, query.nodes };
+        const auto root = parser.Parse();
+        if (!root) {
+            if (error != nullptr) {
+                *error = parser.Error();
+            }
+            return std::nullopt;
+        }
+
+        parser.Order(*root);
+        query.root = *root;
+        return query;
+    }
+
+    std::vector<u32> Query::Evaluate(const Columns& columns,
+                                     const Matrix3x3& horizon,
+                                     std::vector<u32> selection,
+                                     std::vector<Step>* profile) const noexcept {
+        if (nodes.empty()) {
+            return selection;
+        }
+        return EvaluateNode(root, columns, horizon, std::move(selection), profile);
+    }
+
+    std::vector<u32> Query::EvaluateNode(u32 index,
+                                         const Columns& columns,
+                                         const Matrix3x3& horizon,
+                                         std::vector<u32> selection,
+                                         std::vector<Step>* profile) const noexcept {
+        const auto& node = nodes[index];
+        switch (node.Type) {
+            case Kind::And: {
+                for (const auto child : node.Children) {
+                    if (selection.empty()) {
+                        break;
+                    }
+                    selection = EvaluateNode(child, columns, horizon, std::move(selection), profile);
+                }
+                return selection;
+            }
+            case Kind::Or: {
+                // Each operand only sees the bodies, that no cheaper operand has matched yet
+                std::vector<u32> matched{};
+                for (const auto child : node.Children) {
+                    if (selection.empty()) {
+                        break;
+                    }
+                    const auto hits = EvaluateNode(child, columns, horizon, selection, profile);
+                    std::vector<u32> merged{};
+                    merged.reserve(matched.size() + hits.size());
+                    std::merge(matched.begin(), matched.end(), hits.begin(), hits.end(), std::back_inserter(merged));
+                    matched.swap(merged);
+                    selection = Difference(selection, hits);
+                }
+                return matched;
+            }
+            case Kind::Not: {
+                const auto hits = EvaluateNode(node.Children.front(), columns, horizon, selection, profile);
+                return Difference(selection, hits);
+            }
+            case Kind::Compare:
+            case Kind::Attribute:
+                break;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<u32> result{};
+        result.reserve(selection.size());
+        if (node.Type == Kind::Attribute) {
+            for (const auto body : selection) {
+                if (columns.Attributes[body].AcceptedBy(node.Accepted)) {
+                    result.emplace_back(body);
+                }
+            }
+        } else if (node.Column == Field::Altitude) {
+            // The sine is monotonic in the altitude, so the threshold is compared against the sine directly
+            std::vector<f64> sines{};
+            columns.Positions.SineAltitudes(horizon, selection, sines);
+            const auto threshold = math::Sine(std::clamp(node.Value, -90.0, 90.0));
+            for (usize selected = 0; selected < selection.size(); ++selected) {
+                if (Compare(sines[selected], node.Operator, threshold)) {
+                    result.emplace_back(selection[selected]);
+                }
+            }
+        } else {
+            for (const auto body : selection) {
+                if (Compare(FieldValue(columns.Bodies[body], node.Column), node.Operator, node.Value)) {
+                    result.emplace_back(body);
+                }
+            }
+        }
+
+        if (profile != nullptr) {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            profile->push_back({ node.Text, selection.size(), result.size(),
+                                 std::chrono::duration<f64, std::milli>(elapsed).count() });
+        }
+        return result;
+    }
+
+    bool Query::DependsOnEphemeris() const noexcept {
+        return std::any_of(nodes.begin(), nodes.end(), [](const Node& node) {
+            return node.Type == Kind::Compare && node.Column == Field::Altitude;
+        });
+    }
+
+    std::string Query::Plan() const noexcept {
+        std::string plan{};
+        if (!nodes.empty()) {
+            PlanNode(root, 0, plan);
+        }
+        return plan;
+    }
+
+    void Query::PlanNode(u32 index, usize depth, std::string& plan) const noexcept {
+        const auto& node = nodes[index];
+        const auto label = std::invoke([&node]() -> std::string {
+            switch (node.Type) {
+                case Kind::And:
+                    return "and";
+                case Kind::Or:
+                    return "or";
+                case Kind::Not:
+                    return "not";
+                case Kind::Compare:
+                    if (node.Column == Field::Altitude) {
+                        return fmt::format("ephemeris {}", node.Text);
+                    }
+                    [[fallthrough]];
+                case Kind::Attribute:
+                    return fmt::format("attribute {}", node.Text);
+            }
+            return "";
+        });
+
+        fmt::format_to(std::back_inserter(plan), "{:{}}{} (cost {})\n", "", depth * 2, label, node.Cost);
+        for (const auto child : node.Children) {
+            PlanNode(child, depth + 1, plan);
+        }
+    }
+}// namespace ephemeris
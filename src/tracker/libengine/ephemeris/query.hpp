@@ -0,0 +1,147 @@
+#ifndef LIBENGINE_EPHEMERIS_QUERY_H
+#define LIBENGINE_EPHEMERIS_QUERY_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "attribute-mask.hpp"
+#include "body-columns.hpp"
+#include "fixed-body.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Predicate over fixed bodies, that is parsed once from an expression like
+     * `mag < 10 && dim > 5 && type in {Gx, Pl} && alt(now) > 30` into a flat program. The program is evaluated one
+     * predicate at a time over a selection of the catalog, and the operands of conjunctions and disjunctions are
+     * ordered by their cost, so that cheap attribute predicates shrink the selection before ephemeris predicates run
+     *
+     * expression  := conjunction { "||" conjunction }
+     * conjunction := unary { "&&" unary }
+     * unary       := "!" unary | "(" expression ")" | predicate
+     * predicate   := field comparison number | set "in" "{" item { "," item } "}"
+     * field       := "mag" | "dim" | "ra" | "dec" | "alt(now)"
+     * comparison  := "<" | "<=" | ">" | ">=" | "==" | "!="
+     * set         := "type" | "const"
+     *
+     * Types are codes of the NGC2000 catalog (Gx, OC, Gb, Nb, Pl, C+N, Ast, Kt, ***, D*, *, ?, -, PD), or
+     * Unidentified for bodies without a code. Constellations are abbreviations. Right ascension and declination are
+     * the catalog positions in degrees, the altitude is in degrees above the horizon of the observer. Bodies without a
+     * listed magnitude fail every magnitude comparison
+     */
+    class Query {
+    public:
+        enum class Field { Magnitude, Dimension, RightAscension, Declination, Altitude };
+
+        enum class Comparison { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+        /**
+         * @brief Columns of a catalog, that the predicates are evaluated on, all indexed by the index of the handle
+         */
+        struct Columns {
+            const std::vector<FixedBody>& Bodies;
+            const std::vector<AttributeMask>& Attributes;
+            const BodyColumns& Positions;
+        };
+
+        /**
+         * @brief Measurement of one predicate during an evaluation
+         */
+        struct Step {
+            std::string Predicate;
+            usize Input;
+            usize Output;
+            f64 Milliseconds;
+        };
+
+    private:
+        class Parser;
+
+        enum class Kind { Compare, Attribute, And, Or, Not };
+
+        struct Node {
+            Kind Type{ Kind::Compare };
+            Field Column{ Field::Magnitude };
+            Comparison Operator{ Comparison::Equal };
+            f64 Value{ 0.0 };
+            AttributeMask Accepted{};
+            std::string Text{};
+            std::vector<u32> Children{};
+            u32 Cost{ 0 };
+        };
+
+        std::vector<Node> nodes{};
+        u32 root{ 0 };
+
+        /**
+         * Evaluates a node over a selection
+         * @param node Index of the node
+         * @param columns Columns of the catalog
+         * @param horizon Matrix obtained by BodyColumns::HorizontalMatrix
+         * @param selection Ascending indices
+         * @param profile Receives the measurements of the predicates, if not nullptr
+         * @return ascending indices of the selected bodies, that satisfy the node
+         */
+        std::vector<u32> EvaluateNode(u32 node,
+                                      const Columns& columns,
+                                      const Matrix3x3& horizon,
+                                      std::vector<u32> selection,
+                                      std::vector<Step>* profile) const noexcept;
+
+        /**
+         * Appends the plan of a node
+         * @param node Index of the node
+         * @param depth Indentation depth
+         * @param plan Target
+         */
+        void PlanNode(u32 node, usize depth, std::string& plan) const noexcept;
+
+    public:
+        /**
+         * Cost of a predicate on a column of the catalog
+         */
+        static constexpr u32 AttributeCost = 1;
+
+        /**
+         * Cost of a predicate, that transforms the position of each body into the horizon of the observer
+         */
+        static constexpr u32 EphemerisCost = 16;
+
+        /**
+         * @brief Parses an expression, negations and parentheses may be nested 64 levels deep
+         * @param expression Expression
+         * @param error Receives a description of the first error, if not nullptr
+         * @return query, or nothing if the expression is malformed
+         */
+        static std::optional<Query> Parse(std::string_view expression, std::string* error = nullptr) noexcept;
+
+        /**
+         * @brief Evaluates the query over a selection of the catalog
+         * @param columns Columns of the catalog
+         * @param horizon Matrix obtained by BodyColumns::HorizontalMatrix, for the ephemeris predicates
+         * @param selection Ascending indices of the bodies, that are evaluated
+         * @param profile Receives the measurements of the predicates in the order of their evaluation, if not nullptr
+         * @return ascending indices of the selected bodies, that satisfy the query
+         */
+        std::vector<u32> Evaluate(const Columns& columns,
+                                  const Matrix3x3& horizon,
+                                  std::vector<u32> selection,
+                                  std::vector<Step>* profile = nullptr) const noexcept;
+
+        /**
+         * @brief Checks if the query contains an ephemeris predicate, whose result depends on time and observer
+         * @return boolean value
+         */
+        bool DependsOnEphemeris() const noexcept;
+
+        /**
+         * @brief Describes the program in the order of evaluation, one line per node with its cost
+         * @return plan
+         */
+        std::string Plan() const noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_QUERY_H
@@ -0,0 +1,325 @@
+#include <algorithm>
+#include <optional>
+
+#include "../clock.hpp"
+#include "../math.hpp"
+#include "rise-set.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Rate of the mean sidereal time in degrees per day, as in Clock::GreenwichMeanSiderealTime
+         */
+        constexpr f64 SiderealRate = 360.0 * 1.0027379093;
+
+        /**
+         * Tolerance of the refined events in days, which is one second
+         */
+        constexpr f64 EventTolerance = 1.0 / 86400.0;
+
+        Instant OffsetInstant(const Instant& begin, f64 days) noexcept {
+            auto instant = begin;
+            return instant.AddNanoseconds(std::llround(days * static_cast<f64>(Instant::NanosecondsPerDay)));
+        }
+
+        f64 DurationDays(const RiseSetInfo& info) noexcept {
+            return static_cast<f64>(info.End - info.Begin) / static_cast<f64>(Instant::NanosecondsPerDay);
+        }
+
+        /**
+         * Finds the root of the function in the bracket [a, b] with brent's method
+         * @tparam Function Callable of signature f64(f64)
+         * @param function Function
+         * @param a Lower bound
+         * @param b Upper bound
+         * @param fa Value at the lower bound
+         * @param fb Value at the upper bound, the sign has to differ from fa
+         * @return root
+         */
+        template<typename Function>
+        f64 FindRoot(Function&& function, f64 a, f64 b, f64 fa, f64 fb) noexcept {
+            auto c = b;
+            auto fc = fb;
+            auto d = b - a;
+            auto e = d;
+            for (usize iteration = 0; iteration < 64; ++iteration) {
+                if ((fb > 0.0 && fc > 0.0) || (fb < 0.0 && fc < 0.0)) {
+                    c = a;
+                    fc = fa;
+                    d = b - a;
+                    e = d;
+                }
+                if (std::fabs(fc) < std::fabs(fb)) {
+                    a = b;
+                    b = c;
+                    c = a;
+                    fa = fb;
+                    fb = fc;
+                    fc = fa;
+                }
+                const auto tolerance = 0.5 * EventTolerance;
+                const auto middle = 0.5 * (c - b);
+                if (std::fabs(middle) <= tolerance || fb == 0.0) {
+                    return b;
+                }
+                if (std::fabs(e) >= tolerance && std::fabs(fa) > std::fabs(fb)) {
+                    // Inverse quadratic interpolation, or the secant method if only two points are distinct
+                    const auto s = fb / fa;
+                    auto p = 0.0;
+                    auto q = 0.0;
+                    if (a == c) {
+                        p = 2.0 * middle * s;
+                        q = 1.0 - s;
+                    } else {
+                        const auto r = fb / fc;
+                        const auto t = fa / fc;
+                        p = s * (2.0 * middle * t * (t - r) - (b - a) * (r - 1.0));
+                        q = (t - 1.0) * (r - 1.0) * (s - 1.0);
+                    }
+                    if (p > 0.0) {
+                        q = -q;
+                    }
+                    p = std::fabs(p);
+                    if (2.0 * p < std::min(3.0 * middle * q - std::fabs(tolerance * q), std::fabs(e * q))) {
+                        e = d;
+                        d = p / q;
+                    } else {
+                        d = middle;
+                        e = d;
+                    }
+                } else {
+                    d = middle;
+                    e = d;
+                }
+                a = b;
+                fa = fb;
+                b += std::fabs(d) > tolerance ? d : std::copysign(tolerance, middle);
+                fb = function(b);
+            }
+            return b;
+        }
+
+        /**
+         * Finds the maximum of a unimodal function in [a, b] with a golden-section search
+         * @tparam Function Callable of signature f64(f64)
+         * @param function Function
+         * @param a Lower bound
+         * @param b Upper bound
+         * @return location of the maximum
+         */
+        template<typename Function>
+        f64 FindMaximum(Function&& function, f64 a, f64 b) noexcept {
+            constexpr auto ratio = 0.6180339887498949;
+            auto x1 = b - ratio * (b - a);
+            auto x2 = a + ratio * (b - a);
+            auto f1 = function(x1);
+            auto f2 = function(x2);
+            while (b - a > EventTolerance) {
+                if (f1 < f2) {
+                    a = x1;
+                    x1 = x2;
+                    f1 = f2;
+                    x2 = a + ratio * (b - a);
+                    f2 = function(x2);
+                } else {
+                    b = x2;
+                    x2 = x1;
+                    f2 = f1;
+                    x1 = b - ratio * (b - a);
+                    f1 = function(x1);
+                }
+            }
+            return 0.5 * (a + b);
+        }
+
+        /**
+         * Altitude, that a body has to exceed in a direction
+         * @param info Search window and horizon
+         * @param azimuth Azimuth in degrees
+         * @return altitude in degrees
+         */
+        f64 RequiredAltitude(const RiseSetInfo& info, f64 azimuth) noexcept {
+            if (info.Horizon == nullptr) {
+                return info.AltitudeThreshold;
+            }
+            return std::max(info.AltitudeThreshold, info.Horizon->Altitude(azimuth));
+        }
+
+        /**
+         * Samples the position with the search step to bracket the events. Rise and set are refined with brent's
+         * method on the altitude above the required one, the culmination with a golden-section search on the altitude
+         * itself, so that it is the highest point of the path regardless of the horizon
+         * @tparam Function Callable of signature Horizontal(f64), that returns the position at an offset in days from
+         * the beginning of the window
+         * @param observe Function
+         * @param info Search window and horizon
+         * @param result Receives the events, the windows and the kind of passage
+         */
+        template<typename Function>
+        void SearchEvents(Function&& observe, const RiseSetInfo& info, RiseSetResult& result) noexcept {
+            const auto clearance = [&info](const Horizontal& horizontal) {
+                return horizontal.Altitude - RequiredAltitude(info, horizontal.Azimuth);
+            };
+            const auto aboveRequired = [&](f64 days) { return clearance(observe(days)); };
+            const auto altitude = [&](f64 days) { return observe(days).Altitude; };
+
+            const auto duration = DurationDays(info);
+            const auto step = std::max(info.SearchStepSeconds, 60.0) / 86400.0;
+            const auto count = static_cast<usize>(std::ceil(duration / step)) + 1;
+            std::vector<f64> times(count);
+            std::vector<f64> samples(count);
+            std::vector<f64> altitudes(count);
+            for (usize index = 0; index < count; ++index) {
+                times[index] = std::min(static_cast<f64>(index) * step, duration);
+                const auto horizontal = observe(times[index]);
+                samples[index] = clearance(horizontal);
+                altitudes[index] = horizontal.Altitude;
+            }
+
+            auto windowBegin = samples.front() >= 0.0 ? std::optional<f64>{ 0.0 } : std::nullopt;
+            for (usize index = 1; index < count; ++index) {
+                const auto previous = samples[index - 1];
+                const auto current = samples[index];
+                if ((previous < 0.0) != (current < 0.0)) {
+                    const auto event = FindRoot(aboveRequired, times[index - 1], times[index], previous, current);
+                    if (previous < 0.0) {
+                        result.Rises.emplace_back(OffsetInstant(info.Begin, event));
+                        windowBegin = event;
+                    } else {
+                        result.Sets.emplace_back(OffsetInstant(info.Begin, event));
+                        result.Windows.push_back({ OffsetInstant(info.Begin, windowBegin.value_or(0.0)),
+                                                   OffsetInstant(info.Begin, event) });
+                        windowBegin.reset();
+                    }
+                }
+
+                // A local maximum of the sampled altitudes brackets the culmination
+                if (index + 1 < count && altitudes[index] >= altitudes[index - 1] &&
+                    altitudes[index] > altitudes[index + 1]) {
+                    const auto culmination = FindMaximum(altitude, times[index - 1], times[index + 1]);
+                    result.Culminations.emplace_back(OffsetInstant(info.Begin, culmination));
+                }
+            }
+            if (windowBegin) {
+                result.Windows.push_back({ OffsetInstant(info.Begin, *windowBegin), info.End });
+            }
+
+            if (result.Rises.empty() && result.Sets.empty()) {
+                result.Kind = samples.front() >= 0.0 ? Passage::Circumpolar : Passage::NeverRises;
+            }
+        }
+    }// namespace
+
+    RiseSetInfo::RiseSetInfo() noexcept
+        : Begin(Instant::Now()),
+          End(Instant::Now().AddSeconds(86400)),
+          Observer({ 0.0, 0.0 }),
+          AltitudeThreshold(0.0),
+          SearchStepSeconds(3600.0),
+          Horizon(nullptr) { }
+
+    RiseSetResult ComputeRiseSet(const FixedBody& body, const RiseSetInfo& info) noexcept {
+        RiseSetResult result{};
+        result.Kind = Passage::Regular;
+        result.Evaluations = 1;
+
+        const auto duration = DurationDays(info);
+        if (duration <= 0.0) {
+            return result;
+        }
+
+        const auto middle = OffsetInstant(info.Begin, 0.5 * duration);
+        if (info.Horizon != nullptr) {
+            result.Evaluations = 0;
+            const ObserverFrame frame{ info.Observer };
+            const auto julianMidnight = info.Begin.JulianMidnight();
+            const auto dayFraction = info.Begin.DayFraction();
+            const auto vector = body.GetEquatorialVector(middle.JulianCenturies());
+            const auto observe = [&](f64 days) {
+                ++result.Evaluations;
+                const auto siderealTime = Clock::GreenwichMeanSiderealTime(julianMidnight, dayFraction + days);
+                return ObserveFrame(vector, siderealTime, frame);
+            };
+            SearchEvents(observe, info, result);
+            return result;
+        }
+
+        const auto position = VectorToEquatorial(body.GetEquatorialVector(middle.JulianCenturies()));
+        const auto localSiderealTime =
+                Clock::GreenwichMeanSiderealTime(info.Begin.JulianMidnight(), info.Begin.DayFraction()) +
+                info.Observer.Longitude;
+
+        // Hour angle at which the body crosses the threshold, cos(H0) outside of [-1, 1] means it never does
+        const auto cosHourAngle = (math::Sine(info.AltitudeThreshold) -
+                                   math::Sine(info.Observer.Latitude) * math::Sine(position.Declination)) /
+                                  (math::Cosine(info.Observer.Latitude) * math::Cosine(position.Declination));
+        if (cosHourAngle < -1.0) {
+            result.Kind = Passage::Circumpolar;
+        } else if (cosHourAngle > 1.0) {
+            result.Kind = Passage::NeverRises;
+        }
+
+        // Upper transits are at an hour angle of zero, k indexes the transits relative to the first one in the window
+        const auto siderealDay = 360.0 / SiderealRate;
+        const auto firstTransit = math::Mod(position.RightAscension - localSiderealTime, 360.0) / SiderealRate;
+        const auto semiArc = result.Kind == Passage::Regular ? math::ArcCosine(cosHourAngle) / SiderealRate : 0.0;
+        for (s64 k = -1;; ++k) {
+            const auto transit = firstTransit + static_cast<f64>(k) * siderealDay;
+            if (transit - semiArc > duration) {
+                break;
+            }
+            if (transit >= 0.0 && transit <= duration) {
+                result.Culminations.emplace_back(OffsetInstant(info.Begin, transit));
+            }
+            if (result.Kind != Passage::Regular) {
+                continue;
+            }
+
+            const auto rise = transit - semiArc;
+            const auto set = transit + semiArc;
+            if (rise >= 0.0 && rise <= duration) {
+                result.Rises.emplace_back(OffsetInstant(info.Begin, rise));
+            }
+            if (set >= 0.0 && set <= duration) {
+                result.Sets.emplace_back(OffsetInstant(info.Begin, set));
+            }
+            if (set >= 0.0 && rise <= duration) {
+                result.Windows.push_back({ OffsetInstant(info.Begin, std::max(rise, 0.0)),
+                                           OffsetInstant(info.Begin, std::min(set, duration)) });
+            }
+        }
+
+        if (result.Kind == Passage::Circumpolar) {
+            result.Windows.push_back({ info.Begin, info.End });
+        }
+        return result;
+    }
+
+    RiseSetResult ComputeRiseSet(const Planet& planet, const RiseSetInfo& info) noexcept {
+        RiseSetResult result{};
+        result.Kind = Passage::Regular;
+        result.Evaluations = 0;
+
+        const auto duration = DurationDays(info);
+        if (duration <= 0.0) {
+            return result;
+        }
+
+        // Position at an offset in days from the beginning of the window
+        const ObserverFrame frame{ info.Observer };
+        const auto julianMidnight = info.Begin.JulianMidnight();
+        const auto dayFraction = info.Begin.DayFraction();
+        const auto julianCenturies = info.Begin.JulianCenturies();
+        const auto observe = [&](f64 days) {
+            ++result.Evaluations;
+            const auto position = planet.GetEquatorialVector(julianCenturies + days / 36525.0);
+            const auto siderealTime = Clock::GreenwichMeanSiderealTime(julianMidnight, dayFraction + days);
+            return ObserveFrame(position, siderealTime, frame);
+        };
+
+        SearchEvents(observe, info, result);
+        return result;
+    }
+}// namespace ephemeris
@@ -0,0 +1,79 @@
+#ifndef LIBENGINE_EPHEMERIS_RISESET_H
+#define LIBENGINE_EPHEMERIS_RISESET_H
+
+#include <memory>
+#include <vector>
+
+#include "coordinates.hpp"
+#include "fixed-body.hpp"
+#include "horizon-profile.hpp"
+#include "planet.hpp"
+
+namespace ephemeris {
+
+    /**
+     * Describes the time window and the horizon for the search of rise, culmination and set
+     */
+    struct RiseSetInfo {
+        Instant Begin;
+        Instant End;
+        Geographic Observer;
+        f64 AltitudeThreshold;
+        f64 SearchStepSeconds;
+
+        /**
+         * Horizon, that the body has to be above in addition to the threshold, or nullptr for a flat horizon
+         */
+        std::shared_ptr<const HorizonProfile> Horizon;
+
+        RiseSetInfo() noexcept;
+    };
+
+    /**
+     * Interval in which a body is at or above the altitude threshold
+     */
+    struct TimeWindow {
+        Instant Begin;
+        Instant End;
+    };
+
+    enum class Passage {
+        /** The body crosses the threshold */
+        Regular,
+        /** The body stays above the threshold for the whole search window */
+        Circumpolar,
+        /** The body stays below the threshold for the whole search window */
+        NeverRises
+    };
+
+    struct RiseSetResult {
+        Passage Kind;
+        std::vector<Instant> Rises;
+        std::vector<Instant> Culminations;
+        std::vector<Instant> Sets;
+        std::vector<TimeWindow> Windows;
+        usize Evaluations;
+    };
+
+    /**
+     * Finds rise, culmination and set of the fixed body with the closed-form hour angle. The position is precessed to
+     * the middle of the search window, which is accurate to a fraction of a second for windows of several weeks. With
+     * a horizon profile, the threshold depends on the azimuth and the events are searched like the ones of a planet
+     * @param body FixedBody
+     * @param info Search window, the instants are expected to be in utc
+     * @return events and visibility windows, all in utc
+     */
+    RiseSetResult ComputeRiseSet(const FixedBody& body, const RiseSetInfo& info) noexcept;
+
+    /**
+     * Finds rise, culmination and set of the planet. The altitude is sampled with the search step to bracket the
+     * events, which are then refined with brent's method, respectively a golden-section search for the culmination.
+     * Events that are closer to each other than the search step might be missed
+     * @param planet Planet
+     * @param info Search window, the instants are expected to be in utc
+     * @return events and visibility windows, all in utc
+     */
+    RiseSetResult ComputeRiseSet(const Planet& planet, const RiseSetInfo& info) noexcept;
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_RISESET_H
@@ -0,0 +1,43 @@
+#include <cstring>
+
+#include "string-pool.hpp"
+
+namespace ephemeris {
+
+    std::string_view StringPool::Store(std::string_view string) noexcept {
+        const auto required = string.size() + 1;
+        char* target = nullptr;
+        if (required > BlockSize) {
+            // The current block stays the one, that regular strings are appended to
+            auto block = std::make_unique<char[]>(required);
+            target = block.get();
+            blocks.insert(blocks.end() - (blocks.empty() ? 0 : 1), std::move(block));
+        } else {
+            if (blocks.empty() || capacity - used < required) {
+                blocks.emplace_back(std::make_unique<char[]>(BlockSize));
+                used = 0;
+                capacity = BlockSize;
+            }
+            target = blocks.back().get() + used;
+            used += required;
+        }
+
+        std::memcpy(target, string.data(), string.size());
+        target[string.size()] = '\0';
+        return { target, string.size() };
+    }
+
+    void StringPool::Adopt(StringPool&& other) noexcept {
+        // The remaining space of the adopted blocks is abandoned, and the current block stays the last one
+        const auto position = blocks.empty() ? blocks.end() : blocks.end() - 1;
+        blocks.insert(position, std::make_move_iterator(other.blocks.begin()),
+                      std::make_move_iterator(other.blocks.end()));
+        other.Clear();
+    }
+
+    void StringPool::Clear() noexcept {
+        blocks.clear();
+        used = 0;
+        capacity = 0;
+    }
+}// namespace ephemeris
@@ -0,0 +1,55 @@
+#ifndef LIBENGINE_EPHEMERIS_STRINGPOOL_H
+#define LIBENGINE_EPHEMERIS_STRINGPOOL_H
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Append-only storage of strings in large blocks. Stored strings are never moved, so their views stay valid
+     * until the pool is cleared or destroyed. Every string is followed by a null character, which means that the data
+     * of a view can be passed as a C string
+     */
+    class StringPool {
+    private:
+        std::vector<std::unique_ptr<char[]>> blocks{};
+        usize used{ 0 };
+        usize capacity{ 0 };
+
+    public:
+        /**
+         * Size of a regular block, longer strings get a block of their own
+         */
+        static constexpr usize BlockSize = 64 * 1024;
+
+        StringPool() noexcept = default;
+        StringPool(StringPool&&) noexcept = default;
+        StringPool& operator=(StringPool&&) noexcept = default;
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        /**
+         * @brief Copies the string into the pool
+         * @param string String
+         * @return view of the stored string
+         */
+        std::string_view Store(std::string_view string) noexcept;
+
+        /**
+         * @brief Takes over the blocks of another pool, the views into the other pool stay valid
+         * @param other Pool, that is empty afterwards
+         */
+        void Adopt(StringPool&& other) noexcept;
+
+        /**
+         * @brief Releases all blocks, which invalidates every view into the pool
+         */
+        void Clear() noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_STRINGPOOL_H
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+#include "trigram-index.hpp"
+
+namespace ephemeris {
+
+    namespace {
+
+        /**
+         * Packs three folded characters into one key
+         * @param text Text of at least three characters
+         * @return key
+         */
+        u32 Trigram(const char* text) noexcept {
+            return static_cast<u32>(static_cast<u8>(TrigramIndex::Fold(text[0]))) << 16u |
+                   static_cast<u32>(static_cast<u8>(TrigramIndex::Fold(text[1]))) << 8u |
+                   static_cast<u32>(static_cast<u8>(TrigramIndex::Fold(text[2])));
+        }
+
+        /**
+         * Appends the trigrams of the text
+         * @param text Text
+         * @param trigrams Target
+         */
+        void CollectTrigrams(std::string_view text, std::vector<u32>& trigrams) noexcept {
+            for (usize index = 0; index + 3 <= text.size(); ++index) {
+                trigrams.emplace_back(Trigram(text.data() + index));
+            }
+        }
+    }// namespace
+
+    void TrigramIndex::Build(const std::vector<FixedBody>& bodies) noexcept {
+        postings.clear();
+
+        // Bodies are visited in ascending order, so every posting list is sorted without further effort
+        std::vector<u32> trigrams{};
+        for (usize index = 0; index < bodies.size(); ++index) {
+            trigrams.clear();
+            CollectTrigrams(bodies[index].Name, trigrams);
+            CollectTrigrams(bodies[index].Designation, trigrams);
+            std::sort(trigrams.begin(), trigrams.end());
+            trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+            for (const auto trigram : trigrams) {
+                postings[trigram].emplace_back(static_cast<u32>(index));
+            }
+        }
+    }
+
+    void TrigramIndex::Assign(std::unordered_map<u32, std::vector<u32>>&& lists) noexcept {
+        postings = std::move(lists);
+    }
+
+    const std::unordered_map<u32, std::vector<u32>>& TrigramIndex::GetPostings() const noexcept {
+        return postings;
+    }
+
+    bool TrigramIndex::Candidates(std::string_view term, std::vector<u32>& candidates) const noexcept {
+        candidates.clear();
+        if (term.size() < 3) {
+            return false;
+        }
+
+        std::vector<u32> trigrams{};
+        CollectTrigrams(term, trigrams);
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+        // The lists are intersected from the shortest to the longest, so the candidates shrink as early as possible
+        std::vector<const std::vector<u32>*> lists{};
+        for (const auto trigram : trigrams) {
+            const auto it = postings.find(trigram);
+            if (it == postings.end()) {
+                return true;
+            }
+            lists.emplace_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+        candidates = *lists.front();
+        std::vector<u32> intersection{};
+        for (usize list = 1; list < lists.size() && !candidates.empty(); ++list) {
+            intersection.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), lists[list]->begin(), lists[list]->end(),
+                                  std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+        return true;
+    }
+
+    char TrigramIndex::Fold(char c) noexcept {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+}// namespace ephemeris
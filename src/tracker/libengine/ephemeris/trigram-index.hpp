@@ -0,0 +1,60 @@
+#ifndef LIBENGINE_EPHEMERIS_TRIGRAMINDEX_H
+#define LIBENGINE_EPHEMERIS_TRIGRAMINDEX_H
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "fixed-body.hpp"
+#include "utility/types.hpp"
+
+namespace ephemeris {
+
+    /**
+     * @brief Case-folded inverted index from the trigrams of the names and designations to the indices of the bodies.
+     * A substring query is answered with the intersection of the posting lists of its trigrams, which is a superset of
+     * the matching bodies, that has to be verified by the caller
+     */
+    class TrigramIndex {
+    private:
+        std::unordered_map<u32, std::vector<u32>> postings{};
+
+    public:
+        TrigramIndex() noexcept = default;
+
+        /**
+         * @brief Rebuilds the index
+         * @param bodies Bodies, whose indices are stored in the posting lists
+         */
+        void Build(const std::vector<FixedBody>& bodies) noexcept;
+
+        /**
+         * @brief Takes over posting lists, that were built before for the same bodies
+         * @param lists Ascending body indices by trigram
+         */
+        void Assign(std::unordered_map<u32, std::vector<u32>>&& lists) noexcept;
+
+        /**
+         * @brief Retrieves the posting lists
+         * @return ascending body indices by trigram
+         */
+        const std::unordered_map<u32, std::vector<u32>>& GetPostings() const noexcept;
+
+        /**
+         * @brief Collects the bodies, whose name or designation contain every trigram of the term
+         * @param term Search term
+         * @param candidates Ascending indices of the candidates
+         * @return false if the term is shorter than a trigram, then every body is a candidate
+         */
+        bool Candidates(std::string_view term, std::vector<u32>& candidates) const noexcept;
+
+        /**
+         * @brief Folds the case of a character the same way, as the index does
+         * @param c Character
+         * @return folded character
+         */
+        static char Fold(char c) noexcept;
+    };
+}// namespace ephemeris
+
+#endif// LIBENGINE_EPHEMERIS_TRIGRAMINDEX_H
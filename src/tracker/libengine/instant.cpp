@@ -0,0 +1,182 @@
+#include <chrono>
+#include <cmath>
+
+#include "instant.hpp"
+
+namespace {
+
+    /**
+     * Number of days since 1970-01-01 in the proleptic gregorian calendar
+     * @param year Year
+     * @param month Month [1, 12]
+     * @param day Day, values beyond the end of the month roll over
+     * @return days
+     */
+    constexpr s64 DaysFromCivil(s64 year, s64 month, s64 day) noexcept {
+        year -= month <= 2 ? 1 : 0;
+        const auto era = (year >= 0 ? year : year - 399) / 400;
+        const auto yearOfEra = year - era * 400;
+        const auto dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const auto dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    struct Civil {
+        s64 Year;
+        s64 Month;
+        s64 Day;
+    };
+
+    /**
+     * Inverse of DaysFromCivil
+     * @param days Days since 1970-01-01
+     * @return year, month and day
+     */
+    constexpr Civil CivilFromDays(s64 days) noexcept {
+        days += 719468;
+        const auto era = (days >= 0 ? days : days - 146096) / 146097;
+        const auto dayOfEra = days - era * 146097;
+        const auto yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const auto dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const auto monthIndex = (5 * dayOfYear + 2) / 153;
+        const auto day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        const auto month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        return { yearOfEra + era * 400 + (month <= 2 ? 1 : 0), month, day };
+    }
+
+    /**
+     * Integer division that rounds towards negative infinity
+     */
+    constexpr s64 FloorDivide(s64 a, s64 b) noexcept {
+        const auto quotient = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? quotient - 1 : quotient;
+    }
+
+    // 1970-01-01 00:00:00 and J2000 (2000-01-01 12:00:00) as julian days
+    constexpr f64 JulianDayUnixEpoch = 2440587.5;
+    constexpr s64 DaysUntilJ2000 = 10957;
+}// namespace
+
+Instant Instant::Now() noexcept {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    const auto days = FloorDivide(elapsed, NanosecondsPerDay);
+    return Instant{ days, elapsed - days * NanosecondsPerDay };
+}
+
+Instant Instant::FromDateTime(const DateTime& date) noexcept {
+    Instant instant{ DaysFromCivil(date.Year, date.Month, date.Day), 0 };
+    instant.AddNanoseconds(((date.Hour * 60 + date.Minute) * 60 + date.Second) * NanosecondsPerSecond +
+                           date.Millisecond * 1000000);
+    return instant;
+}
+
+Instant Instant::FromJulianDay(f64 julianDay) noexcept {
+    const auto elapsed = julianDay - JulianDayUnixEpoch;
+    const auto days = std::floor(elapsed);
+    const auto nanoseconds = std::llround((elapsed - days) * static_cast<f64>(NanosecondsPerDay));
+    Instant instant{ static_cast<s64>(days), 0 };
+    instant.AddNanoseconds(nanoseconds);
+    return instant;
+}
+
+DateTime Instant::ToDateTime() const noexcept {
+    const auto [year, month, day] = CivilFromDays(days);
+    const auto seconds = nanoseconds / NanosecondsPerSecond;
+    const auto milliseconds = (nanoseconds % NanosecondsPerSecond) / 1000000;
+    return DateTime{ year, month, day, seconds / 3600, (seconds / 60) % 60, seconds % 60, milliseconds };
+}
+
+f64 Instant::JulianDay() const noexcept {
+    return JulianMidnight() + DayFraction();
+}
+
+f64 Instant::JulianMidnight() const noexcept {
+    return JulianDayUnixEpoch + static_cast<f64>(days);
+}
+
+f64 Instant::DayFraction() const noexcept {
+    return static_cast<f64>(nanoseconds) / static_cast<f64>(NanosecondsPerDay);
+}
+
+f64 Instant::JulianCenturies() const noexcept {
+    // The whole days are subtracted as integers, so that the fraction keeps its precision
+    return (static_cast<f64>(days - DaysUntilJ2000) + (DayFraction() - 0.5)) / 36525.0;
+}
+
+s64 Instant::Unix() const noexcept {
+    return days * 86400 + nanoseconds / NanosecondsPerSecond;
+}
+
+Instant& Instant::AddNanoseconds(s64 amount) noexcept {
+    const auto total = nanoseconds + amount;
+    const auto carry = FloorDivide(total, NanosecondsPerDay);
+    days += carry;
+    nanoseconds = total - carry * NanosecondsPerDay;
+    return *this;
+}
+
+Instant& Instant::AddSeconds(s64 seconds) noexcept {
+    const auto wholeDays = FloorDivide(seconds, 86400);
+    days += wholeDays;
+    return AddNanoseconds((seconds - wholeDays * 86400) * NanosecondsPerSecond);
+}
+
+Instant& Instant::AddMonths(s64 months) noexcept {
+    const auto civil = CivilFromDays(days);
+    const auto monthIndex = civil.Year * 12 + (civil.Month - 1) + months;
+    const auto year = FloorDivide(monthIndex, 12);
+    days = DaysFromCivil(year, monthIndex - year * 12 + 1, civil.Day);
+    return *this;
+}
+
+Instant& Instant::AddYears(s64 years) noexcept {
+    return AddMonths(years * 12);
+}
+
+Instant& Instant::Add(s64 number, DateTime::Unit unit) noexcept {
+    switch (unit) {
+        case DateTime::Unit::Seconds:
+            return AddSeconds(number);
+        case DateTime::Unit::Minutes:
+            return AddSeconds(number * 60);
+        case DateTime::Unit::Hours:
+            return AddSeconds(number * 3600);
+        case DateTime::Unit::Days:
+            days += number;
+            return *this;
+        case DateTime::Unit::Months:
+            return AddMonths(number);
+        case DateTime::Unit::Years:
+            return AddYears(number);
+    }
+    return *this;
+}
+
+s64 operator-(const Instant& left, const Instant& right) noexcept {
+    return (left.days - right.days) * Instant::NanosecondsPerDay + (left.nanoseconds - right.nanoseconds);
+}
+
+bool operator==(const Instant& left, const Instant& right) noexcept {
+    return left.days == right.days && left.nanoseconds == right.nanoseconds;
+}
+
+bool operator!=(const Instant& left, const Instant& right) noexcept {
+    return !(left == right);
+}
+
+bool operator<(const Instant& left, const Instant& right) noexcept {
+    return left.days < right.days || (left.days == right.days && left.nanoseconds < right.nanoseconds);
+}
+
+bool operator<=(const Instant& left, const Instant& right) noexcept {
+    return !(right < left);
+}
+
+bool operator>(const Instant& left, const Instant& right) noexcept {
+    return right < left;
+}
+
+bool operator>=(const Instant& left, const Instant& right) noexcept {
+    return !(left < right);
+}
@@ -0,0 +1,136 @@
+#ifndef LIBENGINE_INSTANT_H
+#define LIBENGINE_INSTANT_H
+
+#include "date-time.hpp"
+#include "utility/types.hpp"
+
+/**
+ * @brief Compact point in time, stored as a split julian day: whole days since 1970-01-01 and the nanoseconds of
+ * that day. Adding and subtracting fixed units is constant time, as there are no calendar fields to normalize.
+ * Instants do not carry a timezone, Instant::Now is in utc and the hot paths of the engine expect utc instants
+ */
+class Instant {
+public:
+    static constexpr s64 NanosecondsPerSecond = 1000000000;
+    static constexpr s64 NanosecondsPerDay = 86400 * NanosecondsPerSecond;
+
+    /**
+     * @brief Creates the instant 1970-01-01 00:00:00
+     */
+    constexpr Instant() noexcept = default;
+
+    /**
+     * @brief Returns the current utc time
+     * @return Instant
+     */
+    static Instant Now() noexcept;
+
+    /**
+     * @brief Converts the calendar fields of the date-time, this is lossless
+     * @param date Date-time
+     * @return Instant
+     */
+    static Instant FromDateTime(const DateTime& date) noexcept;
+
+    /**
+     * @brief Creates an instant from a julian day
+     * @param julianDay Julian day
+     * @return Instant
+     */
+    static Instant FromJulianDay(f64 julianDay) noexcept;
+
+    /**
+     * @brief Converts the instant back to calendar fields
+     * @return Date-time
+     */
+    DateTime ToDateTime() const noexcept;
+
+    /**
+     * @brief Julian day of the instant
+     * @note The proleptic gregorian calendar is used for all dates, unlike DateTime::JulianDayNumber which switches
+     * to the julian calendar before 1582-10-15
+     * @return Julian day
+     */
+    f64 JulianDay() const noexcept;
+
+    /**
+     * @brief Julian day at midnight of the instant, together with DayFraction this forms a two-part julian day
+     * @return Julian day at midnight
+     */
+    f64 JulianMidnight() const noexcept;
+
+    /**
+     * @brief Fraction of the day that has passed since midnight
+     * @return Fraction in [0, 1)
+     */
+    f64 DayFraction() const noexcept;
+
+    /**
+     * @brief Julian centuries since J2000
+     * @return Julian centuries
+     */
+    f64 JulianCenturies() const noexcept;
+
+    /**
+     * @brief Seconds since 1970-01-01 00:00:00
+     * @return Unix timestamp
+     */
+    s64 Unix() const noexcept;
+
+    /**
+     * @brief Adds or subtracts the specified number of nanoseconds
+     * @param nanoseconds Number of nanoseconds
+     * @return Reference to this instant
+     */
+    Instant& AddNanoseconds(s64 nanoseconds) noexcept;
+
+    /**
+     * @brief Adds or subtracts the specified number of seconds
+     * @param seconds Number of seconds
+     * @return Reference to this instant
+     */
+    Instant& AddSeconds(s64 seconds) noexcept;
+
+    /**
+     * @brief Adds or subtracts the specified number of months, this is calendar aware. Days that overflow the
+     * resulting month roll over into the next month, so the 31st of january plus one month is the 3rd of march
+     * @param months Number of months
+     * @return Reference to this instant
+     */
+    Instant& AddMonths(s64 months) noexcept;
+
+    /**
+     * @brief Adds or subtracts the specified number of years, this is calendar aware
+     * @param years Number of years
+     * @return Reference to this instant
+     */
+    Instant& AddYears(s64 years) noexcept;
+
+    /**
+     * @brief Adds or subtracts the specified number of units, only months and years require calendar arithmetic
+     * @param number Number of units
+     * @param unit Unit
+     * @return Reference to this instant
+     */
+    Instant& Add(s64 number, DateTime::Unit unit) noexcept;
+
+    /**
+     * @brief Difference in nanoseconds
+     */
+    friend s64 operator-(const Instant& left, const Instant& right) noexcept;
+
+    friend bool operator==(const Instant& left, const Instant& right) noexcept;
+    friend bool operator!=(const Instant& left, const Instant& right) noexcept;
+    friend bool operator<(const Instant& left, const Instant& right) noexcept;
+    friend bool operator<=(const Instant& left, const Instant& right) noexcept;
+    friend bool operator>(const Instant& left, const Instant& right) noexcept;
+    friend bool operator>=(const Instant& left, const Instant& right) noexcept;
+
+private:
+    constexpr Instant(s64 days, s64 nanoseconds) noexcept : days{ days }, nanoseconds{ nanoseconds } { }
+
+    s64 days{ 0 };
+    s64 nanoseconds{ 0 };
+};
+
+#endif// LIBENGINE_INSTANT_H
@@ -1,12 +1,26 @@
 #ifndef LIBENGINE_H
 #define LIBENGINE_H
 
+#include "clock.hpp"
 #include "date-time.hpp"
 #include "ephemeris/planet.hpp"
+#include "ephemeris/almanac.hpp"
+#include "ephemeris/attribute-mask.hpp"
+#include "ephemeris/body-pipeline.hpp"
 #include "ephemeris/catalog.hpp"
+#include "ephemeris/constellation.hpp"
 #include "ephemeris/coordinates.hpp"
+#include "ephemeris/declination-index.hpp"
+#include "ephemeris/description.hpp"
+#include "ephemeris/filter-cache.hpp"
+#include "ephemeris/horizon-profile.hpp"
 #include "ephemeris/fixed-body.hpp"
 #include "ephemeris/planet.hpp"
+#include "ephemeris/planet-cache.hpp"
+#include "ephemeris/query.hpp"
+#include "ephemeris/rise-set.hpp"
+#include "ephemeris/trigram-index.hpp"
+#include "instant.hpp"
 #include "math.hpp"
 
 #endif// LIBENGINE_H
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <utility>
 
 #include "file.hpp"
 
@@ -13,11 +14,35 @@ namespace arch {
     }
 
     bool WriteFile(const std::filesystem::path& filePath, std::string_view data) noexcept {
-        std::ofstream fileOut{ filePath };
+        std::ofstream fileOut{ filePath, std::ios::binary };
         if (fileOut.is_open()) {
             fileOut.write(data.data(), static_cast<std::streamsize>(data.size()));
             return true;
         }
         return false;
     }
+
+    MappedFile::~MappedFile() noexcept {
+        Close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data{ std::exchange(other.data, nullptr) }, size{ std::exchange(other.size, 0) } { }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+        }
+        return *this;
+    }
+
+    bool MappedFile::IsOpen() const noexcept {
+        return data != nullptr;
+    }
+
+    std::string_view MappedFile::View() const noexcept {
+        return { data, size };
+    }
 }// namespace arch
@@ -17,9 +17,10 @@ namespace arch {
     std::string ReadFile(const std::filesystem::path& filePath) noexcept;
 
     /**
-     * @brief Reads the content of the specified file and returns it as a std::string
+     * @brief Writes the data unchanged to the specified file
      * @param filePath path of the file
-     * @return content of the file
+     * @param data data to write
+     * @return bool that indicates success
      */
     bool WriteFile(const std::filesystem::path& filePath, std::string_view data) noexcept;
 
@@ -39,6 +40,48 @@ namespace arch {
      * @return path of the selected file
      */
     std::filesystem::path SaveFileDialog(const std::string& title) noexcept;
+
+    /**
+     * @brief Read-only mapping of a file into memory, pages are loaded on first access
+     */
+    class MappedFile {
+    private:
+        const char* data = nullptr;
+        usize size = 0;
+
+    public:
+        MappedFile() noexcept = default;
+        ~MappedFile() noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        /**
+         * @brief Maps the specified file, a previously mapped file is closed
+         * @param filePath path of the file
+         * @return bool that indicates success, empty files can not be mapped
+         */
+        bool Open(const std::filesystem::path& filePath) noexcept;
+
+        /**
+         * @brief Unmaps the file, which is required before the file can be replaced on some platforms
+         */
+        void Close() noexcept;
+
+        /**
+         * @brief Checks if a file is mapped
+         * @return bool if a file is mapped or not
+         */
+        bool IsOpen() const noexcept;
+
+        /**
+         * @brief Content of the mapped file, which is valid until the file is closed
+         * @return content of the file
+         */
+        std::string_view View() const noexcept;
+    };
 }// namespace arch
 
 #endif// LIBTRACKER_ARCH_FILE_H
\ No newline at end of file
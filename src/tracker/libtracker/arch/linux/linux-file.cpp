@@ -1,3 +1,7 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <filesystem>
 
 #include <fmt/format.h>
@@ -42,4 +46,34 @@ namespace arch {
     std::filesystem::path SaveFileDialog(const std::string& title) noexcept {
         return OpenZenity(title, false);
     }
+
+    bool MappedFile::Open(const std::filesystem::path& filePath) noexcept {
+        Close();
+
+        const auto descriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0) {
+            return false;
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        struct stat status {};
+        if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            const auto length = static_cast<usize>(status.st_size);
+            const auto address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address != MAP_FAILED) {
+                data = static_cast<const char*>(address);
+                size = length;
+            }
+        }
+        close(descriptor);
+        return IsOpen();
+    }
+
+    void MappedFile::Close() noexcept {
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+            data = nullptr;
+            size = 0;
+        }
+    }
 }// namespace arch
@@ -64,4 +64,38 @@ namespace arch {
         }
         return {};
     }
+
+    bool MappedFile::Open(const std::filesystem::path& filePath) noexcept {
+        Close();
+
+        const auto file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        // The view keeps the mapping alive, so both handles can be closed right away
+        LARGE_INTEGER length{};
+        if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+            const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                const auto address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (address) {
+                    data = static_cast<const char*>(address);
+                    size = static_cast<usize>(length.QuadPart);
+                }
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+        return IsOpen();
+    }
+
+    void MappedFile::Close() noexcept {
+        if (data) {
+            UnmapViewOfFile(data);
+            data = nullptr;
+            size = 0;
+        }
+    }
 }// namespace arch
\ No newline at end of file
@@ -42,11 +42,21 @@ std::shared_ptr<graphics::Texture> AssetDatabase::LoadTexture(const std::filesys
 
 void AssetDatabase::LoadCatalogManager(const std::filesystem::path& ngc,
                                        const std::filesystem::path& names,
-                                       const std::filesystem::path& planets) noexcept {
-    CatalogManager::LoadCatalog(ephemerisRootPath / ngc, ephemerisRootPath / names, ephemerisRootPath / planets);
+                                       const std::filesystem::path& planets,
+                                       const std::filesystem::path& snapshot) noexcept {
+    CatalogManager::LoadCatalog(ephemerisRootPath / ngc, ephemerisRootPath / names, ephemerisRootPath / planets,
+                                ephemerisRootPath / snapshot);
     CatalogManager::LoadTextures(textureRootPath);
 }
 
+void AssetDatabase::LoadHorizonProfile(const std::filesystem::path& fileName) noexcept {
+    CatalogManager::LoadHorizon(ephemerisRootPath / fileName);
+}
+
+void AssetDatabase::LoadAlmanac(const std::filesystem::path& fileName, const ephemeris::AlmanacInfo& info) noexcept {
+    CatalogManager::LoadAlmanac(ephemerisRootPath / fileName, info);
+}
+
 void AssetDatabase::LoadSettings(const std::filesystem::path& fileName) noexcept {
     LIBTRACKER_INFO("Loading settings {} from disk", fileName.string());
     Settings::LoadFromFile(assetPath / fileName);
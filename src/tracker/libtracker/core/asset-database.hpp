@@ -34,10 +34,25 @@ public:
      * @param ngc Name of the `ngc2000.dat` file
      * @param names Name of the `names.dat` file
      * @param planets Name of the `planets.json` file
+     * @param snapshot Name of the snapshot file, which is created if it is missing
      */
     static void LoadCatalogManager(const std::filesystem::path& ngc,
                                    const std::filesystem::path& names,
-                                   const std::filesystem::path& planets) noexcept;
+                                   const std::filesystem::path& planets,
+                                   const std::filesystem::path& snapshot) noexcept;
+
+    /**
+     * Loads the horizon profile of the site
+     * @param fileName Name of the profile file
+     */
+    static void LoadHorizonProfile(const std::filesystem::path& fileName) noexcept;
+
+    /**
+     * Loads the almanac of the site, which is generated if it is missing or stale
+     * @param fileName Name of the almanac file
+     * @param info Site, year and conditions
+     */
+    static void LoadAlmanac(const std::filesystem::path& fileName, const ephemeris::AlmanacInfo& info) noexcept;
 
     /**
      * Loads the specified icon
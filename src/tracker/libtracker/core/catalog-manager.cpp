@@ -1,13 +1,101 @@
+#include <thread>
+
 #include "catalog-manager.hpp"
 #include "arch/file.hpp"
+#include "utility/async.hpp"
 
 bool CatalogManager::LoadCatalog(const std::filesystem::path& ngc,
                                  const std::filesystem::path& names,
-                                 const std::filesystem::path& planets) noexcept {
-    const auto ngcData = arch::ReadFile(ngc);
-    const auto nameData = arch::ReadFile(names);
+                                 const std::filesystem::path& planets,
+                                 const std::filesystem::path& snapshot) noexcept {
+    arch::MappedFile ngcFile{};
+    arch::MappedFile nameFile{};
+    if (!ngcFile.Open(ngc) || !nameFile.Open(names)) {
+        LIBTRACKER_ERROR("Could not open the catalog {} {}", ngc.string(), names.string());
+        return false;
+    }
+
+    const auto checksum = ephemeris::Catalog::SourceChecksum(ngcFile.View(), nameFile.View());
+    sourceChecksum = checksum;
+    // The bodies of a snapshot refer to its mapping, which therefore replaces the previous one only on success
+    arch::MappedFile mappedSnapshot{};
+    auto fixedImported = mappedSnapshot.Open(snapshot) && catalog.ImportSnapshot(mappedSnapshot.View(), checksum);
+    if (fixedImported) {
+        snapshotFile = std::move(mappedSnapshot);
+    } else {
+        LIBTRACKER_INFO("Catalog snapshot {} is missing or stale, importing the text catalog", snapshot.string());
+        fixedImported = catalog.ImportFixed(ngcFile.View(), nameFile.View(), std::thread::hardware_concurrency());
+
+        // The mapping has to be released before the snapshot can be replaced
+        mappedSnapshot.Close();
+        if (fixedImported && !arch::WriteFile(snapshot, catalog.ExportSnapshot(checksum))) {
+            LIBTRACKER_WARN("Could not write catalog snapshot {}", snapshot.string());
+        }
+    }
+
     const auto planetData = arch::ReadFile(planets);
-    return catalog.ImportFixed(ngcData, nameData) && catalog.ImportPlanets(planetData);
+    return fixedImported && catalog.ImportPlanets(planetData);
+}
+
+bool CatalogManager::LoadHorizon(const std::filesystem::path& path) noexcept {
+    if (!std::filesystem::exists(path)) {
+        LIBTRACKER_INFO("No horizon profile {}, the horizon is flat", path.string());
+        return false;
+    }
+
+    if (auto profile = ephemeris::HorizonProfile::Parse(arch::ReadFile(path))) {
+        horizon = std::make_shared<const ephemeris::HorizonProfile>(std::move(*profile));
+        return true;
+    }
+    LIBTRACKER_WARN("Could not parse the horizon profile {}", path.string());
+    return false;
+}
+
+bool CatalogManager::LoadAlmanac(const std::filesystem::path& path, const ephemeris::AlmanacInfo& info) noexcept {
+    std::unique_lock lock(almanacMutex);
+    almanac.reset();
+    almanacData.clear();
+    almanacInfo = info;
+    const auto request = ++almanacRequest;
+    if (almanacFile.Open(path)) {
+        almanac = ephemeris::Almanac::Open(almanacFile.View(), info, sourceChecksum);
+        if (almanac) {
+            almanacPending = false;
+            return true;
+        }
+    }
+
+    // The mapping has to be released before the almanac can be replaced
+    LIBTRACKER_INFO("Almanac {} is missing or stale, generating it", path.string());
+    almanacFile.Close();
+    almanacPending = true;
+    lock.unlock();
+
+    // The catalog is not modified after loading, so it is read by the task without synchronization
+    utility::ThreadPool::Shared().Submit([path, info, request, checksum = sourceChecksum] {
+        auto data = ephemeris::Almanac::Generate(catalog, info, checksum);
+        const auto written = arch::WriteFile(path, data);
+
+        // A later request replaces the almanac, the result of this one is dropped
+        std::lock_guard publish(almanacMutex);
+        if (request != almanacRequest) {
+            return;
+        }
+        almanacPending = false;
+        if (written && almanacFile.Open(path)) {
+            almanac = ephemeris::Almanac::Open(almanacFile.View(), info, checksum);
+        } else {
+            LIBTRACKER_WARN("Could not write almanac {}", path.string());
+            almanacData = std::move(data);
+            almanac = ephemeris::Almanac::Open(almanacData, info, checksum);
+        }
+    });
+    return false;
+}
+
+bool CatalogManager::IsAlmanacPending() noexcept {
+    std::lock_guard lock(almanacMutex);
+    return almanacPending;
 }
 
 bool CatalogManager::LoadTextures(const std::filesystem::path& directory) noexcept {
@@ -37,4 +125,19 @@ std::shared_ptr<graphics::Texture> CatalogManager::FetchTexture(std::string_view
 
 ephemeris::Catalog& CatalogManager::GetCatalog() noexcept {
     return catalog;
+}
+
+std::shared_ptr<const ephemeris::HorizonProfile> CatalogManager::GetHorizon() noexcept {
+    return horizon;
+}
+
+const ephemeris::Almanac* CatalogManager::GetAlmanac(const ephemeris::AlmanacInfo& info) noexcept {
+    // A published almanac is not replaced until the next LoadAlmanac, so the pointer outlives the lock
+    std::lock_guard lock(almanacMutex);
+    const auto matches = info.Observer.Latitude == almanacInfo.Observer.Latitude &&
+                         info.Observer.Longitude == almanacInfo.Observer.Longitude && info.Year == almanacInfo.Year &&
+                         info.AltitudeThreshold == almanacInfo.AltitudeThreshold &&
+                         info.SunAltitude == almanacInfo.SunAltitude &&
+                         info.HorizonChecksum() == almanacInfo.HorizonChecksum();
+    return matches && almanac ? &*almanac : nullptr;
 }
\ No newline at end of file
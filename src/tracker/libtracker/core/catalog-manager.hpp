@@ -2,10 +2,14 @@
 #define LIBTRACKER_CORE_CELESTIALBODYLIBRARY_H
 
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 
+#include <libengine/ephemeris/almanac.hpp>
 #include <libengine/ephemeris/catalog.hpp>
 
+#include "arch/file.hpp"
 #include "core.hpp"
 #include "graphics/texture.hpp"
 #include "utility/types.hpp"
@@ -13,15 +17,42 @@
 class CatalogManager {
 public:
     /**
-     * Loads the specified catalog from disk
+     * Loads the specified catalog from disk. The fixed bodies are loaded from the snapshot, unless it is missing or
+     * was created from other source files, in which case they are imported from the text files and the snapshot is
+     * written for the next launch
      * @param ngc Path to the `ngc2000.dat` file
      * @param names Path to the `names.dat` file
      * @param planets Path toe the `planets.json` file
+     * @param snapshot Path to the binary snapshot of the fixed bodies
      * @return bool that indicates success
      */
     static bool LoadCatalog(const std::filesystem::path& ngc,
                             const std::filesystem::path& names,
-                            const std::filesystem::path& planets) noexcept;
+                            const std::filesystem::path& planets,
+                            const std::filesystem::path& snapshot) noexcept;
+
+    /**
+     * Loads the horizon profile of the site, a missing file leaves the horizon flat
+     * @param path Path to the profile
+     * @return bool that indicates success
+     */
+    static bool LoadHorizon(const std::filesystem::path& path) noexcept;
+
+    /**
+     * Opens the almanac of the site, if the file exists and was generated from the same catalog for the same
+     * conditions. Otherwise the almanac is generated on the shared thread pool, written for the next launch and
+     * published when it is done, until then GetAlmanac returns null
+     * @param path Path to the almanac
+     * @param info Site, year and conditions
+     * @return true if the file was opened, false if the almanac is generated
+     */
+    static bool LoadAlmanac(const std::filesystem::path& path, const ephemeris::AlmanacInfo& info) noexcept;
+
+    /**
+     * Checks if the almanac is still being generated
+     * @return boolean value
+     */
+    static bool IsAlmanacPending() noexcept;
 
     /**
      * Load textures from the specified directory, used for texture lookup table
@@ -43,8 +74,31 @@ public:
      */
     static ephemeris::Catalog& GetCatalog() noexcept;
 
+    /**
+     * Retrieves the horizon profile
+     * @return horizon or null, if no profile was loaded
+     */
+    static std::shared_ptr<const ephemeris::HorizonProfile> GetHorizon() noexcept;
+
+    /**
+     * Retrieves the almanac, if it was loaded for the specified conditions
+     * @param info Site, year and conditions
+     * @return almanac or null
+     */
+    static const ephemeris::Almanac* GetAlmanac(const ephemeris::AlmanacInfo& info) noexcept;
+
 private:
     static inline ephemeris::Catalog catalog{};
+    static inline u64 sourceChecksum{ 0 };
+    static inline arch::MappedFile snapshotFile{};
+    static inline arch::MappedFile almanacFile{};
+    static inline std::string almanacData{};
+    static inline std::optional<ephemeris::Almanac> almanac{};
+    static inline ephemeris::AlmanacInfo almanacInfo{};
+    static inline std::mutex almanacMutex{};
+    static inline bool almanacPending{ false };
+    static inline u64 almanacRequest{ 0 };
+    static inline std::shared_ptr<const ephemeris::HorizonProfile> horizon{};
     static inline std::unordered_map<std::string, std::shared_ptr<graphics::Texture>> textures;
 };
 
@@ -1,12 +1,13 @@
 #include <optional>
 
+#include "catalog-manager.hpp"
 #include "core.hpp"
 #include "input.hpp"
 #include "location-manager.hpp"
 #include "settings.hpp"
 #include "tracker.hpp"
 
-TrackerHandle::TrackerHandle() noexcept : status{ TrackerStatus::Idle }, begin{ DateTime::Now() } { }
+TrackerHandle::TrackerHandle() noexcept : status{ TrackerStatus::Idle }, begin{ Instant::Now() } { }
 
 bool TrackerHandle::InProgress() const noexcept {
     // We don't want to lock the handle here, so we copy its value so that it can't change
@@ -16,7 +17,7 @@ bool TrackerHandle::InProgress() const noexcept {
 }
 
 DateTime TrackerHandle::GetBegin() const noexcept {
-    return InProgress() ? begin : DateTime::Now();
+    return InProgress() ? Clock::ToLocal(begin).ToDateTime() : DateTime::Now();
 }
 
 TrackerStatus TrackerHandle::GetStatus() const noexcept {
@@ -24,7 +25,10 @@ TrackerStatus TrackerHandle::GetStatus() const noexcept {
 }
 
 s64 TrackerHandle::GetElapsedSeconds() const noexcept {
-    return DateTime::Difference(GetBegin(), DateTime::Now());
+    if (!InProgress()) {
+        return 0;
+    }
+    return (Instant::Now() - begin) / Instant::NanosecondsPerSecond;
 }
 
 void TrackerHandle::SetStatus(TrackerStatus trackerStatus) noexcept {
@@ -142,8 +146,9 @@ bool Tracker::SubmitPlanet(const std::shared_ptr<ephemeris::Planet>& planet, f64
         durationWatch.Start();
 
         while (durationWatch.GetElapsedMilliseconds() / 1000.0 < duration) {
-            const auto currentPosition = ObserveGeographic(planet->GetEquatorialPosition(DateTime::Now()),
-                                                           LocationManager::GetGeographic(), DateTime::Now());
+            const auto now = Instant::Now();
+            const auto currentPosition =
+                    ObserveGeographic(planet->GetEquatorialPosition(now), LocationManager::GetGeographic(), now);
             Pack32 trackingPackage{ Command::Move };
             trackingPackage.Push(static_cast<f32>(currentPosition.Altitude));
             trackingPackage.Push(static_cast<f32>(currentPosition.Azimuth));
@@ -172,7 +177,15 @@ bool Tracker::SubmitPlanet(const std::shared_ptr<ephemeris::Planet>& planet, f64
     return true;
 }
 
+bool Tracker::SubmitFixed(ephemeris::FixedHandle handle, f64 duration) noexcept {
+    return submitFixed(CatalogManager::GetCatalog().GetFixed(handle), duration);
+}
+
 bool Tracker::SubmitFixed(const std::shared_ptr<ephemeris::FixedBody>& body, f64 duration) noexcept {
+    return submitFixed(*body, duration);
+}
+
+bool Tracker::submitFixed(const ephemeris::FixedBody& body, f64 duration) noexcept {
     Handle = std::make_shared<TrackerHandle>();
     utility::FireAndForget([body, duration]() -> void {
         std::unique_lock lock(mutex);
@@ -187,9 +200,9 @@ bool Tracker::SubmitFixed(const std::shared_ptr<ephemeris::FixedBody>& body, f64
         durationWatch.Start();
 
         while (durationWatch.GetElapsedMilliseconds() / 1000.0 < duration) {
-            const auto now = DateTime::Now();
+            const auto now = Instant::Now();
             const auto currentPosition =
-                    ObserveGeographic(body->GetEquatorialPosition(now), LocationManager::GetGeographic(), now);
+                    ObserveGeographic(body.GetEquatorialPosition(now), LocationManager::GetGeographic(), now);
             Pack32 trackingPackage{ Command::Move };
             trackingPackage.Push(static_cast<f32>(currentPosition.Altitude));
             trackingPackage.Push(static_cast<f32>(currentPosition.Azimuth));
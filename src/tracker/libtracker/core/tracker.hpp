@@ -70,7 +70,7 @@ public:
 private:
     std::mutex mutex;
     TrackerStatus status;
-    DateTime begin;
+    Instant begin;
 };
 
 /**
@@ -129,7 +129,15 @@ public:
     static bool SubmitPlanet(const std::shared_ptr<ephemeris::Planet>& planet, f64 duration) noexcept;
 
     /**
-     * Tracks the specified FixedBody
+     * Tracks the specified FixedBody of the catalog
+     * @param handle Handle of the FixedBody target in the catalog of the CatalogManager
+     * @param duration The duration for the tracking process in seconds
+     * @return bool that indicates if the job could be started
+     */
+    static bool SubmitFixed(ephemeris::FixedHandle handle, f64 duration) noexcept;
+
+    /**
+     * Tracks the specified FixedBody, compatibility shim for bodies that are not addressed by a handle
      * @param body std::shared_ptr to the FixedBody target instance
      * @param duration The duration for the tracking process in seconds
      * @return bool that indicates if the job could be started
@@ -202,6 +210,14 @@ private:
      */
     static bool sendPackage(Pack32 package, bool failAfterTimeout = false) noexcept;
 
+    /**
+     * @brief Tracks a copy of the FixedBody, the strings of the body are owned by the catalog
+     * @param body FixedBody target
+     * @param duration The duration for the tracking process in seconds
+     * @return bool that indicates if the job could be started
+     */
+    static bool submitFixed(const ephemeris::FixedBody& body, f64 duration) noexcept;
+
     /**
      * Used to guarantee thread safety, as each submission is executed asynchronously on a different thread
      */
@@ -2,6 +2,8 @@
 #include <fmt/format.h>
 #include <gtest/gtest.h>
 #include <libengine/libengine.hpp>
+#include <utility/conversion.hpp>
+#include <utility/perfect-hash.hpp>
 
 
 
@@ -88,6 +90,29 @@ TEST(Engine, Rotation) {
     ASSERT_DOUBLE_EQ(rotated.Z, -0.5);
 }
 
+TEST(Engine, TransformMatrixCache) {
+    using namespace ephemeris;
+    const auto epoch = 0.2317;
+    auto precession = PrecessionMatrix(ReferencePlane::Equatorial, EpochB2000, epoch);
+    const Vector3 vector{ 0.3, -0.5, std::sqrt(1.0 - 0.34) };
+    const auto exact = precession * vector;
+
+    SetTransformQuantum(0.0);
+    ASSERT_EQ(TransformMatrix(EpochTransform::FixedB2000, epoch), precession);
+
+    // The error of the quantised epoch has to stay below 0.1 arc seconds
+    SetTransformQuantum(DefaultTransformQuantum);
+    for (auto offset = 0.0; offset < 2.0 * DefaultTransformQuantum; offset += DefaultTransformQuantum / 7.0) {
+        auto current = PrecessionMatrix(ReferencePlane::Equatorial, EpochB2000, epoch + offset);
+        const auto expected = current * vector;
+        const auto cached = TransformMatrix(EpochTransform::FixedB2000, epoch + offset) * vector;
+        const auto difference = (expected - cached).Length();
+        ASSERT_LT(difference * math::ARCS, 0.1);
+    }
+    ASSERT_GT((exact - TransformMatrix(EpochTransform::FixedB2000, epoch + 30.0 * DefaultTransformQuantum) * vector)
+                      .Length() * math::ARCS, 1.0);
+}
+
 TEST(Engine, DateTimeAddSecondsPositive) {
     DateTime date{ 1990, 12, 31, 23, 59, 59 };
     date.AddSeconds(1);
@@ -209,4 +234,1130 @@ TEST(Engine, CatalogFindFixedByName) {
     ephemeris::Catalog catalog;
     catalog.ImportFixed(ngcData, nameData);
     ASSERT_TRUE(catalog.FindFixedByName("Antennae") != nullptr);
-}
\ No newline at end of file
+}
+
+TEST(Engine, ComputeGeographicBatch) {
+    const auto planetData = ReadFile("assets/ephemeris/planets.json");
+    ephemeris::Catalog catalog;
+    catalog.ImportPlanets(planetData);
+    const auto planet = catalog.FindPlanetByName("Jupiter");
+    ASSERT_TRUE(planet != nullptr);
+
+    ephemeris::FixedBody body{};
+    body.Position = { 1.0, 83.8, -5.4 };
+
+    const ephemeris::Geographic observer{ 48.2, 16.4 };
+    const DateTime start{ 2023, 3, 14, 21, 30, 0 };
+    const auto utc = DateTime::Utc(start);
+    const ephemeris::BatchInfo info{ DateTime::JulianDayNumber(utc), 600.0, 144, observer };
+    const auto fixedResult = ComputeGeographicBatch(body, info);
+    const auto planetResult = ComputeGeographicBatch(*planet, info);
+    ASSERT_EQ(fixedResult.Altitudes.size(), info.Count);
+    ASSERT_EQ(planetResult.Azimuths.size(), info.Count);
+
+    auto date = start;
+    auto utcDate = utc;
+    for (std::size_t step = 0; step < info.Count; ++step) {
+        const auto fixed = ObserveGeographic(body.GetEquatorialPosition(utcDate), observer, date);
+        ASSERT_NEAR(fixed.Altitude, fixedResult.Altitudes[step], 1e-6);
+        ASSERT_NEAR(fixed.Azimuth, fixedResult.Azimuths[step], 1e-6);
+
+        const auto wandering = ObserveGeographic(planet->GetEquatorialPosition(utcDate), observer, date);
+        ASSERT_NEAR(wandering.Altitude, planetResult.Altitudes[step], 1e-6);
+        ASSERT_NEAR(wandering.Azimuth, planetResult.Azimuths[step], 1e-6);
+
+        date.AddMinutes(10);
+        utcDate.AddMinutes(10);
+    }
+}
+
+TEST(Engine, CatalogFindFixedByDesignation) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+
+    // Every body is found through the index, unless an earlier body shares its designation
+    for (const auto& body : catalog.GetBodies()) {
+        const auto found = catalog.FindFixedByDesignation(body.Designation);
+        ASSERT_TRUE(found != nullptr);
+        ASSERT_EQ(found->Designation, body.Designation);
+    }
+
+    const auto andromeda = catalog.FindFixedByDesignation("NGC224");
+    ASSERT_TRUE(andromeda != nullptr);
+    ASSERT_EQ(catalog.FindFixedHandleByDesignation("NGC224"), catalog.FindFixedHandleByName("Messier 31"));
+    ASSERT_TRUE(catalog.FindFixedByDesignation("IC434") != nullptr);
+    ASSERT_TRUE(catalog.FindFixedByDesignation("NGC0224") == nullptr);
+    ASSERT_TRUE(catalog.FindFixedByDesignation("NGC") == nullptr);
+    ASSERT_TRUE(catalog.FindFixedByDesignation("IC99999") == nullptr);
+    ASSERT_TRUE(catalog.FindFixedByName("") == nullptr);
+}
+
+TEST(Engine, CatalogFixedHandles) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+
+    ephemeris::Catalog::Filter filter{};
+    filter.Identifier = "messier";
+    const auto handles = catalog.FilterFixed(filter);
+    ASSERT_FALSE(handles.empty());
+    for (const auto handle : handles) {
+        const auto& body = catalog.GetFixed(handle);
+        ASSERT_EQ(body.Name.substr(0, 7), "Messier");
+        ASSERT_EQ(body.Name.data()[body.Name.size()], '\0');
+        ASSERT_EQ(body.Designation.data()[body.Designation.size()], '\0');
+        ASSERT_EQ(catalog.ShareFixed(handle)->Designation, body.Designation);
+    }
+    ASSERT_EQ(catalog.FilterFixed({}).size(), catalog.GetBodies().size());
+
+    // Strings beyond the block size get their own block, without disturbing the current one
+    ephemeris::StringPool pool;
+    const auto small = pool.Store("small");
+    const auto large = pool.Store(std::string(ephemeris::StringPool::BlockSize * 2, 'x'));
+    const auto next = pool.Store("next");
+    ASSERT_EQ(small, "small");
+    ASSERT_EQ(large.size(), ephemeris::StringPool::BlockSize * 2);
+    ASSERT_EQ(next.data(), small.data() + small.size() + 1);
+}
+
+TEST(Engine, CatalogTrigramSearch) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+
+    const auto contains = [](std::string_view text, std::string_view term) {
+        return std::search(text.begin(), text.end(), term.begin(), term.end(), [](char left, char right) {
+                   return ephemeris::TrigramIndex::Fold(left) == ephemeris::TrigramIndex::Fold(right);
+               }) != text.end();
+    };
+
+    // The indexed search has to agree with a plain scan, for terms both shorter and longer than a trigram
+    for (const auto identifier : {"messier"sv, "NGC22"sv, "an"sv, "xyzq"sv, "m 3;ic4"sv}) {
+        std::vector<std::string_view> terms{};
+        utility::Split(terms, identifier, ";"sv);
+        std::vector<ephemeris::FixedHandle> expected{};
+        const auto& bodies = catalog.GetBodies();
+        for (u32 index = 0; index < bodies.size(); ++index) {
+            for (const auto term : terms) {
+                if (contains(bodies[index].Name, term) || contains(bodies[index].Designation, term)) {
+                    expected.push_back({ index });
+                    break;
+                }
+            }
+        }
+
+        ephemeris::Catalog::Filter filter{};
+        filter.Identifier = identifier;
+        ASSERT_EQ(catalog.FilterFixed(filter), expected) << identifier;
+    }
+
+    std::vector<u32> candidates{};
+    ephemeris::TrigramIndex index{};
+    index.Build(catalog.GetBodies());
+    ASSERT_FALSE(index.Candidates("ic", candidates));
+    ASSERT_TRUE(index.Candidates("xyzq", candidates));
+    ASSERT_TRUE(candidates.empty());
+}
+
+TEST(Engine, CatalogFilterRefinement) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog typed;
+    typed.ImportFixed(ngcData, nameData);
+    ephemeris::Catalog reference;
+    reference.ImportFixed(ngcData, nameData);
+
+    const auto makeFilter = [](std::string_view identifier,
+                               std::initializer_list<ephemeris::Classification> classifications,
+                               std::initializer_list<std::string_view> constellations) {
+        ephemeris::Catalog::Filter filter{};
+        filter.Identifier = identifier;
+        for (const auto classification : classifications) {
+            filter.Classifications.set(static_cast<usize>(classification));
+        }
+        for (const auto constellation : constellations) {
+            filter.Constellations.set(ephemeris::FindConstellation(constellation));
+        }
+        return filter;
+    };
+
+    // Typing, backspacing and ticking, every step but the first narrows or repeats a previous filter
+    const std::vector<ephemeris::Catalog::Filter> steps = {
+        makeFilter("m", {}, {}),
+        makeFilter("me", {}, {}),
+        makeFilter("mes", {}, {}),
+        makeFilter("Mess", {}, {}),
+        makeFilter("me", {}, {}),
+        makeFilter("mess", { ephemeris::Classification::Galaxy }, {}),
+        makeFilter("mess", { ephemeris::Classification::Galaxy }, { "And" }),
+        makeFilter("m 3", {}, {}),
+    };
+
+    // The reference evaluates the narrowest filters first, so it never refines a cached result
+    std::vector<std::vector<ephemeris::FixedHandle>> expected(steps.size());
+    for (usize step = steps.size(); step-- > 0;) {
+        expected[step] = reference.FilterFixed(steps[step]);
+    }
+    for (usize step = 0; step < steps.size(); ++step) {
+        ASSERT_EQ(typed.FilterFixed(steps[step]), expected[step]) << step;
+    }
+
+    using Key = ephemeris::FilterCache::Key;
+    ASSERT_FALSE(Key("ngc2;ic", {}, {}).Narrows(Key("NGC", {}, {})));
+    const auto andromeda = ephemeris::ConstellationMask{}.set(ephemeris::FindConstellation("And"));
+    ASSERT_TRUE(Key("ngc2", {}, andromeda).Narrows(Key("NGC", {}, {})));
+    ASSERT_FALSE(Key("ngc2", {}, {}).Narrows(Key("NGC", {}, andromeda)));
+    ASSERT_FALSE(Key("ngc", {}, {}).Narrows(Key("ngc2", {}, {})));
+    ASSERT_FALSE(Key("", {}, {}).Narrows(Key("ngc", {}, {})));
+    ASSERT_TRUE(Key("ngc", {}, {}) == Key("NGC;ngc", {}, {}));
+
+    // Visibility of a selection agrees with the visibility of the whole catalog
+    ephemeris::BodyColumns columns;
+    columns.Assign(typed.GetBodies());
+    const auto utc = Instant::FromDateTime({ 2022, 3, 1, 22, 0, 0 });
+    const auto matrix = ephemeris::BodyColumns::HorizontalMatrix(utc, { 48.2, 16.4 });
+    std::vector<u8> visible{};
+    columns.Visible(matrix, 20.0, visible);
+    std::vector<u32> selection{};
+    for (const auto handle : expected.front()) {
+        selection.emplace_back(handle.Index);
+    }
+    std::vector<u8> selected{};
+    columns.Visible(matrix, 20.0, selection, selected);
+    for (usize index = 0; index < selection.size(); ++index) {
+        ASSERT_EQ(selected[index], visible[selection[index]]);
+    }
+}
+
+TEST(Engine, CatalogAttributeMasks) {
+    static_assert(ephemeris::FindConstellation("And") == 0);
+    static_assert(ephemeris::FindConstellation("Vul") == ephemeris::ConstellationCount - 1);
+    static_assert(ephemeris::FindConstellation("Xyz") == ephemeris::UnknownConstellation);
+    for (usize id = 0; id < ephemeris::ConstellationCount; ++id) {
+        ASSERT_EQ(ephemeris::FindConstellation(ephemeris::ConstellationTable[id].Abbreviation), id);
+    }
+
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+
+    ephemeris::Catalog::Filter filter{};
+    filter.Classifications.set(static_cast<usize>(ephemeris::Classification::Galaxy));
+    filter.Classifications.set(static_cast<usize>(ephemeris::Classification::OpenStarCluster));
+    filter.Constellations.set(ephemeris::FindConstellation("And"));
+    filter.Constellations.set(ephemeris::FindConstellation("Ori"));
+
+    std::vector<ephemeris::FixedHandle> expected{};
+    const auto& bodies = catalog.GetBodies();
+    for (u32 index = 0; index < bodies.size(); ++index) {
+        const auto& body = bodies[index];
+        const auto classified = body.Type == ephemeris::Classification::Galaxy ||
+                                body.Type == ephemeris::Classification::OpenStarCluster;
+        const auto located = body.Const.Abbreviation == "And" || body.Const.Abbreviation == "Ori";
+        if (classified && located) {
+            expected.push_back({ index });
+        }
+    }
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(catalog.FilterFixed(filter), expected);
+
+    // Bodies of unknown constellations are only accepted without a constellation filter
+    const auto unknown = ephemeris::AttributeMask::OfBody(ephemeris::Classification::Galaxy,
+                                                          ephemeris::UnknownConstellation);
+    ASSERT_TRUE(unknown.AcceptedBy(ephemeris::AttributeMask::Accepting({}, {})));
+    ASSERT_FALSE(unknown.AcceptedBy(ephemeris::AttributeMask::Accepting({}, filter.Constellations)));
+    ASSERT_FALSE(unknown.AcceptedBy(ephemeris::AttributeMask::Accepting(
+            ephemeris::ClassificationMask{}.set(static_cast<usize>(ephemeris::Classification::Knot)), {})));
+}
+
+TEST(Engine, CatalogQuery) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+
+    const auto utc = Instant::FromDateTime({ 2023, 3, 14, 21, 30, 0 });
+    const ephemeris::Geographic observer{ 48.2, 16.4 };
+    const auto& bodies = catalog.GetBodies();
+    const auto altitudes = catalog.ObserveFixed(utc, observer).Altitudes;
+    const auto bruteForce = [&bodies](auto predicate) {
+        std::vector<ephemeris::FixedHandle> handles{};
+        for (u32 index = 0; index < bodies.size(); ++index) {
+            if (predicate(index, bodies[index])) {
+                handles.push_back({ index });
+            }
+        }
+        return handles;
+    };
+
+    // The ephemeris predicate is written first, but evaluated last on what the attribute predicates leave
+    const auto query = ephemeris::Query::Parse("alt(now) > 30 && mag < 10 && dim > 5 && type in {Gx, Pl}");
+    ASSERT_TRUE(query.has_value());
+    ASSERT_TRUE(query->DependsOnEphemeris());
+    std::vector<ephemeris::Query::Step> profile{};
+    const auto expected = bruteForce([&altitudes](u32 index, const ephemeris::FixedBody& body) {
+        const auto classified = body.Type == ephemeris::Classification::Galaxy ||
+                                body.Type == ephemeris::Classification::PlanetaryNebula;
+        const auto bright = body.Magnitude != 0.0 && body.Magnitude < 10.0;
+        return bright && body.Dimension > 5.0 && classified && altitudes[index] > 30.0;
+    });
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(catalog.QueryFixed(*query, utc, observer, nullptr, &profile), expected);
+    ASSERT_EQ(profile.size(), 4u);
+    ASSERT_EQ(profile.front().Input, bodies.size());
+    ASSERT_EQ(profile.back().Predicate, "alt(now) > 30");
+    ASSERT_EQ(profile.back().Output, expected.size());
+    ASSERT_LT(profile.back().Input, bodies.size() / 10);
+    ASSERT_EQ(query->Plan().substr(0, 13), "and (cost 19)");
+
+    const auto nested = ephemeris::Query::Parse("!(type in {Gx}) && (mag <= 8 || const in { Ori, And })");
+    ASSERT_TRUE(nested.has_value());
+    ASSERT_FALSE(nested->DependsOnEphemeris());
+    ASSERT_EQ(catalog.QueryFixed(*nested, utc, observer),
+              bruteForce([](u32, const ephemeris::FixedBody& body) {
+                  const auto located = body.Const.Abbreviation == "Ori" || body.Const.Abbreviation == "And";
+                  const auto bright = body.Magnitude != 0.0 && body.Magnitude <= 8.0;
+                  return body.Type != ephemeris::Classification::Galaxy && (bright || located);
+              }));
+
+    // A missing magnitude fails every comparison, but its negation matches
+    const auto listed = bruteForce([](u32, const ephemeris::FixedBody& body) { return body.Magnitude != 0.0; });
+    const auto missing = bruteForce([](u32, const ephemeris::FixedBody& body) { return body.Magnitude == 0.0; });
+    ASSERT_FALSE(missing.empty());
+    ASSERT_EQ(catalog.QueryFixed(*ephemeris::Query::Parse("mag < 100 || mag != 0"), utc, observer), listed);
+    ASSERT_TRUE(catalog.QueryFixed(*ephemeris::Query::Parse("mag == 0"), utc, observer).empty());
+    ASSERT_EQ(catalog.QueryFixed(*ephemeris::Query::Parse("!(mag < 100)"), utc, observer), missing);
+
+    // Bodies without a code in the catalog are unidentified
+    const auto unidentified = bruteForce([](u32, const ephemeris::FixedBody& body) {
+        return body.Type == ephemeris::Classification::Unidentified;
+    });
+    ASSERT_FALSE(unidentified.empty());
+    ASSERT_EQ(catalog.QueryFixed(*ephemeris::Query::Parse("type in {Unidentified}"), utc, observer), unidentified);
+
+    std::string error{};
+    ASSERT_FALSE(ephemeris::Query::Parse("mag <", &error).has_value());
+    ASSERT_EQ(error, "Expected a number at position 5");
+    ASSERT_FALSE(ephemeris::Query::Parse("type in {Gx, Xx}", &error).has_value());
+    ASSERT_FALSE(ephemeris::Query::Parse("type in {Gx, }", &error).has_value());
+    ASSERT_FALSE(ephemeris::Query::Parse("size > 1", &error).has_value());
+    ASSERT_FALSE(ephemeris::Query::Parse("mag < 1 &&", &error).has_value());
+    ASSERT_FALSE(ephemeris::Query::Parse("(mag < 1", &error).has_value());
+
+    // The nesting is bounded, so that deeply nested input does not exhaust the stack
+    ASSERT_TRUE(ephemeris::Query::Parse(std::string(63, '!') + "mag < 1").has_value());
+    ASSERT_FALSE(ephemeris::Query::Parse(std::string(64, '!') + "mag < 1", &error).has_value());
+    ASSERT_EQ(error, "Expression nested too deeply at position 64");
+    ASSERT_FALSE(ephemeris::Query::Parse(std::string(100000, '(') + "mag < 1", &error).has_value());
+    ASSERT_FALSE(ephemeris::Query::Parse(std::string(100000, '!'), &error).has_value());
+}
+
+TEST(Engine, CatalogSortOrders) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+    const auto& bodies = catalog.GetBodies();
+
+    const auto& magnitudes = catalog.GetOrder(ephemeris::SortKey::Magnitude);
+    ASSERT_EQ(magnitudes.size(), bodies.size());
+    ASSERT_TRUE(std::is_sorted(magnitudes.begin(), magnitudes.end(), [&bodies](u32 a, u32 b) {
+        const auto magnitudeA = bodies[a].Magnitude == 0.0 ? 100.0 : bodies[a].Magnitude;
+        const auto magnitudeB = bodies[b].Magnitude == 0.0 ? 100.0 : bodies[b].Magnitude;
+        return magnitudeA < magnitudeB;
+    }));
+    const auto& designations = catalog.GetOrder(ephemeris::SortKey::Designation);
+    ASSERT_EQ(bodies[designations.front()].Designation, "NGC1");
+    ASSERT_EQ(bodies[designations.back()].Designation.substr(0, 2), "IC");
+
+    // Small selections are sorted by rank and large ones by walking the permutation, both agree with the permutation
+    ephemeris::Catalog::Filter filter{};
+    for (const auto identifier : { "messier"sv, "n"sv }) {
+        filter.Identifier = identifier;
+        auto handles = catalog.FilterFixed(filter);
+        const auto size = handles.size();
+        catalog.SortFixed(handles, ephemeris::SortKey::Name);
+        ASSERT_EQ(handles.size(), size);
+        const auto& names = catalog.GetOrder(ephemeris::SortKey::Name);
+        std::vector<u32> rank(names.size());
+        for (u32 position = 0; position < names.size(); ++position) {
+            rank[names[position]] = position;
+        }
+        std::vector<u32> positions{};
+        for (const auto handle : handles) {
+            positions.push_back(rank[handle.Index]);
+        }
+        ASSERT_TRUE(std::is_sorted(positions.begin(), positions.end()));
+    }
+
+    // The second ordering starts from the first one, a minute later it is almost sorted
+    const ephemeris::Geographic observer{ 48.2, 16.4 };
+    auto handles = catalog.FilterFixed({});
+    for (const s64 seconds : { 0, 60 }) {
+        const auto utc = Instant::FromDateTime({ 2023, 3, 14, 21, 30, 0 }).AddSeconds(seconds);
+        catalog.SortFixedByAltitude(handles, utc, observer);
+        ASSERT_EQ(handles.size(), bodies.size());
+        const auto altitudes = catalog.ObserveFixed(utc, observer).Altitudes;
+        ASSERT_TRUE(std::is_sorted(handles.begin(), handles.end(), [&altitudes](auto a, auto b) {
+            return altitudes[a.Index] > altitudes[b.Index];
+        }));
+    }
+}
+
+TEST(Engine, CatalogDeclinationBands) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+    const auto& bodies = catalog.GetBodies();
+
+    using Band = ephemeris::DeclinationIndex::Band;
+    const std::array<std::pair<f64, f64>, 3> sites = { { { 48.2, 0.0 }, { 48.2, 30.0 }, { -33.9, 10.0 } } };
+    for (const auto& [latitude, threshold] : sites) {
+        const ephemeris::Catalog::VisibilityFilter visibility{ threshold, { latitude, 16.4 } };
+        const auto bands = catalog.ClassifyFixed(visibility);
+        ASSERT_EQ(bands, catalog.ClassifyFixed(visibility));
+        ASSERT_EQ(bands->Never + bands->Sometimes + bands->Always, bodies.size());
+        ASSERT_GT(bands->Never + bands->Always, bodies.size() / 10);
+
+        // The classification holds during a whole day
+        for (s64 hour = 0; hour < 24; ++hour) {
+            const auto utc = Instant::FromDateTime({ 2023, 3, 14, 0, 0, 0 }).AddSeconds(hour * 3600);
+            const auto altitudes = catalog.ObserveFixed(utc, visibility.Observer).Altitudes;
+            for (usize index = 0; index < bodies.size(); ++index) {
+                if (bands->Of[index] == Band::Never) {
+                    ASSERT_LT(altitudes[index], threshold);
+                } else if (bands->Of[index] == Band::Always) {
+                    ASSERT_GE(altitudes[index], threshold);
+                }
+            }
+        }
+
+        ephemeris::Catalog::Filter filter{};
+        filter.Visibility = visibility;
+        std::vector<u8> selected(bodies.size(), 0);
+        for (const auto handle : catalog.FilterFixed(filter)) {
+            selected[handle.Index] = 1;
+        }
+        for (usize index = 0; index < bodies.size(); ++index) {
+            if (bands->Of[index] != Band::Sometimes) {
+                ASSERT_EQ(selected[index], bands->Of[index] == Band::Always ? 1 : 0);
+            }
+        }
+    }
+}
+
+TEST(Engine, CatalogImportFixedParallel) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog sequential;
+    sequential.ImportFixed(ngcData, nameData, 1);
+    ephemeris::Catalog parallel;
+    parallel.ImportFixed(ngcData, nameData, 7);
+
+    const auto& expected = sequential.GetBodies();
+    const auto& bodies = parallel.GetBodies();
+    ASSERT_EQ(expected.size(), bodies.size());
+    for (std::size_t index = 0; index < bodies.size(); ++index) {
+        ASSERT_EQ(expected[index].Designation, bodies[index].Designation);
+        ASSERT_EQ(expected[index].Name, bodies[index].Name);
+    }
+}
+
+TEST(Engine, DescriptionInterner) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+
+    // Equal abbreviations share one entry, and expansions are stable
+    const auto first = ephemeris::DescriptionInterner::Intern("eF, S, R");
+    const auto second = ephemeris::DescriptionInterner::Intern(std::string{ "eF, S, R" });
+    ASSERT_EQ(first.data(), second.data());
+    ASSERT_EQ(&ephemeris::DescriptionInterner::Expand(first), &ephemeris::DescriptionInterner::Expand(second));
+    ASSERT_LT(ephemeris::DescriptionInterner::Size(), catalog.GetBodies().size());
+
+    const auto andromeda = catalog.FindFixedByDesignation("NGC224");
+    ASSERT_TRUE(andromeda != nullptr);
+    ASSERT_EQ(andromeda->GetDescription(),
+              "a magnificent or otherwise interesting object extremely, excessively extremely, excessively bright "
+              "extremely, excessively large very much extended ( A north diameter resolvable (mottled, not resolved) o "
+              "much extremely, excessively diameter a ) ; = middle, or in the middle 3 1 ");
+}
+
+TEST(Engine, CatalogSnapshot) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+    const auto checksum = ephemeris::Catalog::SourceChecksum(ngcData, nameData);
+    const auto snapshot = catalog.ExportSnapshot(checksum);
+
+    ephemeris::Catalog loaded;
+    ASSERT_TRUE(loaded.ImportSnapshot(snapshot, checksum));
+    const auto& bodies = catalog.GetBodies();
+    const auto& loadedBodies = loaded.GetBodies();
+    ASSERT_EQ(bodies.size(), loadedBodies.size());
+    for (std::size_t index = 0; index < bodies.size(); ++index) {
+        ASSERT_EQ(bodies[index].Name, loadedBodies[index].Name);
+        ASSERT_EQ(bodies[index].Designation, loadedBodies[index].Designation);
+        ASSERT_EQ(bodies[index].AbbreviatedDescription, loadedBodies[index].AbbreviatedDescription);
+        ASSERT_EQ(bodies[index].Const.Abbreviation, loadedBodies[index].Const.Abbreviation);
+        ASSERT_EQ(bodies[index].Type, loadedBodies[index].Type);
+        ASSERT_EQ(bodies[index].Position.RightAscension, loadedBodies[index].Position.RightAscension);
+        ASSERT_EQ(bodies[index].Position.Declination, loadedBodies[index].Position.Declination);
+    }
+    ASSERT_EQ(loaded.FindFixedHandleByDesignation("NGC224"), loaded.FindFixedHandleByName("Messier 31"));
+    ASSERT_TRUE(loaded.FindFixedByDesignation("IC434") != nullptr);
+
+    // The strings are used in place, and the stored permutations equal the ones of the imported catalog
+    const auto& m31 = loadedBodies[loaded.FindFixedHandleByName("Messier 31")->Index];
+    ASSERT_TRUE(m31.Name.data() >= snapshot.data() && m31.Name.data() < snapshot.data() + snapshot.size());
+    for (std::size_t key = 0; key < ephemeris::SortKeyCount; ++key) {
+        const auto sortKey = static_cast<ephemeris::SortKey>(key);
+        ASSERT_EQ(catalog.GetOrder(sortKey), loaded.GetOrder(sortKey));
+    }
+
+    // The attribute column is taken from the snapshot, so filters match as on the imported catalog
+    ephemeris::Catalog::Filter filter{};
+    filter.Classifications.set(static_cast<usize>(ephemeris::Classification::Galaxy));
+    filter.Constellations.set(ephemeris::FindConstellation("And"));
+    const auto filtered = catalog.FilterFixed(filter);
+    const auto loadedFiltered = loaded.FilterFixed(filter);
+    ASSERT_FALSE(filtered.empty());
+    ASSERT_EQ(filtered.size(), loadedFiltered.size());
+    for (std::size_t index = 0; index < filtered.size(); ++index) {
+        ASSERT_EQ(filtered[index].Index, loadedFiltered[index].Index);
+    }
+
+    // Identifier searches use the stored trigram index, the declination bands use the stored declination order
+    ephemeris::Catalog::Filter search{};
+    search.Identifier = "nebula";
+    const auto searched = catalog.FilterFixed(search);
+    const auto loadedSearched = loaded.FilterFixed(search);
+    ASSERT_FALSE(searched.empty());
+    ASSERT_EQ(searched.size(), loadedSearched.size());
+    for (std::size_t index = 0; index < searched.size(); ++index) {
+        ASSERT_EQ(searched[index].Index, loadedSearched[index].Index);
+    }
+    const ephemeris::Catalog::VisibilityFilter visibility{ 30.0, { 48.2, 16.4 } };
+    ASSERT_EQ(catalog.ClassifyFixed(visibility)->Of, loaded.ClassifyFixed(visibility)->Of);
+
+    // Shared copies own their strings and outlive the string pool, that the next import replaces
+    const auto shared = loaded.FindFixedByName("Messier 31");
+    ASSERT_TRUE(shared != nullptr);
+    const auto constellation = std::string{ shared->Const.Abbreviation };
+    ASSERT_TRUE(loaded.ImportSnapshot(snapshot, checksum));
+    ASSERT_EQ(shared->Name, "Messier 31");
+    ASSERT_EQ(shared->Designation, "NGC224");
+    ASSERT_EQ(shared->Const.Abbreviation, constellation);
+    ASSERT_EQ(shared->Name.data()[shared->Name.size()], '\0');
+
+    // Stale, truncated and foreign snapshots are rejected and leave the catalog untouched
+    const auto staleChecksum = ephemeris::Catalog::SourceChecksum(ngcData, nameData.substr(1));
+    ASSERT_NE(checksum, staleChecksum);
+    ephemeris::Catalog rejected;
+    ASSERT_FALSE(rejected.ImportSnapshot(snapshot, staleChecksum));
+    ASSERT_FALSE(rejected.ImportSnapshot(std::string_view{ snapshot }.substr(0, snapshot.size() - 1), checksum));
+    ASSERT_FALSE(rejected.ImportSnapshot(ngcData, checksum));
+    ASSERT_TRUE(rejected.GetBodies().empty());
+}
+
+TEST(Engine, CatalogObserveFixed) {
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+
+    const ephemeris::Geographic observer{ 48.2, 16.4 };
+    const DateTime date{ 2023, 3, 14, 21, 30, 0 };
+    const auto utc = Clock::ToUtc(Instant::FromDateTime(date));
+    const auto result = catalog.ObserveFixed(utc, observer);
+    const auto& bodies = catalog.GetBodies();
+    ASSERT_EQ(result.Altitudes.size(), bodies.size());
+
+    for (std::size_t index = 0; index < bodies.size(); index += 97) {
+        const auto& body = bodies[index];
+        const auto expected = ObserveGeographic(body.GetEquatorialPosition(utc), observer, utc);
+        ASSERT_NEAR(expected.Altitude, result.Altitudes[index], 1e-6);
+        if (std::fabs(expected.Altitude) < 89.9) {
+            ASSERT_NEAR(expected.Azimuth, result.Azimuths[index], 1e-6);
+        }
+    }
+
+    // The visibility filter has to agree with the kernel
+    Clock::Inject(date);
+    ephemeris::Catalog::Filter filter{};
+    filter.Visibility = ephemeris::Catalog::VisibilityFilter{ 18.0, observer };
+    const auto visible = catalog.FilterFixed(filter);
+    Clock::Release();
+    const auto expectedCount = std::count_if(result.Altitudes.begin(), result.Altitudes.end(),
+                                             [](f64 altitude) { return altitude >= 18.0; });
+    ASSERT_EQ(static_cast<std::ptrdiff_t>(visible.size()), expectedCount);
+}
+
+TEST(Engine, PlanetCache) {
+    const auto planetData = ReadFile("assets/ephemeris/planets.json");
+    ephemeris::Catalog catalog;
+    catalog.ImportPlanets(planetData);
+    ephemeris::PlanetCache::SetEnabled(true);
+
+    const auto begin = 0.23;
+    const auto step = ephemeris::PlanetCacheInterval / 5.0;
+    for (const auto& planet : catalog.GetPlanets()) {
+        ASSERT_FALSE(ephemeris::PlanetCache::Lookup(*planet, begin).has_value());
+    }
+    ephemeris::PlanetCache::Wait();
+
+    for (const auto& planet : catalog.GetPlanets()) {
+        for (auto t = begin; t < begin + 20.0 * step; t += step) {
+            const auto direct = planet->ComputeEclipticVector(t);
+            if (const auto cached = ephemeris::PlanetCache::Lookup(*planet, t)) {
+                ASSERT_LT((*cached - direct).Length() / direct.Length(), ephemeris::PlanetCacheTolerance);
+            }
+            ephemeris::PlanetCache::Wait();
+        }
+        ASSERT_TRUE(ephemeris::PlanetCache::Lookup(*planet, begin + 20.0 * step).has_value());
+    }
+    ASSERT_LE(ephemeris::PlanetCache::MaximumError(), ephemeris::PlanetCacheTolerance);
+
+    ephemeris::PlanetCache::SetEnabled(false);
+    ephemeris::PlanetCache::Clear();
+}
+
+TEST(Engine, SolarSystemSnapshot) {
+    const auto planetData = ReadFile("assets/ephemeris/planets.json");
+    ephemeris::Catalog catalog;
+    catalog.ImportPlanets(planetData);
+
+    const auto utc = Instant::FromDateTime({ 2023, 3, 14, 21, 30, 0 });
+    const auto& planets = catalog.GetPlanets();
+    const ephemeris::SolarSystemSnapshot snapshot{ planets, utc };
+    ASSERT_EQ(snapshot.Size(), planets.size());
+    for (std::size_t index = 0; index < planets.size(); ++index) {
+        const auto expected = planets[index]->GetEquatorialPosition(utc);
+        const auto& position = snapshot.GetEquatorialPosition(index);
+        ASSERT_NEAR(expected.RightAscension, position.RightAscension, 1e-9);
+        ASSERT_NEAR(expected.Declination, position.Declination, 1e-9);
+        ASSERT_NEAR(expected.Radius, position.Radius, 1e-12);
+        ASSERT_TRUE(snapshot.Find(*planets[index]).has_value());
+    }
+    ASSERT_FALSE(snapshot.Find(ephemeris::Planet{}).has_value());
+}
+
+TEST(Engine, RiseSetFixed) {
+    const ephemeris::Geographic observer{ 48.2, 16.4 };
+    ephemeris::RiseSetInfo info{};
+    info.Begin = Instant::FromDateTime({ 2023, 3, 14, 12, 0, 0 });
+    info.End = Instant::FromDateTime({ 2023, 3, 16, 12, 0, 0 });
+    info.Observer = observer;
+    info.AltitudeThreshold = 10.0;
+
+    // Orion nebula rises and sets every day, polaris is circumpolar and a southern object never rises
+    ephemeris::FixedBody body{};
+    body.Position = { 1.0, 83.8, -5.4 };
+    const auto result = ComputeRiseSet(body, info);
+    ASSERT_EQ(result.Kind, ephemeris::Passage::Regular);
+    ASSERT_EQ(result.Rises.size(), 2u);
+    ASSERT_EQ(result.Sets.size(), 2u);
+    ASSERT_EQ(result.Culminations.size(), 2u);
+    for (const auto& event : result.Rises) {
+        const auto horizontal = ObserveGeographic(body.GetEquatorialPosition(event), observer, event);
+        ASSERT_NEAR(horizontal.Altitude, info.AltitudeThreshold, 1e-2);
+    }
+    for (const auto& window : result.Windows) {
+        ASSERT_LT(window.Begin, window.End);
+    }
+
+    body.Position = { 1.0, 37.95, 89.26 };
+    ASSERT_EQ(ComputeRiseSet(body, info).Kind, ephemeris::Passage::Circumpolar);
+    body.Position = { 1.0, 37.95, -70.0 };
+    ASSERT_EQ(ComputeRiseSet(body, info).Kind, ephemeris::Passage::NeverRises);
+}
+
+TEST(Engine, RiseSetPlanet) {
+    const auto planetData = ReadFile("assets/ephemeris/planets.json");
+    ephemeris::Catalog catalog;
+    catalog.ImportPlanets(planetData);
+    const auto planet = catalog.FindPlanetByName("Jupiter");
+    ASSERT_TRUE(planet != nullptr);
+
+    const ephemeris::Geographic observer{ 48.2, 16.4 };
+    ephemeris::RiseSetInfo info{};
+    info.Begin = Instant::FromDateTime({ 2023, 3, 14, 0, 0, 0 });
+    info.End = Instant::FromDateTime({ 2023, 3, 15, 0, 0, 0 });
+    info.Observer = observer;
+    info.AltitudeThreshold = 0.0;
+
+    const auto result = ComputeRiseSet(*planet, info);
+    ASSERT_EQ(result.Kind, ephemeris::Passage::Regular);
+    ASSERT_EQ(result.Rises.size(), 1u);
+    ASSERT_EQ(result.Sets.size(), 1u);
+    ASSERT_EQ(result.Culminations.size(), 1u);
+    ASSERT_LT(result.Evaluations, 100u);
+
+    const auto altitudeAt = [&](const Instant& instant) {
+        return ObserveGeographic(planet->GetEquatorialPosition(instant), observer, instant).Altitude;
+    };
+    ASSERT_NEAR(altitudeAt(result.Rises.front()), 0.0, 1e-2);
+    ASSERT_NEAR(altitudeAt(result.Sets.front()), 0.0, 1e-2);
+
+    auto before = result.Culminations.front();
+    auto after = result.Culminations.front();
+    before.AddSeconds(-60);
+    after.AddSeconds(60);
+    ASSERT_GT(altitudeAt(result.Culminations.front()), altitudeAt(before));
+    ASSERT_GT(altitudeAt(result.Culminations.front()), altitudeAt(after));
+}
+
+TEST(Engine, HorizonProfile) {
+    const auto horizon = ephemeris::HorizonProfile::Parse("# Site\n0 5\n90\t20 # trees\n\n180 5\n270 30\n");
+    ASSERT_TRUE(horizon.has_value());
+    ASSERT_EQ(horizon->GetPoints().size(), 4u);
+    ASSERT_NEAR(horizon->Altitude(45.0), 12.5, 0.05);
+    ASSERT_NEAR(horizon->Altitude(315.0), 17.5, 0.05);
+    ASSERT_NEAR(horizon->Lowest(), 5.0, 0.05);
+    ASSERT_NEAR(horizon->Highest(), 30.0, 0.05);
+    ASSERT_FALSE(ephemeris::HorizonProfile::Parse("0 5\nwall\n").has_value());
+    ASSERT_FALSE(ephemeris::HorizonProfile::Parse("# empty\n").has_value());
+    ASSERT_NEAR(ephemeris::HorizonProfile{}.Altitude(123.0), 0.0, 1e-12);
+
+    // The lookup by direction agrees with the lookup by azimuth
+    for (f64 azimuth = 0.0; azimuth < 360.0; azimuth += 7.0) {
+        const auto x = -std::cos(azimuth * M_PI / 180.0);
+        const auto y = -std::sin(azimuth * M_PI / 180.0);
+        ASSERT_NEAR(horizon->SineAltitude(x, y), std::sin(horizon->Altitude(azimuth) * M_PI / 180.0), 1e-12);
+    }
+
+    // Visibility against the horizon agrees with the altitudes and azimuths of the catalog
+    const auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+    ephemeris::BodyColumns columns;
+    columns.Assign(catalog.GetBodies());
+    const ephemeris::Geographic observer{ 48.2, 16.4 };
+    const auto utc = Instant::FromDateTime({ 2022, 3, 1, 22, 0, 0 });
+    const auto observed = catalog.ObserveFixed(utc, observer);
+    std::vector<u8> visible{};
+    columns.Visible(ephemeris::BodyColumns::HorizontalMatrix(utc, observer), 10.0, visible, &*horizon);
+    for (usize index = 0; index < visible.size(); ++index) {
+        const auto required = std::max(10.0, horizon->Altitude(observed.Azimuths[index]));
+        if (std::fabs(observed.Altitudes[index] - required) > 1e-6) {
+            ASSERT_EQ(visible[index] != 0, observed.Altitudes[index] >= required) << index;
+        }
+    }
+
+    // The events of a fixed body are on the horizon
+    ephemeris::RiseSetInfo info{};
+    info.Begin = Instant::FromDateTime({ 2023, 3, 14, 12, 0, 0 });
+    info.End = Instant::FromDateTime({ 2023, 3, 16, 12, 0, 0 });
+    info.Observer = observer;
+    info.AltitudeThreshold = 10.0;
+    info.SearchStepSeconds = 600.0;
+    info.Horizon = std::make_shared<ephemeris::HorizonProfile>(*horizon);
+    ephemeris::FixedBody body{};
+    body.Position = { 1.0, 83.8, -5.4 };
+    const auto result = ComputeRiseSet(body, info);
+    ASSERT_EQ(result.Kind, ephemeris::Passage::Regular);
+    ASSERT_EQ(result.Rises.size(), 2u);
+    ASSERT_EQ(result.Sets.size(), 2u);
+    for (const auto& event : result.Rises) {
+        const auto horizontal = ObserveGeographic(body.GetEquatorialPosition(event), observer, event);
+        ASSERT_NEAR(horizontal.Altitude, std::max(10.0, horizon->Altitude(horizontal.Azimuth)), 1e-2);
+    }
+
+    // The culminations are the meridian transits of the closed-form search, regardless of the slope of the horizon
+    auto flat = info;
+    flat.Horizon = nullptr;
+    const auto transits = ComputeRiseSet(body, flat).Culminations;
+    ASSERT_EQ(result.Culminations.size(), transits.size());
+    for (usize index = 0; index < transits.size(); ++index) {
+        const auto difference = static_cast<f64>(result.Culminations[index] - transits[index]);
+        ASSERT_LT(std::fabs(difference) / static_cast<f64>(Instant::NanosecondsPerSecond), 30.0);
+    }
+}
+
+TEST(Engine, Almanac) {
+    // The bodies up to a right ascension of about six hours, which include Andromeda and Orion
+    auto ngcData = ReadFile("assets/ephemeris/ngc2000.dat");
+    usize end = 0;
+    for (usize line = 0; line < 3200; ++line) {
+        end = ngcData.find('\n', end) + 1;
+    }
+    ngcData.resize(end);
+    const auto nameData = ReadFile("assets/ephemeris/names.dat");
+    ephemeris::Catalog catalog;
+    catalog.ImportFixed(ngcData, nameData);
+    const auto checksum = ephemeris::Catalog::SourceChecksum(ngcData, nameData);
+
+    ephemeris::AlmanacInfo info{};
+    info.Observer = { 48.2, 16.4 };
+    info.Year = 2023;
+    info.AltitudeThreshold = 20.0;
+    info.Threads = 4;
+    const auto data = ephemeris::Almanac::Generate(catalog, info, checksum);
+    const auto almanac = ephemeris::Almanac::Open(data, info, checksum);
+    ASSERT_TRUE(almanac.has_value());
+    ASSERT_EQ(almanac->BodyCount(), catalog.GetBodies().size());
+    ASSERT_FALSE(ephemeris::Almanac::Open(data, info, checksum + 1).has_value());
+    ASSERT_FALSE(ephemeris::Almanac::Open(data.substr(0, data.size() - 1), info, checksum).has_value());
+    auto other = info;
+    other.SunAltitude = -18.0;
+    ASSERT_FALSE(ephemeris::Almanac::Open(data, other, checksum).has_value());
+
+    // The generation does not depend on the number of threads
+    other = info;
+    other.Threads = 1;
+    ASSERT_EQ(ephemeris::Almanac::Generate(catalog, other, checksum), data);
+
+    // The lookups agree with the altitudes of the sun and the bodies, away from the rounded events
+    const ephemeris::Planet sun{ "Sun", {}, {} };
+    const auto andromeda = *catalog.FindFixedHandleByDesignation("NGC224");
+    const auto orion = *catalog.FindFixedHandleByDesignation("NGC1976");
+    const auto yearEnd = Instant::FromDateTime({ 2024, 1, 1, 0, 0, 0 });
+    for (auto utc = Instant::FromDateTime({ 2023, 1, 1, 0, 7, 0 }); utc < yearEnd;
+         utc.AddNanoseconds(Instant::NanosecondsPerDay / 24 + 600 * Instant::NanosecondsPerSecond)) {
+        const auto sunAltitude = ObserveGeographic(sun.GetEquatorialPosition(utc), info.Observer, utc).Altitude;
+        for (const auto handle : { andromeda, orion }) {
+            const auto& body = catalog.GetBodies()[handle.Index];
+            const auto altitude = ObserveGeographic(body.GetEquatorialPosition(utc), info.Observer, utc).Altitude;
+
+            // Two minutes change the altitude by at most half a degree
+            if (std::fabs(sunAltitude - info.SunAltitude) < 0.5 || std::fabs(altitude - info.AltitudeThreshold) < 0.5) {
+                continue;
+            }
+            const auto expected = sunAltitude < info.SunAltitude && altitude > info.AltitudeThreshold;
+            ASSERT_EQ(almanac->IsObservable(handle, utc), expected) << handle.Index;
+        }
+    }
+
+    // The best minute of a window is at least as high as both of its ends
+    const auto& body = catalog.GetBodies()[orion.Index];
+    const auto windows = almanac->WindowsOf(orion);
+    ASSERT_FALSE(windows.empty());
+    for (const auto& window : windows) {
+        const auto altitudeAt = [&](s64 minute) {
+            const auto utc = almanac->InstantOf(minute);
+            return ObserveGeographic(body.GetEquatorialPosition(utc), info.Observer, utc).Altitude;
+        };
+        const auto best = altitudeAt(window.Begin + window.Best);
+        ASSERT_GE(best + 1e-6, altitudeAt(window.Begin));
+        ASSERT_GE(best + 1e-6, altitudeAt(window.Begin + window.Minutes - 1));
+    }
+
+    // Orion is high in the winter nights and below the threshold in the summer nights
+    ASSERT_TRUE(almanac->Tonight(orion, Instant::FromDateTime({ 2023, 1, 15, 20, 0, 0 })).has_value());
+    ASSERT_FALSE(almanac->Tonight(orion, Instant::FromDateTime({ 2023, 6, 21, 20, 0, 0 })).has_value());
+    ASSERT_TRUE(almanac->Night(Instant::FromDateTime({ 2023, 6, 21, 22, 0, 0 })).has_value());
+    const std::vector<ephemeris::FixedHandle> handles{ andromeda, orion };
+    ASSERT_EQ(almanac->FilterTonight(handles, Instant::FromDateTime({ 2023, 6, 21, 20, 0, 0 })).size(), 1u);
+
+    // A horizon identifies the almanac as well, and the bodies have to be above it. Only the two bodies are
+    // searched, as parts of the nights are sampled against the horizon
+    const auto lineOf = [&ngcData](const std::string& prefix) {
+        const auto begin = ngcData.find("\n" + prefix) + 1;
+        return ngcData.substr(begin, ngcData.find('\n', begin) + 1 - begin);
+    };
+    const auto pairData = lineOf("  224 ") + lineOf(" 1976 ");
+    ephemeris::Catalog pair;
+    pair.ImportFixed(pairData, nameData);
+    const auto pairChecksum = ephemeris::Catalog::SourceChecksum(pairData, nameData);
+    auto obstructed = info;
+    const std::vector<ephemeris::HorizonProfile::Point> points{
+        { 0.0, 0.0 }, { 90.0, 10.0 }, { 180.0, 45.0 }, { 270.0, 10.0 }
+    };
+    obstructed.Horizon = std::make_shared<const ephemeris::HorizonProfile>(points);
+    const auto obstructedData = ephemeris::Almanac::Generate(pair, obstructed, pairChecksum);
+    ASSERT_FALSE(ephemeris::Almanac::Open(obstructedData, info, pairChecksum).has_value());
+    const auto flatData = ephemeris::Almanac::Generate(pair, info, pairChecksum);
+    ASSERT_FALSE(ephemeris::Almanac::Open(flatData, obstructed, pairChecksum).has_value());
+    const auto obstructedAlmanac = ephemeris::Almanac::Open(obstructedData, obstructed, pairChecksum);
+    ASSERT_TRUE(obstructedAlmanac.has_value());
+    ASSERT_EQ(obstructedAlmanac->BodyCount(), 2u);
+    for (auto utc = Instant::FromDateTime({ 2023, 1, 1, 0, 7, 0 }); utc < yearEnd;
+         utc.AddNanoseconds(Instant::NanosecondsPerDay / 24 + 600 * Instant::NanosecondsPerSecond)) {
+        const auto sunAltitude = ObserveGeographic(sun.GetEquatorialPosition(utc), info.Observer, utc).Altitude;
+        for (const auto designation : { "NGC224", "NGC1976" }) {
+            const auto handle = *pair.FindFixedHandleByDesignation(designation);
+            const auto& body = pair.GetBodies()[handle.Index];
+            const auto position = ObserveGeographic(body.GetEquatorialPosition(utc), info.Observer, utc);
+            const auto required = std::max(info.AltitudeThreshold, obstructed.Horizon->Altitude(position.Azimuth));
+            if (std::fabs(sunAltitude - info.SunAltitude) < 0.5 || std::fabs(position.Altitude - required) < 1.0) {
+                continue;
+            }
+            const auto expected = sunAltitude < info.SunAltitude && position.Altitude > required;
+            ASSERT_EQ(obstructedAlmanac->IsObservable(handle, utc), expected) << designation;
+        }
+    }
+
+    // A horizon below the threshold never obstructs, so the windows are those of the flat horizon
+    auto low = info;
+    low.Horizon = std::make_shared<const ephemeris::HorizonProfile>(
+            std::vector<ephemeris::HorizonProfile::Point>{ { 0.0, 5.0 }, { 180.0, 15.0 } });
+    const auto lowData = ephemeris::Almanac::Generate(pair, low, pairChecksum);
+    const auto lowAlmanac = ephemeris::Almanac::Open(lowData, low, pairChecksum);
+    const auto flatAlmanac = ephemeris::Almanac::Open(flatData, info, pairChecksum);
+    ASSERT_TRUE(lowAlmanac.has_value() && flatAlmanac.has_value());
+    for (u32 index = 0; index < 2; ++index) {
+        const auto lowWindows = lowAlmanac->WindowsOf({ index });
+        const auto flatWindows = flatAlmanac->WindowsOf({ index });
+        ASSERT_EQ(lowWindows.size(), flatWindows.size());
+        for (std::size_t window = 0; window < lowWindows.size(); ++window) {
+            ASSERT_EQ(lowWindows[window].Begin, flatWindows[window].Begin);
+            ASSERT_EQ(lowWindows[window].Minutes, flatWindows[window].Minutes);
+        }
+    }
+}
+
+TEST(Engine, ComputeGeographicSiderealRecurrence) {
+    auto body = std::make_shared<ephemeris::FixedBody>();
+    body->Position = { 1.0, 83.8, -5.4 };
+
+    ephemeris::ComputeInfo info{};
+    info.Date = { 2023, 3, 14, 21, 30, 0 };
+    info.Observer = { 48.2, 16.4 };
+    info.Steps = 7200;
+    info.StepSize = 1;
+    info.Unit = DateTime::Unit::Minutes;
+    const auto expected = ComputeGeographic(body, info);
+
+    info.SiderealRecurrence = true;
+    info.RecurrenceTolerance = 1e-4;
+    const auto recurrent = ComputeGeographic(body, info);
+    ASSERT_EQ(recurrent.Altitudes.size(), expected.Altitudes.size());
+    for (std::size_t step = 0; step < info.Steps; ++step) {
+        ASSERT_NEAR(expected.Altitudes[step], recurrent.Altitudes[step], 2e-4);
+        ASSERT_NEAR(expected.Azimuths[step], recurrent.Azimuths[step], 2e-4);
+    }
+}
+
+TEST(Engine, ComputeGeographicParallel) {
+    const auto planetData = ReadFile("assets/ephemeris/planets.json");
+    ephemeris::Catalog catalog;
+    catalog.ImportPlanets(planetData);
+    const auto planet = catalog.FindPlanetByName("Mars");
+    ASSERT_TRUE(planet != nullptr);
+    auto body = std::make_shared<ephemeris::FixedBody>();
+    body->Position = { 1.0, 83.8, -5.4 };
+
+    ephemeris::ComputeInfo info{};
+    info.Date = { 2023, 3, 14, 21, 30, 0 };
+    info.Observer = { 48.2, 16.4 };
+    info.Steps = 10000;
+    for (const auto unit : { DateTime::Unit::Minutes, DateTime::Unit::Days, DateTime::Unit::Months }) {
+        for (const auto recurrence : { false, true }) {
+            info.Unit = unit;
+            info.SiderealRecurrence = recurrence;
+            info.ReanchorInterval = 700;
+            info.Threads = 1;
+            const auto sequentialPlanet = ComputeGeographic(planet, info);
+            const auto sequentialFixed = ComputeGeographic(body, info);
+            info.Threads = 4;
+            const auto parallelPlanet = ComputeGeographic(planet, info);
+            const auto parallelFixed = ComputeGeographic(body, info);
+            ASSERT_EQ(sequentialPlanet.Altitudes, parallelPlanet.Altitudes);
+            ASSERT_EQ(sequentialPlanet.Azimuths, parallelPlanet.Azimuths);
+            ASSERT_EQ(sequentialFixed.Altitudes, parallelFixed.Altitudes);
+            ASSERT_EQ(sequentialFixed.Azimuths, parallelFixed.Azimuths);
+        }
+    }
+}
+
+TEST(Engine, ComputeGeographicCachedPlanet) {
+    const auto planetData = ReadFile("assets/ephemeris/planets.json");
+    ephemeris::Catalog catalog;
+    catalog.ImportPlanets(planetData);
+    const auto planet = catalog.FindPlanetByName("Mars");
+    ASSERT_TRUE(planet != nullptr);
+
+    ephemeris::ComputeInfo info{};
+    info.Date = { 2023, 3, 14, 21, 30, 0 };
+    info.Observer = { 48.2, 16.4 };
+    info.Steps = 10000;
+    info.Unit = DateTime::Unit::Hours;
+    const auto direct = ComputeGeographic(planet, info);
+
+    // The results must not depend on which fits the background worker has finished
+    ephemeris::PlanetCache::SetEnabled(true);
+    const auto first = ComputeGeographic(planet, info);
+    const auto second = ComputeGeographic(planet, info);
+    info.Threads = 4;
+    const auto parallel = ComputeGeographic(planet, info);
+    ASSERT_EQ(first.Altitudes, second.Altitudes);
+    ASSERT_EQ(first.Azimuths, second.Azimuths);
+    ASSERT_EQ(first.Altitudes, parallel.Altitudes);
+    ASSERT_EQ(first.Azimuths, parallel.Azimuths);
+    for (std::size_t step = 0; step < info.Steps; ++step) {
+        ASSERT_NEAR(first.Altitudes[step], direct.Altitudes[step], 1.0e-3);
+    }
+
+    // Fits that were scheduled before a clear are never inserted
+    const auto later = 1.5;
+    ASSERT_FALSE(ephemeris::PlanetCache::Lookup(*planet, later).has_value());
+    ephemeris::PlanetCache::Clear();
+    ephemeris::PlanetCache::Wait();
+    ASSERT_FALSE(ephemeris::PlanetCache::Lookup(*planet, later).has_value());
+
+    ephemeris::PlanetCache::SetEnabled(false);
+    ephemeris::PlanetCache::Clear();
+}
+
+TEST(Engine, ClockUtcOffset) {
+    const DateTime local{ 2021, 11, 2, 22, 15, 30 };
+    auto expected = local;
+    expected.AddSeconds(DateTime::Difference(DateTime::Now(), DateTime::Utc()));
+    ASSERT_EQ(Clock::ToUtc(local), expected);
+    ASSERT_EQ(Clock::UtcOffset(), Clock::UtcOffset());
+}
+
+TEST(Engine, ClockSnapshot) {
+    const DateTime snapshot{ 1999, 8, 11, 12, 0, 0 };
+    Clock::Inject(snapshot);
+    ASSERT_EQ(Clock::Now(), snapshot);
+    Clock::Release();
+    ASSERT_NE(Clock::Now(), snapshot);
+}
+
+TEST(Engine, ClockSiderealTime) {
+    const DateTime utc{ 2010, 6, 21, 3, 45, 12 };
+    const auto expected = DateTime::GreenwichMeanSiderealTime(utc);
+    ASSERT_NEAR(Clock::GreenwichMeanSiderealTime(DateTime::JulianDayNumber(utc)), expected, 1e-6);
+    ASSERT_NEAR(Clock::GreenwichMeanSiderealTime(2455368.5, 0.156388888888889), expected, 1e-6);
+}
+
+TEST(Engine, InstantDateTimeRoundTrip) {
+    const DateTime dates[] = { { 1990, 12, 31, 23, 59, 59, 999 },
+                               { 2004, 2, 29, 12, 0, 0 },
+                               { 1969, 7, 20, 20, 17, 40, 250 },
+                               { 1582, 10, 15, 0, 0, 0 } };
+    for (const auto& date : dates) {
+        const auto converted = Instant::FromDateTime(date).ToDateTime();
+        ASSERT_EQ(converted, date);
+        ASSERT_EQ(converted.Millisecond, date.Millisecond);
+    }
+}
+
+TEST(Engine, InstantAdd) {
+    {
+        auto instant = Instant::FromDateTime({ 1995, 1, 1, 0, 0, 4 });
+        instant.AddSeconds(-5);
+        const DateTime expected{ 1994, 12, 31, 23, 59, 59 };
+        ASSERT_EQ(instant.ToDateTime(), expected);
+    }
+    {
+        auto instant = Instant::FromDateTime({ 2020, 1, 31, 12, 0, 13 });
+        instant.Add(37, DateTime::Unit::Hours);
+        const DateTime expected{ 2020, 2, 2, 1, 0, 13 };
+        ASSERT_EQ(instant.ToDateTime(), expected);
+    }
+    {
+        auto instant = Instant::FromDateTime({ 2002, 1, 10, 12, 12, 12 });
+        instant.AddMonths(-25);
+        const DateTime expected{ 1999, 12, 10, 12, 12, 12 };
+        ASSERT_EQ(instant.ToDateTime(), expected);
+    }
+    {
+        auto instant = Instant::FromDateTime({ 1900, 4, 11, 7, 50, 3 });
+        instant.AddYears(69);
+        const DateTime expected{ 1969, 4, 11, 7, 50, 3 };
+        ASSERT_EQ(instant.ToDateTime(), expected);
+    }
+    {
+        const auto a = Instant::FromDateTime({ 2007, 2, 27, 9, 1, 48 });
+        const auto b = Instant::FromDateTime({ 2007, 3, 1, 9, 1, 48 });
+        ASSERT_EQ(b - a, 2 * Instant::NanosecondsPerDay);
+        ASSERT_LT(a, b);
+    }
+}
+
+TEST(Engine, InstantJulianDay) {
+    const DateTime date{ 2023, 8, 17, 18, 42, 11, 500 };
+    const auto instant = Instant::FromDateTime(date);
+    ASSERT_NEAR(instant.JulianDay(), DateTime::JulianDayNumber(date), 1e-8);
+    ASSERT_NEAR(instant.JulianCenturies(), DateTime::JulianCenturies(date), 1e-12);
+    ASSERT_EQ(Instant::FromJulianDay(instant.JulianDay()).ToDateTime(), date);
+}
+
+TEST(Engine, PerfectHashTable) {
+    using Table = utility::PerfectHashTable<u32, 5>;
+    constexpr Table table{ std::array<Table::Entry, 5>{ {
+            { "Gx", 0 },
+            { "OC", 1 },
+            { "", 2 },
+            { "***", 3 },
+            { "*", 4 },
+    } } };
+    static_assert(table.Valid());
+    static_assert(*table.Find("***") == 3);
+    static_assert(table.Find("**") == nullptr);
+
+    constexpr std::array<std::string_view, 5> keys = { "Gx", "OC", "", "***", "*" };
+    for (u32 value = 0; value < keys.size(); ++value) {
+        ASSERT_NE(table.Find(keys[value]), nullptr);
+        ASSERT_EQ(*table.Find(keys[value]), value);
+    }
+    ASSERT_EQ(table.Find("gx"), nullptr);
+    ASSERT_EQ(table.Find("Gx "), nullptr);
+
+    ASSERT_EQ(ephemeris::ClassificationFromCode("C+N"), ephemeris::Classification::Cluster);
+    ASSERT_EQ(ephemeris::ClassificationFromCode(""), ephemeris::Classification::Unidentified);
+    ASSERT_FALSE(ephemeris::ClassificationFromCode("Xx").has_value());
+}
+
+namespace {
+
+    /**
+     * Body kind, that only the tests know of. It is fixed like a catalog body, but does not allow the recurrence
+     */
+    struct Beacon {
+        ephemeris::FixedBody Body;
+    };
+}// namespace
+
+namespace ephemeris {
+
+    template<>
+    struct PositionProvider<Beacon> {
+        static constexpr bool FixedOnSphere = false;
+
+        explicit PositionProvider(const Beacon& beacon) noexcept : fixed(beacon.Body) { }
+
+        Vector3 operator()(f64 julianCenturies) const noexcept {
+            return fixed(julianCenturies);
+        }
+
+    private:
+        PositionProvider<FixedBody> fixed;
+    };
+}// namespace ephemeris
+
+TEST(Engine, ComputeGeographicCustomBody) {
+    static_assert(ephemeris::IsBody<ephemeris::Planet>::value && ephemeris::IsBody<ephemeris::FixedBody>::value);
+    static_assert(ephemeris::IsBody<Beacon>::value && !ephemeris::IsBody<int>::value);
+
+    auto beacon = std::make_shared<Beacon>();
+    beacon->Body.Position = { 1.0, 83.8, -5.4 };
+
+    ephemeris::ComputeInfo info{};
+    info.Date = { 2023, 3, 14, 21, 30, 0 };
+    info.Observer = { 48.2, 16.4 };
+    info.Steps = 2000;
+    info.Threads = 4;
+    for (const auto unit : { DateTime::Unit::Minutes, DateTime::Unit::Months }) {
+        info.Unit = unit;
+        info.SiderealRecurrence = false;
+        const auto expected = ComputeGeographic(beacon->Body, info);
+
+        // The recurrence is a fast path of fixed bodies only, so the beacon takes the full computation
+        info.SiderealRecurrence = true;
+        const auto result = ComputeGeographic(beacon, info);
+        ASSERT_EQ(result.Altitudes, expected.Altitudes);
+        ASSERT_EQ(result.Azimuths, expected.Azimuths);
+    }
+}
@@ -1,6 +1,5 @@
 #include <filesystem>
 #include <iostream>
-#include <unordered_set>
 #include <vector>
 #include <sstream>
 
@@ -16,16 +15,18 @@ namespace {
 
     void ExportComputeResult(std::string_view identifier,
                              const ephemeris::ComputeResult& result,
-                             ephemeris::ComputeInfo info) {
+                             const ephemeris::ComputeInfo& info) {
         std::stringstream file;
         file << fmt::format("{};;\n", identifier);
         file << fmt::format("{};{};\n", info.Observer.Latitude, info.Observer.Longitude);
         file << fmt::format("{};{};{}\n", info.Steps, info.StepSize, DateTimeUnitToString(info.Unit));
+        const auto start = Instant::FromDateTime(info.Date);
         for (std::size_t i = 0; i < result.Azimuths.size(); ++i) {
-            info.Date.Add(static_cast<std::int64_t>(i * info.StepSize), info.Unit);
+            auto instant = start;
+            instant.Add(static_cast<std::int64_t>(i * info.StepSize), info.Unit);
             const auto azimuth = result.Azimuths[i];
             const auto altitude = result.Altitudes[i];
-            const auto date = info.Date.ToString();
+            const auto date = instant.ToDateTime().ToString();
             file << fmt::format("{};{};{}\n", date, azimuth, altitude);
         }
 
@@ -42,10 +43,58 @@ namespace {
 
     constexpr auto COLOR_RED = ImVec4{ 1.0f, 0.0f, 0.0f, 1.0f };
     constexpr auto COLOR_GREEN = ImVec4{ 0.0f, 1.0f, 0.0f, 1.0f };
+    constexpr auto COLOR_GRAY = ImVec4{ 0.5f, 0.5f, 0.5f, 1.0f };
+
+    /**
+     * Retrieves the horizon profile, if it is loaded and enabled
+     * @return horizon or null
+     */
+    std::shared_ptr<const ephemeris::HorizonProfile> ActiveHorizon() noexcept {
+        if (!Settings::Get<bool>("Catalog-UseHorizon", false)) {
+            return nullptr;
+        }
+        return CatalogManager::GetHorizon();
+    }
+
+    /**
+     * Retrieves the almanac of the site, if it was generated for the current visibility threshold and horizon
+     * @return almanac or null
+     */
+    const ephemeris::Almanac* ActiveAlmanac() noexcept {
+        ephemeris::AlmanacInfo info{};
+        info.Observer = LocationManager::GetGeographic();
+        info.Year = Clock::Now().Year;
+        info.AltitudeThreshold = Settings::Get<double>("Catalog-VisibilityThreshold");
+        info.SunAltitude = Settings::Get<double>("Almanac-SunAltitude", -12.0);
+        info.Horizon = ActiveHorizon();
+        return CatalogManager::GetAlmanac(info);
+    }
+
+    /**
+     * Formats the altitude of a position, which is marked if the horizon obstructs it
+     * @param position Position
+     * @return text
+     */
+    std::string FormatAltitude(const ephemeris::Horizontal& position) noexcept {
+        const auto horizon = ActiveHorizon();
+        if (horizon != nullptr && position.Altitude < horizon->Altitude(position.Azimuth)) {
+            return fmt::format("Altitude: {:.4f} deg (obstructed)", position.Altitude);
+        }
+        return fmt::format("Altitude: {:.4f} deg", position.Altitude);
+    }
 
     void PreviewGraph(const ephemeris::ComputeResult& data, double now, const ImVec2& size) {
         const auto id = fmt::format("##plotId{}", reinterpret_cast<std::intptr_t>(&data));
         const auto count = data.Azimuths.size();
+
+        // Altitude of the horizon along the path of the body, one table fetch per sample
+        std::vector<double> obstruction{};
+        if (const auto horizon = ActiveHorizon()) {
+            obstruction.reserve(count);
+            for (const auto azimuth : data.Azimuths) {
+                obstruction.emplace_back(horizon->Altitude(azimuth));
+            }
+        }
         constexpr auto axisFlags = ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoLabel | ImPlotAxisFlags_NoTickLabels;
 
         if (ImPlot::BeginPlot(id.c_str(), size, ImPlotFlags_NoLegend | ImPlotFlags_NoFrame)) {
@@ -60,6 +109,10 @@ namespace {
             ImPlot::PlotLine<double>(id.c_str(), data.Azimuths.data(), static_cast<int>(count));
             ImPlot::SetNextLineStyle(COLOR_GREEN, 1.0f);
             ImPlot::PlotLine<double>(id.c_str(), data.Altitudes.data(), static_cast<int>(count));
+            if (!obstruction.empty()) {
+                ImPlot::SetNextLineStyle(COLOR_GRAY, 1.0f);
+                ImPlot::PlotLine<double>(id.c_str(), obstruction.data(), static_cast<int>(count));
+            }
             ImPlot::EndPlot();
         }
     }
@@ -73,6 +126,7 @@ namespace {
 
         static ephemeris::ComputeInfo info{};
         info.Observer = LocationManager::GetGeographic();
+        info.Threads = Settings::Get<usize>("Compute-Threads", std::thread::hardware_concurrency());
 
         const auto configId = fmt::format("idChildGraphConfig{}", id);
         {
@@ -309,8 +363,9 @@ namespace {
         }
     }
 
-    void DrawFixedDetails(const std::shared_ptr<ephemeris::FixedBody>& body, std::string_view title) noexcept {
-        const auto& texture = CatalogManager::FetchTexture(body->Designation);
+    void DrawFixedDetails(ephemeris::FixedHandle handle, std::string_view title) noexcept {
+        const auto& body = CatalogManager::GetCatalog().GetFixed(handle);
+        const auto& texture = CatalogManager::FetchTexture(body.Designation);
         const auto& observer = LocationManager::GetGeographic();
         auto& style = ImGui::GetStyle();
         const auto fontSize = ImGui::GetFontSize();
@@ -319,13 +374,13 @@ namespace {
 
         bool open = true;
         if (ImGui::BeginPopupModal(title.data(), &open, ImGuiWindowFlags_Modal)) {
-            const auto tabBarId = fmt::format("idTabBar{}", body->Designation);
+            const auto tabBarId = fmt::format("idTabBar{}", body.Designation);
             if (ImGui::BeginTabBar(tabBarId.c_str())) {
                 if (ImGui::BeginTabItem("Details & Tracking")) {
                     const auto date = Tracker::Handle != nullptr ? Tracker::Handle->GetBegin() : DateTime::Now();
                     {
                         ScopedColor childBackground{ ImGuiCol_ChildBg, style.Colors[ImGuiCol_FrameBg] };
-                        if (ImGui::BeginChild(fmt::format("idChildElementImagePreview{}", body->Designation).c_str(),
+                        if (ImGui::BeginChild(fmt::format("idChildElementImagePreview{}", body.Designation).c_str(),
                                               ImVec2{ ImGui::GetContentRegionAvail().x, imageHeight }, false,
                                               ImGuiWindowFlags_NoScrollbar)) {
                             const auto cursor = ImGui::GetCursorPos();
@@ -339,6 +394,7 @@ namespace {
                             info.Steps = static_cast<std::size_t>(trackingDuration);
                             info.StepSize = 1;
                             info.Unit = DateTime::Unit::Seconds;
+                            info.SiderealRecurrence = true;
                             const auto result = ComputeGeographic(body, info);
 
                             const auto progress = DateTime::Difference(date, DateTime::Now());
@@ -347,7 +403,7 @@ namespace {
                         }
                         ImGui::EndChild();
                         if (ImGui::BeginChild(
-                                    fmt::format("idChildElementPosition{}", body->Designation).c_str(),
+                                    fmt::format("idChildElementPosition{}", body.Designation).c_str(),
                                     { ImGui::GetContentRegionAvail().x, 7.0f * (fontSize + style.ItemInnerSpacing.y) },
                                     false, ImGuiWindowFlags_NoScrollbar)) {
                             if (ImGui::BeginTable("##idTrackingInfoAlignment", 3,
@@ -355,7 +411,7 @@ namespace {
                                                           ImGuiTableFlags_SizingStretchSame,
                                                   ImGui::GetContentRegionAvail())) {
                                 const auto now = DateTime::Now();
-                                const auto equatorialPreview = body->GetEquatorialPosition(now);
+                                const auto equatorialPreview = body.GetEquatorialPosition(now);
                                 const auto horizontalPreview = ObserveGeographic(equatorialPreview, observer, now);
                                 ImGui::TableNextRow();
                                 ImGui::TableNextColumn();
@@ -416,11 +472,11 @@ namespace {
                                 }
                                 ImGui::TableNextRow();
                                 ImGui::TableNextColumn();
-                                ImGui::Text("%s", body->Const.Name.c_str());
+                                ImGui::Text("%s", body.Const.Name.data());
                                 ImGui::TableNextColumn();
-                                ImGui::Text("%s", fmt::format("{:.4f}", body->Magnitude).c_str());
+                                ImGui::Text("%s", fmt::format("{:.4f}", body.Magnitude).c_str());
                                 ImGui::TableNextColumn();
-                                ImGui::Text("%s", fmt::format("{:.4f} '", body->Dimension).c_str());
+                                ImGui::Text("%s", fmt::format("{:.4f} '", body.Dimension).c_str());
 
                                 ImGui::EndTable();
                             }
@@ -459,7 +515,7 @@ namespace {
                                     ImGui::PopStyleVar();
                                 }
                             } else if (ImGui::Button("Track", buttonSize)) {
-                                Tracker::SubmitFixed(body, trackingDuration);
+                                Tracker::SubmitFixed(handle, trackingDuration);
                             }
                             ImGui::EndTable();
                         }
@@ -467,9 +523,11 @@ namespace {
                     ImGui::EndTabItem();
                 }
                 if (ImGui::BeginTabItem("Graph")) {
-                    DrawDetailsGraph(body->Designation,
+                    DrawDetailsGraph(body.Designation,
                                      [&, body](ephemeris::ComputeInfo& info) -> ephemeris::ComputeResult {
-                                         return ComputeGeographic(body, info);
+                                         auto recurrent = info;
+                                         recurrent.SiderealRecurrence = true;
+                                         return ComputeGeographic(body, recurrent);
                                      });
                     ImGui::EndTabItem();
                 }
@@ -479,7 +537,9 @@ namespace {
         }
     }
 
-    bool DrawPlanetInfoCard(const std::shared_ptr<ephemeris::Planet>& planet, const glm::vec2& size) noexcept {
+    bool DrawPlanetInfoCard(const std::shared_ptr<ephemeris::Planet>& planet,
+                            const ephemeris::Horizontal& positionPreview,
+                            const glm::vec2& size) noexcept {
         bool selected = false;
 
         {
@@ -523,18 +583,13 @@ namespace {
                 DrawCursor::Advance(0.0f, fontSize + regulatedItemSpacing);
                 Text::Draw("No Designation", Font::Regular, smallFontSize, baseTextLightColor);
 
-                // Compute the position preview
-                const auto now = DateTime::Now();
-                const auto spherical = planet->GetEquatorialPosition(now);
-                const auto positionPreview = ObserveGeographic(spherical, LocationManager::GetGeographic(), now);
-
                 // Azimuth-Angle of the Celestial Body
                 const auto azimuthText = fmt::format("Azimuth: {:.4f} deg", positionPreview.Azimuth);
                 DrawCursor::Advance(0.0f, smallFontSize + regulatedItemSpacing);
                 Text::Draw(azimuthText, Font::Regular, smallFontSize, baseTextLightColor);
 
                 // Altitude-Angle of the Celestial Body
-                const auto elevationText = fmt::format("Altitude: {:.4f} deg", positionPreview.Altitude);
+                const auto elevationText = FormatAltitude(positionPreview);
                 DrawCursor::Advance(0.0f, smallFontSize + regulatedItemSpacing);
                 Text::Draw(elevationText, Font::Regular, smallFontSize, baseTextLightColor);
             }
@@ -543,14 +598,16 @@ namespace {
         return selected;
     }
 
-    bool DrawFixedBodyInfoCard(const std::shared_ptr<ephemeris::FixedBody>& body, const glm::vec2& size) noexcept {
+    bool DrawFixedBodyInfoCard(ephemeris::FixedHandle handle,
+                               const ephemeris::FixedBody& body,
+                               const glm::vec2& size) noexcept {
         bool selected = false;
         const auto columnDistance = ImGui::CalcTextSize("#################################").x;
 
         {
             const auto& style = ImGui::GetStyle();
             ScopedColor childBackground{ ImGuiCol_ChildBg, style.Colors[ImGuiCol_FrameBg] };
-            if (ImGui::BeginChild(fmt::format("idChildElement{}", body->Designation).c_str(), ImVec2{ size.x, size.y },
+            if (ImGui::BeginChild(fmt::format("idChildElement{}", body.Designation).c_str(), ImVec2{ size.x, size.y },
                                   false, ImGuiWindowFlags_NoScrollbar)) {
 
                 // Item Spacings
@@ -567,23 +624,23 @@ namespace {
                 const auto smallFontSize = fontSize - 2.0f;
 
 
-                if (const auto texture = CatalogManager::FetchTexture(body->Designation)) {
+                if (const auto texture = CatalogManager::FetchTexture(body.Designation)) {
                     Image::DrawRounded(texture->GetNativeHandle(), size.y, size.y);
                 }
                 DrawCursor::Advance(size.y + itemSpacing.x, 0.0f);
                 const auto selectableCursor = ImGui::GetCursorPos();
 
-                const auto name = body->Name.empty() ? body->Designation : body->Name;
+                const auto name = body.Name.empty() ? body.Designation : body.Name;
                 Text::Draw(name, Font::Medium, fontSize, baseTextColor);
 
                 DrawCursor::Advance(0.0f, fontSize + regulatedItemSpacing);
                 auto cursor = ImGui::GetCursorPos();
-                const auto designationText = fmt::format("Designation: {}", body->Designation);
+                const auto designationText = fmt::format("Designation: {}", body.Designation);
                 Text::Draw(designationText, Font::Regular, smallFontSize, baseTextLightColor);
 
                 // Compute the position preview
-                const auto now = DateTime::Now();
-                const auto equatorial = body->GetEquatorialPosition(now);
+                const auto now = Clock::Now();
+                const auto equatorial = body.GetEquatorialPosition(now);
                 const auto positionPreview = ObserveGeographic(equatorial, LocationManager::GetGeographic(), now);
 
                 // Azimuth-Angle of the Celestial Body
@@ -592,7 +649,7 @@ namespace {
                 Text::Draw(azimuthText, Font::Regular, smallFontSize, baseTextLightColor);
 
                 // Altitude-Angle of the Celestial Body
-                const auto elevationText = fmt::format("Altitude: {:.4f} deg", positionPreview.Altitude);
+                const auto elevationText = FormatAltitude(positionPreview);
                 DrawCursor::Advance(0.0f, smallFontSize + regulatedItemSpacing);
                 Text::Draw(elevationText, Font::Regular, smallFontSize, baseTextLightColor);
 
@@ -602,36 +659,47 @@ namespace {
                 cursor = ImGui::GetCursorPos();
 
                 // Classification
-                const auto classificationText = fmt::format("Classification: {}", ClassificationToString(body->Type));
+                const auto classificationText = fmt::format("Classification: {}", ClassificationToString(body.Type));
                 Text::Draw(classificationText, Font::Regular, smallFontSize, baseTextLightColor);
 
                 // Constellation
                 const auto constellationText =
-                        fmt::format("Constellation: {} ({})", body->Const.Name, body->Const.Abbreviation);
+                        fmt::format("Constellation: {} ({})", body.Const.Name, body.Const.Abbreviation);
                 DrawCursor::Advance(0.0f, smallFontSize + regulatedItemSpacing);
                 Text::Draw(constellationText, Font::Regular, smallFontSize, baseTextLightColor);
 
                 // Magnitude
-                const auto magnitudeText = fmt::format("Magnitude: {}", body->Magnitude);
+                const auto magnitudeText = fmt::format("Magnitude: {}", body.Magnitude);
                 DrawCursor::Advance(0.0f, smallFontSize + regulatedItemSpacing);
                 Text::Draw(magnitudeText, Font::Regular, smallFontSize, baseTextLightColor);
 
+                // Best time of the night, which is a lookup in the almanac
+                if (const auto almanac = ActiveAlmanac()) {
+                    auto bestText = std::string{ "Best tonight: not observable" };
+                    if (const auto window = almanac->Tonight(handle, Clock::ToUtc(Instant::FromDateTime(now)))) {
+                        const auto best = Clock::ToLocal(almanac->InstantOf(window->Begin + window->Best)).ToDateTime();
+                        bestText = fmt::format("Best tonight: {:02}:{:02}", best.Hour, best.Minute);
+                    }
+                    DrawCursor::Advance(0.0f, smallFontSize + regulatedItemSpacing);
+                    Text::Draw(bestText, Font::Regular, smallFontSize, baseTextLightColor);
+                }
+
                 // Dimension
                 ImGui::SetCursorPos(cursor);
                 DrawCursor::Advance(columnDistance, 0.0f);
-                const auto dimensionText = fmt::format("Dimension: {} '", body->Dimension);
+                const auto dimensionText = fmt::format("Dimension: {} '", body.Dimension);
                 Text::Draw(dimensionText, Font::Regular, smallFontSize, baseTextLightColor);
 
                 DrawCursor::Advance(0.0f, smallFontSize + regulatedItemSpacing);
-                const auto id = fmt::format("idBodyDesc{}", body->Designation);
+                const auto id = fmt::format("idBodyDesc{}", body.Designation);
                 if (ImGui::BeginChild(id.c_str(), ImGui::GetContentRegionAvail())) {
-                    ImGui::TextWrapped("%s", body->Description.c_str());
+                    ImGui::TextWrapped("%s", body.GetDescription().c_str());
                 }
                 ImGui::EndChild();
 
                 ImGui::SetCursorPos(selectableCursor);
                 {
-                    ScopedID selectable{ fmt::format("idSelectable{}", body->Designation) };
+                    ScopedID selectable{ fmt::format("idSelectable{}", body.Designation) };
                     ScopedColor headerActive{ ImGuiCol_HeaderActive, style.Colors[ImGuiCol_FrameBgActive] };
                     ScopedColor headerHovered{ ImGuiCol_HeaderHovered, style.Colors[ImGuiCol_FrameBgHovered] };
                     if (ImGui::Selectable("", false, ImGuiSelectableFlags_None, { size.x, size.y })) {
@@ -769,6 +837,8 @@ Tracking::Tracking(void* windowHandle) noexcept
 void Tracking::OnInit() noexcept { }
 
 void Tracking::OnUpdate(float deltaTime) noexcept {
+    // All previews and filters of this frame share the same instant
+    Clock::Inject(DateTime::Now());
     if (ImGui::Begin("Tracking")) {
         const auto& style = ImGui::GetStyle();
         const auto itemSpacing = style.ItemSpacing;
@@ -791,9 +861,7 @@ void Tracking::OnUpdate(float deltaTime) noexcept {
         // Classification
         ImGui::SameLine();
 
-        std::unordered_set<ephemeris::Classification> classificationFilter{};
-        static std::vector<bool> classificationSelection(static_cast<std::size_t>(ephemeris::Classification::Planet) +
-                                                         1);
+        static ephemeris::ClassificationMask classificationSelection{};
 
         {
             ScopedWidth width{ filterWidth };
@@ -802,40 +870,28 @@ void Tracking::OnUpdate(float deltaTime) noexcept {
 
                 const auto buttonWidth = ImGui::GetContentRegionAvail().x * 0.5f - itemSpacing.x;
                 if (ImGui::Button("Select All", { buttonWidth, 0 })) {
-                    for (auto&& value : classificationSelection) {
-                        value = true;
-                    }
+                    classificationSelection.set();
                 }
                 ImGui::SameLine();
                 if (ImGui::Button("Clear", { buttonWidth, 0 })) {
-                    for (auto&& value : classificationSelection) {
-                        value = false;
-                    }
+                    classificationSelection.reset();
                 }
 
-                for (std::size_t i = 0; i <= static_cast<std::size_t>(ephemeris::Classification::Planet); ++i) {
+                for (std::size_t i = 0; i < ephemeris::ClassificationCount; ++i) {
                     const auto classification = static_cast<ephemeris::Classification>(i);
-                    bool selected = classificationSelection[i];
+                    bool selected = classificationSelection.test(i);
                     if (ImGui::Checkbox(ClassificationToString(classification), &selected)) {
-                        classificationSelection[i] = selected;
+                        classificationSelection.set(i, selected);
                     }
                 }
                 ImGui::EndCombo();
             }
         }
 
-        for (std::size_t i = 0; i < classificationSelection.size(); ++i) {
-            const auto classification = static_cast<ephemeris::Classification>(i);
-            if (classificationSelection[i]) {
-                classificationFilter.insert(classification);
-            }
-        }
-
         // Constellation
         ImGui::SameLine();
 
-        std::unordered_set<std::string_view> constellationFilter{};
-        static std::vector<bool> constellationSelection(ephemeris::ConstellationExpansionTable.size());
+        static ephemeris::ConstellationMask constellationSelection{};
 
         {
             ScopedWidth width{ filterWidth };
@@ -844,45 +900,36 @@ void Tracking::OnUpdate(float deltaTime) noexcept {
 
                 const auto buttonWidth = ImGui::GetContentRegionAvail().x * 0.5f - itemSpacing.x;
                 if (ImGui::Button("Select All", { buttonWidth, 0 })) {
-                    for (auto&& value : constellationSelection) {
-                        value = true;
-                    }
+                    constellationSelection.set();
                 }
                 ImGui::SameLine();
                 if (ImGui::Button("Clear", { buttonWidth, 0 })) {
-                    for (auto&& value : constellationSelection) {
-                        value = false;
-                    }
+                    constellationSelection.reset();
                 }
 
-                for (std::size_t i = 0; i < ephemeris::ConstellationExpansionTable.size(); ++i) {
-                    auto iterator = ephemeris::ConstellationExpansionTable.begin();
-                    std::advance(iterator, i);
-
-                    const auto& [abbreviation, name] = *iterator;
-                    bool selected = constellationSelection[i];
-                    if (ImGui::Checkbox(name.data(), &selected)) {
-                        constellationSelection[i] = selected;
+                // The checkboxes are in the order of the constellation ids, which index the selection directly
+                for (std::size_t i = 0; i < ephemeris::ConstellationCount; ++i) {
+                    bool selected = constellationSelection.test(i);
+                    if (ImGui::Checkbox(ephemeris::ConstellationTable[i].Name.data(), &selected)) {
+                        constellationSelection.set(i, selected);
                     }
                 }
                 ImGui::EndCombo();
             }
         }
 
-        for (std::size_t i = 0; i < constellationSelection.size(); ++i) {
-            auto iterator = ephemeris::ConstellationExpansionTable.begin();
-            std::advance(iterator, i);
-
-            const auto& [abbreviation, name] = *iterator;
-            if (constellationSelection[i]) {
-                constellationFilter.insert(abbreviation);
-            }
-        }
-
         ImGui::SameLine();
 
         // Advanced Filters
         static bool visibilitySelection = false;
+        static bool tonightSelection = false;
+        constexpr std::size_t queryBufferSize = 256;
+        static std::vector<char> queryBuffer(queryBufferSize);
+        static std::string queryError{};
+        static int sortSelection = 0;
+        constexpr std::array<const char*, 5> sortModes = { "Dimension", "Magnitude", "Designation", "Name",
+                                                           "Current altitude" };
+        constexpr int altitudeSort = 4;
         {
             ScopedWidth width{ filterWidth };
             if (ImGui::BeginCombo("##idAdvanced", "Advanced Options")) {
@@ -890,6 +937,32 @@ void Tracking::OnUpdate(float deltaTime) noexcept {
                     if (ImGui::Checkbox("Require minimum altitude", &visibilitySelection)) { }
                     DrawInputDouble(Settings::Get<double>("Catalog-VisibilityThreshold"), "%.2f deg",
                                     !visibilitySelection);
+                    if (CatalogManager::GetHorizon() != nullptr) {
+                        ImGui::Checkbox("Respect horizon profile", &Settings::Get<bool>("Catalog-UseHorizon", false));
+                    }
+                    if (ActiveAlmanac() != nullptr) {
+                        ImGui::Checkbox("Observable tonight", &tonightSelection);
+                    } else if (CatalogManager::IsAlmanacPending()) {
+                        // The filter is offered once the almanac has been generated in the background
+                        auto pending = false;
+                        ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+                        ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+                        ImGui::Checkbox("Observable tonight (generating almanac)", &pending);
+                        ImGui::PopItemFlag();
+                        ImGui::PopStyleVar();
+                    }
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Sort")) {
+                    ImGui::Combo("##idSort", &sortSelection, sortModes.data(), static_cast<int>(sortModes.size()));
+                    ImGui::TreePop();
+                }
+                if (ImGui::TreeNode("Query")) {
+                    ImGui::InputTextWithHint("##idQuery", "mag < 10 && type in {Gx} && alt(now) > 30",
+                                             queryBuffer.data(), queryBufferSize);
+                    if (!queryError.empty()) {
+                        ImGui::TextColored({ 0.9f, 0.3f, 0.3f, 1.0f }, "%s", queryError.c_str());
+                    }
                     ImGui::TreePop();
                 }
 
@@ -901,56 +974,108 @@ void Tracking::OnUpdate(float deltaTime) noexcept {
 
         std::optional<ephemeris::Catalog::VisibilityFilter> visibilityFilter;
         if (visibilitySelection) {
-            visibilityFilter =
-                    ephemeris::Catalog::VisibilityFilter{ Settings::Get<double>("Catalog-VisibilityThreshold"),
-                                                          LocationManager::GetGeographic() };
+            visibilityFilter = ephemeris::Catalog::VisibilityFilter{
+                Settings::Get<double>("Catalog-VisibilityThreshold"), LocationManager::GetGeographic(), ActiveHorizon()
+            };
         }
 
         if (ImGui::Button("Clear Filters", { ImGui::GetContentRegionAvail().x, 0.0f })) {
             visibilitySelection = false;
-            for (auto&& value : constellationSelection) {
-                value = false;
-            }
-            for (auto&& value : classificationSelection) {
-                value = false;
-            }
+            tonightSelection = false;
+            constellationSelection.reset();
+            classificationSelection.reset();
             std::memset(searchBuffer.data(), 0, searchBuffer.size());
+            std::memset(queryBuffer.data(), 0, queryBuffer.size());
         }
 
         // Get the filtered library
         static ephemeris::Catalog::Filter lastFilter{ "huygens", {}, {}, {} };
-        static std::vector<std::shared_ptr<ephemeris::FixedBody>> bodies{};
+        static std::string lastQuery{};
+        static bool lastTonight = false;
+        static int lastSort = 0;
+        static double lastAltitudeSort = 0.0;
+        static std::vector<ephemeris::FixedHandle> bodies{};
         static std::vector<std::shared_ptr<ephemeris::Planet>> planets{};
-        auto filter = ephemeris::Catalog::Filter{ searchBuffer.data(), classificationFilter,
-                                                  std::move(constellationFilter), visibilityFilter };
+        auto filter = ephemeris::Catalog::Filter{ searchBuffer.data(), classificationSelection, constellationSelection,
+                                                  visibilityFilter };
 
 
-        if (filter != lastFilter) {
+        const std::string query{ queryBuffer.data() };
+        const auto rebuild = filter != lastFilter || query != lastQuery || tonightSelection != lastTonight;
+        if (rebuild) {
             if (Settings::Get<bool>("Output-Verbose")) {
                 LIBTRACKER_WARN("Rebuilding catalog");
             }
             const auto& catalog = CatalogManager::GetCatalog();
             bodies = catalog.FilterFixed(filter);
-            if (classificationFilter.empty() ||
-                classificationFilter.find(ephemeris::Classification::Planet) != classificationFilter.end()) {
+
+            // The windows of the night are looked up in the almanac instead of being computed
+            if (tonightSelection) {
+                if (const auto almanac = ActiveAlmanac()) {
+                    bodies = almanac->FilterTonight(bodies, Clock::ToUtc(Instant::FromDateTime(Clock::Now())));
+                }
+            }
+
+            // The query further restricts the filtered bodies, a malformed query is reported and ignored
+            queryError.clear();
+            if (!query.empty()) {
+                if (const auto program = ephemeris::Query::Parse(query, &queryError)) {
+                    const auto utc = Clock::ToUtc(Instant::FromDateTime(Clock::Now()));
+                    std::vector<ephemeris::Query::Step> profile{};
+                    bodies = catalog.QueryFixed(*program, utc, LocationManager::GetGeographic(), &bodies, &profile);
+                    if (Settings::Get<bool>("Output-Verbose")) {
+                        LIBTRACKER_INFO("Query plan\n{}", program->Plan());
+                        for (const auto& step : profile) {
+                            LIBTRACKER_INFO("{}: {} -> {} bodies in {:.3f} ms", step.Predicate, step.Input,
+                                            step.Output, step.Milliseconds);
+                        }
+                    }
+                }
+            }
+            if (classificationSelection.none() ||
+                classificationSelection.test(static_cast<usize>(ephemeris::Classification::Planet))) {
                 planets = catalog.FilterPlanets(filter.Identifier);
             } else {
                 planets.clear();
             }
         }
+
+        // Static orders are applied through the precomputed permutations, the altitude order is refreshed every second
+        // and starts from the previous order, which the rotation of the sky has only slightly disturbed
+        const auto& catalog = CatalogManager::GetCatalog();
+        if (sortSelection == altitudeSort) {
+            if (rebuild || sortSelection != lastSort || ImGui::GetTime() - lastAltitudeSort >= 1.0) {
+                catalog.SortFixedByAltitude(bodies, Clock::ToUtc(Instant::FromDateTime(Clock::Now())),
+                                            LocationManager::GetGeographic());
+                lastAltitudeSort = ImGui::GetTime();
+            }
+        } else if (rebuild || sortSelection != lastSort) {
+            catalog.SortFixed(bodies, static_cast<ephemeris::SortKey>(sortSelection));
+        }
         lastFilter = filter;
+        lastQuery = query;
+        lastTonight = tonightSelection;
+        lastSort = sortSelection;
 
         const auto size = ImGui::GetContentRegionAvail();
         if (ImGui::BeginChild("idChildCelestialBodiesList", { size.x, size.y - fontSize - itemSpacing.y }, false,
                               ImGuiWindowFlags_AlwaysVerticalScrollbar)) {
             if (ImGui::BeginTable("Targets", 1)) {
-                for (const auto& planet : planets) {
+                // All planet previews of this frame share one snapshot of the solar system
+                const auto utc = Clock::ToUtc(Instant::FromDateTime(Clock::Now()));
+                const ephemeris::SolarSystemSnapshot solarSystem{ planets, utc };
+                const auto& observer = LocationManager::GetGeographic();
+                for (usize index = 0; index < planets.size(); ++index) {
                     ImGui::TableNextRow();
                     ImGui::TableNextColumn();
 
+                    const auto& planet = planets[index];
+                    const auto positionPreview =
+                            ObserveGeographic(solarSystem.GetEquatorialPosition(index), observer, utc);
                     const auto celestialBodyCardHeight = 4.0f * fontSize + (2.0f + 3 * 0.7f) * itemSpacing.y - 6.0f;
 
-                    if (DrawPlanetInfoCard(planet, { ImGui::GetContentRegionAvail().x, celestialBodyCardHeight })) {
+                    if (DrawPlanetInfoCard(planet, positionPreview,
+                                           { ImGui::GetContentRegionAvail().x, celestialBodyCardHeight })) {
                         ImGui::OpenPopup(planet->Name.c_str());
                     }
                     DrawPlanetDetails(planet, planet->Name.c_str());
@@ -963,13 +1088,14 @@ void Tracking::OnUpdate(float deltaTime) noexcept {
                         ImGui::TableNextRow();
                         ImGui::TableNextColumn();
 
-                        const auto& body = bodies[row];
+                        const auto handle = bodies[row];
+                        const auto& body = CatalogManager::GetCatalog().GetFixed(handle);
                         const auto celestialBodyCardHeight = 4.0f * fontSize + (2.0f + 3 * 0.7f) * itemSpacing.y - 6.0f;
-                        if (DrawFixedBodyInfoCard(body,
+                        if (DrawFixedBodyInfoCard(handle, body,
                                                   { ImGui::GetContentRegionAvail().x, celestialBodyCardHeight })) {
-                            ImGui::OpenPopup(body->Designation.c_str());
+                            ImGui::OpenPopup(body.Designation.data());
                         }
-                        DrawFixedDetails(body, body->Designation);
+                        DrawFixedDetails(handle, body.Designation);
                     }
                 }
                 bodyRenderStartIndex = bodyClipper.DisplayStart;
@@ -982,6 +1108,7 @@ void Tracking::OnUpdate(float deltaTime) noexcept {
                     bodyRenderStartIndex, bodyRenderEndIndex);
     }
     ImGui::End();
+    Clock::Release();
 }
 
 void Tracking::OnDestroy() noexcept {
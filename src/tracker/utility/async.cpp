@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "async.hpp"
 
 namespace utility {
@@ -6,4 +10,120 @@ namespace utility {
         auto job = std::thread(task);
         job.detach();
     }
+
+    ThreadPool::ThreadPool(usize threads) noexcept {
+        const auto count = std::max<usize>(threads, 1);
+        workers.reserve(count);
+        for (usize index = 0; index < count; ++index) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() noexcept {
+        {
+            std::unique_lock lock(mutex);
+            stop = true;
+        }
+        condition.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::Submit(AsyncTask&& task) noexcept {
+        {
+            std::unique_lock lock(mutex);
+            tasks.emplace_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+    usize ThreadPool::Size() const noexcept {
+        return workers.size();
+    }
+
+    ThreadPool& ThreadPool::Shared() noexcept {
+        static ThreadPool pool{ std::thread::hardware_concurrency() };
+        return pool;
+    }
+
+    void ThreadPool::run() noexcept {
+        while (true) {
+            AsyncTask task;
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this] { return stop || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    namespace {
+
+        /**
+         * Shared by all participants of a ParallelFor, as helpers might start after the caller has returned
+         */
+        struct ParallelState {
+            std::atomic<usize> Next{ 0 };
+            usize Completed{ 0 };
+            usize Chunks{ 0 };
+            usize Count{ 0 };
+            usize ChunkSize{ 0 };
+            std::function<void(usize, usize)> Body;
+            std::mutex Mutex;
+            std::condition_variable Condition;
+        };
+
+        /**
+         * Takes chunks until there are none left
+         */
+        void Participate(ParallelState& state) noexcept {
+            usize done = 0;
+            for (auto chunk = state.Next++; chunk < state.Chunks; chunk = state.Next++) {
+                const auto begin = chunk * state.ChunkSize;
+                state.Body(begin, std::min(begin + state.ChunkSize, state.Count));
+                ++done;
+            }
+            if (done > 0) {
+                std::unique_lock lock(state.Mutex);
+                state.Completed += done;
+                if (state.Completed == state.Chunks) {
+                    state.Condition.notify_all();
+                }
+            }
+        }
+    }// namespace
+
+    void ParallelFor(usize count,
+                     usize chunkSize,
+                     usize threads,
+                     const std::function<void(usize, usize)>& body) noexcept {
+        chunkSize = std::max<usize>(chunkSize, 1);
+        const auto chunks = (count + chunkSize - 1) / chunkSize;
+        const auto helpers = std::min({ threads, chunks, ThreadPool::Shared().Size() + 1 });
+        if (helpers <= 1) {
+            for (usize begin = 0; begin < count; begin += chunkSize) {
+                body(begin, std::min(begin + chunkSize, count));
+            }
+            return;
+        }
+
+        auto state = std::make_shared<ParallelState>();
+        state->Chunks = chunks;
+        state->Count = count;
+        state->ChunkSize = chunkSize;
+        state->Body = body;
+        for (usize helper = 1; helper < helpers; ++helper) {
+            ThreadPool::Shared().Submit([state] { Participate(*state); });
+        }
+        Participate(*state);
+
+        std::unique_lock lock(state->Mutex);
+        state->Condition.wait(lock, [&state] { return state->Completed == state->Chunks; });
+    }
 }// namespace utility
\ No newline at end of file
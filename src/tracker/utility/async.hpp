@@ -1,8 +1,12 @@
 #ifndef UTILITY_ASYNC_H
 #define UTILITY_ASYNC_H
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "types.hpp"
 
@@ -19,6 +23,66 @@ namespace utility {
      * @param task Async task
      */
     void FireAndForget(AsyncTask&& task) noexcept;
+
+    /**
+     * Fixed number of worker threads, that execute submitted tasks in order of submission
+     */
+    class ThreadPool {
+    public:
+        /**
+         * Starts the workers
+         * @param threads Number of workers, at least one
+         */
+        explicit ThreadPool(usize threads) noexcept;
+
+        /**
+         * Finishes the queued tasks and joins the workers
+         */
+        ~ThreadPool() noexcept;
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * Queues the task for execution on one of the workers
+         * @param task Async task
+         */
+        void Submit(AsyncTask&& task) noexcept;
+
+        /**
+         * Number of workers
+         * @return size
+         */
+        usize Size() const noexcept;
+
+        /**
+         * Pool that is shared by the whole application, with one worker per hardware thread
+         * @return shared pool
+         */
+        static ThreadPool& Shared() noexcept;
+
+    private:
+        void run() noexcept;
+
+        std::vector<std::thread> workers;
+        std::deque<AsyncTask> tasks;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool stop{ false };
+    };
+
+    /**
+     * Invokes the body for consecutive ranges of at most chunkSize indices in [0, count). The calling thread takes part
+     * in the work, so nesting ParallelFor inside of pool tasks does not dead-lock
+     * @param count Number of indices
+     * @param chunkSize Number of indices per invocation, at least one
+     * @param threads Maximum number of threads that work on the ranges, one runs everything on the calling thread
+     * @param body Callable of signature void(usize begin, usize end)
+     */
+    void ParallelFor(usize count,
+                     usize chunkSize,
+                     usize threads,
+                     const std::function<void(usize, usize)>& body) noexcept;
 }// namespace utility
 
 #endif// UTILITY_ASYNC_H
\ No newline at end of file
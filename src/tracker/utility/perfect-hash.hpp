@@ -0,0 +1,155 @@
+#ifndef UTILITY_PERFECTHASH_H
+#define UTILITY_PERFECTHASH_H
+
+/**
+ * Compile-time perfect hash tables for static string keyed lookups
+ */
+
+#include <array>
+#include <string_view>
+
+#include "types.hpp"
+
+namespace utility {
+
+    /**
+     * Seeded 32 bit FNV-1a hash with a final avalanche step, so that the low bits depend on every character
+     * @param key Key
+     * @param seed Seed
+     * @return hash
+     */
+    constexpr u32 PerfectHash(std::string_view key, u32 seed) noexcept {
+        u32 hash = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (const auto c : key) {
+            hash ^= static_cast<u8>(c);
+            hash *= 16777619u;
+        }
+        hash ^= hash >> 15u;
+        hash *= 0x2C1B3C6Du;
+        hash ^= hash >> 12u;
+        return hash;
+    }
+
+    /**
+     * Smallest power of two that is not less than the value
+     * @param value Value
+     * @return power of two
+     */
+    constexpr usize NextPowerOfTwo(usize value) noexcept {
+        usize power = 1;
+        while (power < value) {
+            power *= 2;
+        }
+        return power;
+    }
+
+    /**
+     * Immutable map from string keys to values, that is built at compile time with the hash and displace method. The
+     * keys are distributed into buckets, and each bucket gets a seed that places all of its keys into free slots. A
+     * lookup therefore hashes the key twice and compares a single slot, without probing and without any allocation
+     * @tparam Value Value type, which has to be a literal type
+     * @tparam Count Number of entries, keys have to be distinct
+     */
+    template<typename Value, usize Count>
+    class PerfectHashTable {
+    public:
+        struct Entry {
+            std::string_view Key;
+            Value Mapped;
+        };
+
+        static constexpr usize SlotCount = NextPowerOfTwo(2 * Count);
+        static constexpr usize BucketCount = (Count + 1) / 2;
+
+    private:
+        std::array<Entry, SlotCount> slots{};
+        std::array<bool, SlotCount> occupied{};
+        std::array<u32, BucketCount> seeds{};
+        bool valid{ true };
+
+        static constexpr usize Bucket(std::string_view key) noexcept {
+            return PerfectHash(key, 0) % BucketCount;
+        }
+
+        constexpr usize Slot(std::string_view key) const noexcept {
+            return PerfectHash(key, seeds[Bucket(key)]) & (SlotCount - 1);
+        }
+
+    public:
+        /**
+         * Builds the table, buckets are placed from the largest to the smallest, while most slots are still free
+         * @param entries Entries with distinct keys
+         */
+        constexpr explicit PerfectHashTable(const std::array<Entry, Count>& entries) noexcept {
+            // Group the entries by bucket with a counting sort
+            std::array<usize, Count> buckets{};
+            std::array<usize, BucketCount + 1> offsets{};
+            usize largest = 0;
+            for (usize entry = 0; entry < Count; ++entry) {
+                buckets[entry] = Bucket(entries[entry].Key);
+                ++offsets[buckets[entry] + 1];
+            }
+            for (usize bucket = 0; bucket < BucketCount; ++bucket) {
+                largest = offsets[bucket + 1] > largest ? offsets[bucket + 1] : largest;
+                offsets[bucket + 1] += offsets[bucket];
+            }
+            std::array<usize, Count> grouped{};
+            std::array<usize, BucketCount> filled{};
+            for (usize entry = 0; entry < Count; ++entry) {
+                grouped[offsets[buckets[entry]] + filled[buckets[entry]]++] = entry;
+            }
+
+            for (auto size = largest; size > 0; --size) {
+                for (usize bucket = 0; bucket < BucketCount; ++bucket) {
+                    const auto begin = offsets[bucket];
+                    if (offsets[bucket + 1] - begin != size) {
+                        continue;
+                    }
+
+                    // Search the first seed, that places every key of the bucket into a distinct free slot
+                    auto placed = false;
+                    for (u32 seed = 1; seed != 0 && !placed; ++seed) {
+                        std::array<usize, Count> candidates{};
+                        placed = true;
+                        for (usize member = 0; member < size && placed; ++member) {
+                            const auto slot = PerfectHash(entries[grouped[begin + member]].Key, seed) & (SlotCount - 1);
+                            placed = !occupied[slot];
+                            for (usize previous = 0; previous < member && placed; ++previous) {
+                                placed = candidates[previous] != slot;
+                            }
+                            candidates[member] = slot;
+                        }
+                        if (placed) {
+                            seeds[bucket] = seed;
+                            for (usize member = 0; member < size; ++member) {
+                                slots[candidates[member]] = entries[grouped[begin + member]];
+                                occupied[candidates[member]] = true;
+                            }
+                        }
+                    }
+                    valid = valid && placed;
+                }
+            }
+        }
+
+        /**
+         * Looks up a key
+         * @param key Key
+         * @return pointer to the value, or nullptr if the key is not in the table
+         */
+        constexpr const Value* Find(std::string_view key) const noexcept {
+            const auto slot = Slot(key);
+            return occupied[slot] && slots[slot].Key == key ? &slots[slot].Mapped : nullptr;
+        }
+
+        /**
+         * Checks if every entry could be placed, which is meant to be checked with a static_assert
+         * @return boolean value
+         */
+        constexpr bool Valid() const noexcept {
+            return valid;
+        }
+    };
+}// namespace utility
+
+#endif// UTILITY_PERFECTHASH_H
@@ -1,3 +1,5 @@
+#include <thread>
+
 #include "workspace.hpp"
 #include "libtracker.hpp"
 
@@ -143,6 +145,17 @@ namespace {
                         ScopedWidth comboWidth{ ImGui::GetContentRegionAvail().x };
                         ImGui::Checkbox("##idVerboseOutput", &Settings::Get<bool>("Output-Verbose", false));
                     }
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("Planet Ephemeris Cache");
+                    ImGui::TableNextColumn();
+                    {
+                        ScopedWidth comboWidth{ ImGui::GetContentRegionAvail().x };
+                        auto& ephemerisCache = Settings::Get<bool>("Ephemeris-Cache", true);
+                        if (ImGui::Checkbox("##idEphemerisCache", &ephemerisCache)) {
+                            ephemeris::PlanetCache::SetEnabled(ephemerisCache);
+                        }
+                    }
                     ImGui::EndTable();
                 }
             }
@@ -156,7 +169,9 @@ namespace {
 
 Workspace::Workspace(void* windowHandle) noexcept : View{ windowHandle } {
     AssetDatabase::LoadSettings("settings.json");
-    AssetDatabase::LoadCatalogManager("ngc2000.dat", "names.dat", "planets.json");
+    ephemeris::PlanetCache::SetEnabled(Settings::Get<bool>("Ephemeris-Cache", true));
+    AssetDatabase::LoadCatalogManager("ngc2000.dat", "names.dat", "planets.json", "catalog.snapshot");
+    AssetDatabase::LoadHorizonProfile("horizon.txt");
     Tracker::Initialize();
 
     graphics::Renderer::Initialize();
@@ -167,6 +182,21 @@ Workspace::Workspace(void* windowHandle) noexcept : View{ windowHandle } {
         openSettings = true;
     }
 
+    // The almanac is bound to the site, the visibility threshold and the horizon. An existing file is opened here, a
+    // missing or stale one is regenerated in the background
+    if (LocationManager::IsConfigured()) {
+        ephemeris::AlmanacInfo almanac{};
+        almanac.Observer = LocationManager::GetGeographic();
+        almanac.Year = Clock::Now().Year;
+        almanac.AltitudeThreshold = Settings::Get<double>("Catalog-VisibilityThreshold");
+        almanac.SunAltitude = Settings::Get<double>("Almanac-SunAltitude", -12.0);
+        almanac.Threads = std::max(std::thread::hardware_concurrency(), 1u);
+        if (Settings::Get<bool>("Catalog-UseHorizon", false)) {
+            almanac.Horizon = CatalogManager::GetHorizon();
+        }
+        AssetDatabase::LoadAlmanac(fmt::format("almanac-{}.bin", almanac.Year), almanac);
+    }
+
     tracking = std::make_shared<Tracking>(nativeWindowHandle);
     processing = std::make_shared<Processing>(nativeWindowHandle);
     control = std::make_shared<Control>(nativeWindowHandle);